@@ -2,12 +2,19 @@
 #define EXECUTION_BACKEND_H
 #include "Error.h"
 #include "runtime/ExecutionContext.h"
+#include "runtime/Session.h"
 namespace mlir {
 class ModuleOp;
 } // namespace mlir
 namespace execution {
 using mainFnType = std::add_pointer<void()>::type;
 using setExecutionContextFnType = std::add_pointer<void(runtime::ExecutionContext*)>::type;
+//machine code of a query that stays valid after the execution and can be executed again (e.g. by prepared statements)
+class CompiledQuery : public runtime::CompiledStatement {
+   public:
+   mainFnType mainFunc = nullptr;
+   setExecutionContextFnType setExecutionContextFunc = nullptr;
+};
 class ExecutionBackend {
    protected:
    size_t numRepetitions = 1;
@@ -15,6 +22,8 @@ class ExecutionBackend {
    Error error;
    bool verify = true;
    size_t snapShotCounter;
+   //only set by backends that can execute their compiled code again
+   std::shared_ptr<CompiledQuery> compiledQuery;
 
    public:
    size_t getNumRepetitions() const {
@@ -31,6 +40,11 @@ class ExecutionBackend {
       verify = false;
    }
    virtual void execute(mlir::ModuleOp& moduleOp, runtime::ExecutionContext* executionContext) = 0;
+   //executes previously compiled code instead of a module
+   void executeCompiled(CompiledQuery& query, runtime::ExecutionContext* executionContext);
+   std::shared_ptr<CompiledQuery> getCompiledQuery() {
+      return compiledQuery;
+   }
    virtual bool requiresSnapshotting() = 0;
    void setSnapShotCounter(size_t snapShotCounter) {
       ExecutionBackend::snapShotCounter = snapShotCounter;
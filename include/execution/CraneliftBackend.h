@@ -3,5 +3,7 @@
 #include "Backend.h"
 namespace execution{
    std::unique_ptr<ExecutionBackend> createCraneliftBackend();
+   //start with cranelift, switch to LLVM-optimized code when it becomes available
+   std::unique_ptr<ExecutionBackend> createAdaptiveBackend();
 } // namespace execution
 #endif //EXECUTION_CRANELIFTBACKEND_H
@@ -58,6 +58,12 @@ class LoweringStep {
    virtual ~LoweringStep() {}
 };
 
+//priority of the query's task arena: workers prefer tasks of higher-priority queries
+enum class QueryPriority {
+   LOW = 0,
+   NORMAL = 1,
+   HIGH = 2,
+};
 struct QueryExecutionConfig {
    std::unique_ptr<Frontend> frontend;
    std::unique_ptr<QueryOptimizer> queryOptimizer;
@@ -66,7 +72,19 @@ struct QueryExecutionConfig {
    std::unique_ptr<ResultProcessor> resultProcessor;
    std::unique_ptr<TimingProcessor> timingProcessor;
    bool trackTupleCount = false;
+   //record the actual cardinalities of join subplans for the optimization of later queries (implies tuple tracking)
+   bool cardinalityFeedback = false;
+   //adaptive re-optimization: if the size of a hash join's build side is misestimated by more than this factor, the query
+   //is cancelled and restarted with the observed cardinalities (0: disabled)
+   double reoptimizationFactor = 0;
+   //backend for compiling the restarted query (default: executionBackend)
+   std::unique_ptr<ExecutionBackend> reoptimizationBackend;
    bool parallel=true;
+   //every query is executed in its own task arena with this many threads (0: LINGODB_PARALLELISM or half of the available cores)
+   size_t concurrency = 0;
+   QueryPriority priority = QueryPriority::NORMAL;
+   //errors terminate the process by default, long-running processes (e.g., sql --server) get an exception instead
+   bool exitOnError = true;
 };
 
 enum class ExecutionMode {
@@ -77,6 +95,7 @@ enum class ExecutionMode {
    CHEAP = 4, // compile as cheap (compile time) as possible
    EXTREME_CHEAP = 5, // compile as cheap (compile time) as possible, don't verify MLIR module
    C = 6,
+   ADAPTIVE = 7, // start executing cheaply compiled code, switch to optimized code during execution
 };
 std::unique_ptr<QueryExecutionConfig> createQueryExecutionConfig(ExecutionMode runMode, bool sqlInput);
 ExecutionMode getExecutionMode();
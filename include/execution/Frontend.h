@@ -2,6 +2,7 @@
 #define EXECUTION_FRONTEND_H
 #include "Error.h"
 #include "runtime/Catalog.h"
+#include "runtime/Session.h"
 namespace mlir {
 class ModuleOp;
 class MLIRContext;
@@ -10,6 +11,7 @@ namespace execution {
 class Frontend {
    protected:
    runtime::Catalog* catalog;
+   runtime::Session* session = nullptr;
    Error error;
 
    std::unordered_map<std::string, double> timing;
@@ -21,6 +23,9 @@ class Frontend {
    void setCatalog(runtime::Catalog* catalog) {
       Frontend::catalog = catalog;
    }
+   void setSession(runtime::Session* session) {
+      Frontend::session = session;
+   }
    const std::unordered_map<std::string, double>& getTiming() const {
       return timing;
    }
@@ -28,6 +33,10 @@ class Frontend {
    virtual void loadFromFile(std::string fileName) = 0;
    virtual void loadFromString(std::string data) = 0;
    virtual bool isParallelismAllowed() { return true; }
+   //values for the parameters of an executed prepared statement
+   virtual std::vector<std::string> getParameters() { return {}; }
+   //name of the executed prepared statement (empty if the query is not an EXECUTE)
+   virtual std::string getExecutedStatement() { return ""; }
    virtual mlir::ModuleOp* getModule() = 0;
    virtual ~Frontend() {}
 };
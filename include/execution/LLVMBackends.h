@@ -1,9 +1,20 @@
 #ifndef EXECUTION_LLVMBACKENDS_H
 #define EXECUTION_LLVMBACKENDS_H
 #include "Backend.h"
+
+#include <atomic>
+#include <string>
+#include <unordered_map>
+namespace mlir {
+class ExecutionEngine;
+} // namespace mlir
 namespace execution{
    std::unique_ptr<ExecutionBackend> createDefaultLLVMBackend();
    std::unique_ptr<ExecutionBackend> createLLVMDebugBackend();
    std::unique_ptr<ExecutionBackend> createLLVMProfilingBackend();
+   //lowers the module and creates an execution engine with aggressive optimizations (used for tiered execution)
+   //code is generated lazily on the first lookup; returns nullptr on failure or if compilation was cancelled
+   //shared globals (name -> address) are not defined by the generated code, it uses the given memory instead (e.g., the globals of already running code)
+   std::unique_ptr<mlir::ExecutionEngine> createOptimizedLLVMEngine(mlir::ModuleOp& moduleOp, bool verify, const std::atomic<bool>& cancelled, const std::unordered_map<std::string, void*>& sharedGlobals = {});
 } // namespace execution
 #endif //EXECUTION_LLVMBACKENDS_H
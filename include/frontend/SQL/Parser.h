@@ -25,6 +25,7 @@
 
 #include "parsenodes.h"
 #include "runtime/Catalog.h"
+#include "runtime/Session.h"
 
 #include "runtime-defs/ExecutionContext.h"
 #include "runtime-defs/RelationHelper.h"
@@ -242,6 +243,19 @@ struct Parser {
    }
    mlir::ModuleOp moduleOp;
    bool parallelismAllowed;
+   //session storing the prepared statements
+   runtime::Session* session = nullptr;
+   //declared types of the parameters ($1, $2, ...) of an executed prepared statement
+   std::vector<mlir::Type> parameterTypes;
+   //values of the parameters of an executed prepared statement (loaded at runtime)
+   std::vector<std::string> parameters;
+   //name of the executed prepared statement (empty if the statement is not an EXECUTE)
+   std::string executedStatement;
+   //top-level block of the query: parameters are loaded (and casted) once at its start
+   mlir::Block* queryBlock = nullptr;
+   std::unordered_map<uint32_t, mlir::Value> parameterValues;
+   size_t maxParameter = 0;
+   PgQueryInternalParsetreeAndError preparedResult{};
    Parser(std::string sql, runtime::Catalog& catalog, mlir::ModuleOp moduleOp);
 
    mlir::Value getExecutionContextValue(mlir::OpBuilder& builder) {
@@ -296,6 +310,15 @@ struct Parser {
    //translate the provided SQL statement
    std::optional<mlir::Value> translate(mlir::OpBuilder& builder);
 
+   //translate a single (parsed) statement
+   std::optional<mlir::Value> translateStatement(mlir::OpBuilder& builder, Node* statement);
+
+   //translate an EXECUTE statement: the prepared query is translated with parameters that are loaded at runtime
+   std::optional<mlir::Value> translateExecuteStatement(mlir::OpBuilder& builder, ExecuteStmt* executeStatement);
+
+   //translate a parameter reference (e.g. $1)
+   mlir::Value translateParamRef(mlir::OpBuilder& builder, ParamRef* paramRef);
+
    //translate a variable set statement (e.g. SET var = 1; )
    void translateVariableSetStatement(mlir::OpBuilder& builder, VariableSetStmt* variableSetStatement);
 
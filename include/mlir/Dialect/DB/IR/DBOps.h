@@ -13,10 +13,16 @@
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/Builders.h"
 
+#include <optional>
+
 #define GET_OP_CLASSES
 #include "mlir/Dialect/DB/IR/DBOps.h.inc"
 mlir::Type getBaseType(mlir::Type t);
 mlir::Type wrapNullableType(mlir::MLIRContext* context, mlir::Type type, mlir::ValueRange values);
 bool isIntegerType(mlir::Type, unsigned int width);
 int getIntegerWidth(mlir::Type, bool isUnSigned);
+namespace mlir::db {
+//parameter of a prepared statement (possibly casted): index and the value of the execution the query was optimized for
+std::optional<std::pair<uint32_t, std::string>> getPreparedStatementParameter(mlir::Value v);
+} // namespace mlir::db
 #endif // MLIR_DIALECT_DB_IR_DBOPS_H
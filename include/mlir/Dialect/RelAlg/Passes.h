@@ -16,7 +16,7 @@ std::unique_ptr<Pass> createColumnFoldingPass();
 std::unique_ptr<Pass> createImplicitToExplicitJoinsPass();
 std::unique_ptr<Pass> createUnnestingPass();
 std::unique_ptr<Pass> createPushdownPass();
-std::unique_ptr<Pass> createOptimizeJoinOrderPass();
+std::unique_ptr<Pass> createOptimizeJoinOrderPass(std::shared_ptr<runtime::CardinalityFeedback> cardinalityFeedback = {});
 std::unique_ptr<Pass> createCombinePredicatesPass();
 std::unique_ptr<Pass> createOptimizeImplementationsPass();
 std::unique_ptr<Pass> createIntroduceTmpPass();
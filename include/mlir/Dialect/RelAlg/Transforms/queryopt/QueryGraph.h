@@ -6,6 +6,9 @@
 #include <mlir/Dialect/RelAlg/IR/RelAlgOps.h>
 #include <mlir/Dialect/RelAlg/Transforms/queryopt/utils.h>
 #include <mlir/Dialect/TupleStream/TupleStreamOps.h>
+namespace runtime {
+class CardinalityFeedback;
+} // end namespace runtime
 namespace mlir::relalg {
 class QueryGraph {
    public:
@@ -87,6 +90,9 @@ class QueryGraph {
    std::vector<JoinEdge> joins;
    std::vector<SelectionEdge> selections;
    std::unordered_map<size_t, size_t> pseudoNodeOwner;
+   //cardinalities observed in previous executions, preferred over estimations
+   std::shared_ptr<runtime::CardinalityFeedback> cardinalityFeedback;
+   std::unordered_map<NodeSet, std::optional<double>, HashNodeSet> observedRows;
 
    QueryGraph(size_t numNodes) : numNodes(numNodes) {}
 
@@ -348,6 +354,7 @@ class QueryGraph {
    ColumnSet getPKey(mlir::relalg::QueryGraph::Node& n);
    double estimateSelectivity(Operator op, NodeSet left, NodeSet right);
    void estimate();
+   std::optional<double> getObservedRows(const NodeSet& s);
    double calculateSelectivity(SelectionEdge& edge, NodeSet left, NodeSet right);
 };
 } // namespace mlir::relalg
@@ -0,0 +1,31 @@
+#ifndef MLIR_DIALECT_RELALG_TRANSFORMS_QUERYOPT_SUBPLANSIGNATURE_H
+#define MLIR_DIALECT_RELALG_TRANSFORMS_QUERYOPT_SUBPLANSIGNATURE_H
+#include "mlir/Dialect/RelAlg/IR/RelAlgOps.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+namespace mlir::relalg {
+//normalized description of a join (sub)plan: base tables (with their number of rows) and the conjuncts of all predicates, independent of the join order
+//-> used as key for cardinalities observed during execution (runtime::CardinalityFeedback)
+class SubPlanSignature {
+   std::vector<mlir::relalg::BaseTableOp> tables;
+   std::vector<PredicateOperator> predicates;
+   bool valid = true;
+
+   public:
+   void addTable(mlir::relalg::BaseTableOp baseTableOp) {
+      tables.push_back(baseTableOp);
+   }
+   void addPredicate(PredicateOperator predicateOperator) {
+      predicates.push_back(predicateOperator);
+   }
+   void invalidate() {
+      valid = false;
+   }
+   std::optional<std::string> get() const;
+   //signature of a tree consisting of base tables, selections, inner joins and cross products
+   static std::optional<std::string> of(Operator op);
+};
+} // namespace mlir::relalg
+#endif // MLIR_DIALECT_RELALG_TRANSFORMS_QUERYOPT_SUBPLANSIGNATURE_H
@@ -21,6 +21,7 @@ class CraneliftExecutionEngine {
    void translate(mlir::cranelift::FuncOp fn);
    void translate(mlir::ModuleOp module);
    void* getFunction(std::string name);
+   void* getData(std::string name);
    bool succeeded() {
       return success;
    }
@@ -0,0 +1,48 @@
+#ifndef RUNTIME_ARENA_H
+#define RUNTIME_ARENA_H
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <oneapi/tbb.h>
+namespace runtime {
+//per-query memory arena: every thread allocates from its own chunks, all chunks are released at once
+//chunks are backed by 2 MiB pages if possible and are not populated on allocation: pages are placed on the NUMA node of the thread touching them first
+//with a memory budget, chunks exceeding it are mapped from unlinked temporary files: the kernel writes them back to disk instead of running out of memory
+class Arena {
+   struct Chunk {
+      uint8_t* ptr;
+      size_t size;
+   };
+   struct LocalArena {
+      std::vector<Chunk> chunks;
+      uint8_t* current = nullptr;
+      size_t remaining = 0;
+   };
+   tbb::enumerable_thread_specific<LocalArena> localArenas;
+   //returns true if a chunk of the given size exceeds the budget (and is therefore not accounted)
+   std::function<bool(size_t)> allocateAccounted;
+   std::function<void(size_t)> releaseAccounted;
+   std::atomic<size_t> accountedBytes = 0;
+   static Chunk mapChunk(size_t bytes);
+   static Chunk mapFileChunk(size_t bytes);
+   Chunk newChunk(size_t bytes);
+
+   public:
+   static constexpr size_t hugePageSize = 2 * 1024 * 1024;
+   static constexpr size_t chunkSize = 8 * hugePageSize;
+   //returns zeroed, cache line aligned memory that stays valid until release
+   uint8_t* allocate(size_t bytes);
+   void setBudget(std::function<bool(size_t)> allocate, std::function<void(size_t)> release) {
+      allocateAccounted = std::move(allocate);
+      releaseAccounted = std::move(release);
+   }
+   void release();
+   ~Arena() {
+      release();
+   }
+};
+} // end namespace runtime
+#endif //RUNTIME_ARENA_H
@@ -5,6 +5,7 @@
 #include "ExecutionContext.h"
 #include <cstdint>
 #include <cstdlib>
+#include <stdexcept>
 #include <vector>
 
 namespace runtime {
@@ -37,16 +38,21 @@ class FlexibleBuffer {
    size_t currCapacity;
    std::vector<Buffer> buffers;
    size_t typeSize;
+   //if set, buffers are allocated from (and owned by) the arena, otherwise with malloc
+   Arena* arena;
 
+   uint8_t* allocate(size_t bytes) {
+      return arena ? arena->allocate(bytes) : (uint8_t*) malloc(bytes);
+   }
    void nextBuffer() {
       size_t nextCapacity = currCapacity * 2;
-      buffers.push_back(Buffer{0, (uint8_t*) malloc(nextCapacity * typeSize)});
+      buffers.push_back(Buffer{0, allocate(nextCapacity * typeSize)});
       currCapacity = nextCapacity;
    }
 
    public:
-   FlexibleBuffer(size_t initialCapacity, size_t typeSize) : totalLen(0), currCapacity(initialCapacity), typeSize(typeSize) {
-      buffers.push_back(Buffer{0, (uint8_t*) malloc(initialCapacity * typeSize)});
+   FlexibleBuffer(size_t initialCapacity, size_t typeSize, Arena* arena = nullptr) : totalLen(0), currCapacity(initialCapacity), typeSize(typeSize), arena(arena) {
+      buffers.push_back(Buffer{0, allocate(initialCapacity * typeSize)});
    }
    uint8_t* insert() {
       if (buffers.back().numElements == currCapacity) {
@@ -81,8 +87,14 @@ class FlexibleBuffer {
    size_t getTypeSize() const {
       return typeSize;
    }
+   Arena* getArena() const {
+      return arena;
+   }
    size_t getLen() const;
    void merge(FlexibleBuffer& other) {
+      if (arena != other.arena) {
+         throw std::runtime_error("can not merge buffers of different allocators");
+      }
       buffers.insert(buffers.begin(), other.buffers.begin(), other.buffers.end());
       other.buffers.clear();
       totalLen += other.totalLen;
@@ -90,6 +102,7 @@ class FlexibleBuffer {
       other.currCapacity = 0;
    }
    ~FlexibleBuffer() {
+      if (arena) return;
       for (auto buf : buffers) {
          free(buf.ptr);
       }
@@ -0,0 +1,41 @@
+#ifndef RUNTIME_CARDINALITYFEEDBACK_H
+#define RUNTIME_CARDINALITYFEEDBACK_H
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+namespace runtime {
+//actual cardinalities observed during query execution, keyed by a normalized signature of the (sub)plan
+class CardinalityFeedback {
+   //the least recently used entries are dropped once there are more
+   static constexpr size_t maxEntries = 10000;
+   //observations are written at most once per interval (and when destroyed)
+   static constexpr std::chrono::seconds storeInterval{1};
+   struct Entry {
+      double rows;
+      size_t lastUse;
+   };
+   std::mutex mutex;
+   std::unordered_map<std::string, Entry> observed;
+   size_t uses = 0;
+   std::string file;
+   bool persist = false;
+   bool dirty = false;
+   std::chrono::steady_clock::time_point lastStore;
+   void evict();
+   void store();
+
+   public:
+   CardinalityFeedback(std::string file) : file(std::move(file)) {}
+   static std::shared_ptr<CardinalityFeedback> load(std::string file);
+   std::optional<double> lookup(const std::string& signature);
+   //later observations replace earlier ones
+   void record(const std::unordered_map<std::string, double>& observations);
+   bool empty();
+   void setPersist(bool value);
+   ~CardinalityFeedback();
+};
+} // end namespace runtime
+#endif //RUNTIME_CARDINALITYFEEDBACK_H
@@ -1,5 +1,6 @@
 #ifndef RUNTIME_CATALOG_H
 #define RUNTIME_CATALOG_H
+#include "CardinalityFeedback.h"
 #include "Relation.h"
 namespace runtime {
 class Catalog {
@@ -7,6 +8,7 @@ class Catalog {
    virtual std::shared_ptr<Relation> findRelation(std::string name) = 0;
    virtual void addTable(std::string tableName, std::shared_ptr<TableMetaData> mD)=0;
    virtual void setPersist(bool value)=0;
+   virtual std::shared_ptr<CardinalityFeedback> getCardinalityFeedback() = 0;
    virtual ~Catalog() {}
    static std::shared_ptr<Catalog> createEmpty();
 };
@@ -20,12 +22,14 @@ class LocalCatalog : public Catalog {
    std::shared_ptr<Relation> findRelation(std::string name) override;
    void addTable(std::string tableName, std::shared_ptr<TableMetaData> mD) override;
    void setPersist(bool value) override;
+   std::shared_ptr<CardinalityFeedback> getCardinalityFeedback() override;
 };
 class DBCatalog : public Catalog {
    bool persist=false;
    std::shared_ptr<Catalog> nested;
    std::string dbDirectory;
    std::unordered_map<std::string, std::shared_ptr<Relation>> relations;
+   std::shared_ptr<CardinalityFeedback> cardinalityFeedback;
    DBCatalog(std::shared_ptr<Catalog> nested) : nested(nested) {}
 
    public:
@@ -33,6 +37,7 @@ class DBCatalog : public Catalog {
    static std::shared_ptr<DBCatalog> create(std::shared_ptr<Catalog> nested, std::string dbDir,bool eagerLoading);
    void addTable(std::string tableName, std::shared_ptr<TableMetaData> mD) override;
    void setPersist(bool value) override;
+   std::shared_ptr<CardinalityFeedback> getCardinalityFeedback() override;
 };
 
 } // end namespace runtime
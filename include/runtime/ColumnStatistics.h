@@ -0,0 +1,67 @@
+#ifndef RUNTIME_COLUMNSTATISTICS_H
+#define RUNTIME_COLUMNSTATISTICS_H
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <arrow/type_fwd.h>
+namespace runtime {
+//mergeable sketch for estimating the number of distinct values
+class HyperLogLog {
+   static constexpr size_t precision = 11;
+   std::vector<uint8_t> registers;
+
+   public:
+   static constexpr size_t numRegisters = 1 << precision;
+   HyperLogLog() : registers(numRegisters, 0) {}
+   HyperLogLog(std::vector<uint8_t> registers) : registers(std::move(registers)) {}
+   void add(uint64_t hash);
+   void merge(const HyperLogLog& other);
+   double estimate() const;
+   const std::vector<uint8_t>& getRegisters() const {
+      return registers;
+   }
+};
+//equi-depth histogram over the non-null values of a column (mapped to doubles)
+struct Histogram {
+   static constexpr size_t numBuckets = 64;
+   //bucket i contains the values in [bounds[i], bounds[i+1]], buckets with equal bounds hold a single (frequent) value
+   std::vector<double> bounds;
+   std::vector<double> counts;
+   //estimated number of values v with v < value (or v <= value)
+   double countLess(double value, bool inclusive) const;
+   //estimated number of values equal to value, given the number of distinct values
+   double countEqual(double value, double distinctValues) const;
+   double getCount() const;
+   static Histogram create(std::vector<double>& values, double scale);
+   static Histogram merge(const Histogram& left, const Histogram& right);
+};
+class ColumnStatistics {
+   size_t rows = 0;
+   std::optional<HyperLogLog> hyperLogLog;
+   std::optional<Histogram> histogram;
+
+   public:
+   ColumnStatistics(size_t rows, std::optional<HyperLogLog> hyperLogLog, std::optional<Histogram> histogram) : rows(rows), hyperLogLog(std::move(hyperLogLog)), histogram(std::move(histogram)) {}
+   //scans all values for the sketch, the histogram is built from a sample
+   static std::shared_ptr<ColumnStatistics> create(const std::shared_ptr<arrow::ChunkedArray>& column);
+   //statistics of the concatenation of both columns
+   std::shared_ptr<ColumnStatistics> merge(const ColumnStatistics& other) const;
+   size_t getRows() const {
+      return rows;
+   }
+   const std::optional<HyperLogLog>& getHyperLogLog() const {
+      return hyperLogLog;
+   }
+   const std::optional<Histogram>& getHistogram() const {
+      return histogram;
+   }
+   std::optional<size_t> getDistinctValues() const;
+   //selectivity of "column cmp value" (cmp: eq, lt, lte, gt, gte), value mapped to the domain of the histogram
+   std::optional<double> estimateSelectivity(const std::string& cmp, double value) const;
+};
+} // end namespace runtime
+#endif //RUNTIME_COLUMNSTATISTICS_H
@@ -5,7 +5,13 @@
 #include "runtime/helpers.h"
 namespace runtime {
 class DataSource {
+   protected:
+   ExecutionContext* executionContext = nullptr;
+
    public:
+   ExecutionContext* getExecutionContext() {
+      return executionContext;
+   }
    virtual size_t getColumnId(std::string member) = 0;
    virtual void iterate(bool parallel, std::vector<size_t> colIds, const std::function<void(runtime::RecordBatchInfo*)>& cb) = 0;
    virtual ~DataSource() {}
@@ -1,11 +1,16 @@
 #ifndef RUNTIME_EXECUTIONCONTEXT_H
 #define RUNTIME_EXECUTIONCONTEXT_H
+#include <atomic>
 #include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <unordered_set>
 
+#include "Arena.h"
 #include "Session.h"
+#include "helpers.h"
 
 #include <oneapi/tbb.h>
 namespace runtime {
@@ -20,10 +25,27 @@ class ExecutionContext {
    std::unordered_map<uint32_t, int64_t> tupleCounts;
    tbb::concurrent_hash_map<void*, State> states;
    tbb::enumerable_thread_specific<std::unordered_map<size_t, State>> allocators;
+   //values of the parameters of a prepared statement
+   std::vector<std::string> parameters;
+   //tiered execution: maps compiled functions to (faster) versions that became available during execution
+   std::atomic<const std::unordered_map<void*, void*>*> functionReplacements = nullptr;
+   //memory budget for states that can be spilled to disk (LINGODB_MEMORY_LIMIT in MiB, 0: unlimited)
+   //pre-aggregation spills to temporary files, states in the arena (e.g., join builds) are mapped from temporary files beyond the budget
+   size_t memoryLimit;
+   std::atomic<size_t> spillableMemory = 0;
+   //adaptive re-optimization: expected tuple counts of pipeline breakers, execution is cancelled if they are off by more than the factor
+   std::unordered_map<uint32_t, double> expectedTupleCounts;
+   double reoptimizationFactor = 0;
+   std::atomic<bool> reoptimizationRequested = false;
+   //counters of runtime events (e.g., record batches skipped by zone maps), reported after the query with LINGODB_COUNTERS
+   std::mutex countersMutex;
+   std::map<std::string, size_t> counters;
+   //memory of query states, released at once in reset()
+   Arena arena;
    Session& session;
 
    public:
-   ExecutionContext(Session& session) : session(session) {}
+   ExecutionContext(Session& session);
    Session& getSession() {
       return session;
    }
@@ -47,9 +69,39 @@ class ExecutionContext {
    }
    void setResult(uint32_t id, uint8_t* ptr);
    void setTupleCount(uint32_t id, int64_t tupleCount);
+   void expectTupleCount(uint32_t id, double rows, double factor) {
+      expectedTupleCounts[id] = rows;
+      reoptimizationFactor = factor;
+   }
+   //table scans stop producing morsels once a re-optimization was requested
+   bool isReoptimizationRequested() const {
+      return reoptimizationRequested.load(std::memory_order_relaxed);
+   }
+   void setParameters(const std::vector<std::string>& parameters) {
+      this->parameters = parameters;
+   }
+   //parameter values are passed as strings and casted to the declared type by the query
+   VarLen32 getParameter(uint32_t idx);
+   void setFunctionReplacements(const std::unordered_map<void*, void*>* replacements) {
+      functionReplacements.store(replacements, std::memory_order_release);
+   }
+   //returns the replacement of a compiled function if available, the function itself otherwise
+   void* getFunctionReplacement(void* fn);
+   //accounts memory of a spillable state, returns true if the state should be spilled
+   bool allocateSpillable(size_t bytes);
+   void releaseSpillable(size_t bytes) {
+      spillableMemory.fetch_sub(bytes);
+   }
+   //remaining memory budget
+   size_t getAvailableSpillable() const;
+   void count(const std::string& name, size_t value = 1);
+   std::map<std::string, size_t> getCounters();
    void registerState(const State& s) {
       states.insert({s.ptr, s});
    }
+   Arena& getArena() {
+      return arena;
+   }
    State& getAllocator(size_t group) {
       return allocators.local()[group];
    }
@@ -17,12 +17,14 @@ class GrowingBuffer {
    runtime::FlexibleBuffer values;
 
    public:
-   GrowingBuffer(size_t cap, size_t typeSize) : values(cap, typeSize) {}
+   GrowingBuffer(size_t cap, size_t typeSize, Arena* arena = nullptr) : values(cap, typeSize, arena) {}
    uint8_t* insert();
    static GrowingBuffer* create(GrowingBufferAllocator* allocator, ExecutionContext* executionContext, size_t sizeOfType, size_t initialCapacity);
    size_t getLen() const;
    size_t getTypeSize() const;
    runtime::Buffer sort(runtime::ExecutionContext*, bool (*compareFn)(uint8_t*, uint8_t*));
+   //keyFn computes a normalized key prefix per entry (unsigned comparison is consistent with compareFn), compareFn is only used on ties
+   runtime::Buffer sortWithKey(runtime::ExecutionContext*, bool (*compareFn)(uint8_t*, uint8_t*), uint64_t (*keyFn)(uint8_t*));
    runtime::Buffer asContinuous(ExecutionContext* executionContext);
    static void destroy(GrowingBuffer* vec);
    BufferIterator* createIterator();
@@ -4,6 +4,11 @@
 #include "runtime/Buffer.h"
 #include "runtime/RecordBatchInfo.h"
 #include <arrow/type_fwd.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
 namespace runtime {
 class HashIndexIteration;
 class HashIndexAccess;
@@ -14,19 +19,42 @@ class HashIndex : public Index {
       size_t recordBatch;
       size_t offset;
    };
-
-   Entry** ht;
-   int64_t mask;
-   runtime::FlexibleBuffer buffer;
-   std::shared_ptr<arrow::Array> hashData;
-   std::shared_ptr<arrow::Table> table;
-   std::vector<std::shared_ptr<arrow::RecordBatch>> recordBatches;
+   //bucket array and the entries linked into it: entries are allocated in chunks (one entry per row), the first chunk for the loaded table, one chunk per append
+   struct Buckets {
+      Entry** ht;
+      int64_t mask;
+      std::vector<std::pair<std::unique_ptr<Entry[]>, size_t>> entryChunks;
+      Buckets(size_t size);
+      ~Buckets();
+   };
+   //indexed rows, immutable once published: an append publishes a new version, lookups keep using the version that was current when they started
+   //versions share the buckets until they are resized, entries of newer versions are skipped by lookups of older ones (they refer to unknown record batches)
+   struct Version {
+      std::shared_ptr<Buckets> buckets;
+      std::shared_ptr<arrow::Table> table;
+      std::vector<std::shared_ptr<arrow::RecordBatch>> recordBatches;
+   };
+   std::shared_ptr<const Version> current;
+   std::mutex versionMutex;
+   size_t numEntries = 0;
+   //hash values of all rows (one array per entry chunk)
+   std::vector<std::shared_ptr<arrow::Int64Array>> hashData;
    std::string dbDir;
-   void build();
-   void computeHashes();
+   //concurrent queries may require the index at the same time: it is only loaded once. Also serializes appends
+   std::mutex loadMutex;
+   std::atomic<bool> loaded = false;
+   std::string getHashFile();
+   //prepends an entry to its chain (thread-safe)
+   static void link(Buckets& buckets, Entry* entry);
+   //a larger bucket array (with copies of all entries) if the current one is too small for the given number of entries
+   static std::shared_ptr<Buckets> resize(const std::shared_ptr<Buckets>& buckets, size_t requiredEntries);
+   //inserts the rows of a table (appended to the already indexed rows) and publishes the new version
+   void insert(std::shared_ptr<arrow::Table> rows, std::shared_ptr<arrow::Int64Array> hashes);
+   std::shared_ptr<arrow::Int64Array> computeHashes(std::shared_ptr<arrow::Table> rows);
+   std::shared_ptr<const Version> getVersion();
 
    public:
-   HashIndex(Relation& r, std::vector<std::string> keyColumns, std::string dbDir) : Index(r, keyColumns), buffer(16, sizeof(Entry)), dbDir(dbDir) {}
+   HashIndex(Relation& r, std::vector<std::string> keyColumns, std::string dbDir) : Index(r, keyColumns), dbDir(dbDir) {}
    void flush();
    void ensureLoaded() override;
    void appendRows(std::shared_ptr<arrow::Table> table) override;
@@ -35,7 +63,7 @@ class HashIndex : public Index {
    friend class HashIndexIteration;
 };
 class HashIndexAccess {
-   HashIndex& hashIndex;
+   std::shared_ptr<const HashIndex::Version> version;
    std::vector<size_t> colIds;
    std::vector<RecordBatchInfo*> recordBatchInfos;
    size_t infoSize;
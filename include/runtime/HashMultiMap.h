@@ -20,7 +20,7 @@ class HashMultiMap {
    runtime::FlexibleBuffer values;
 
    //initial value follows...
-   HashMultiMap(size_t initialCapacity, size_t entryTypeSize, size_t valueTypeSize) : ht(initialCapacity * 2), hashMask(initialCapacity * 2 - 1), entries(initialCapacity,entryTypeSize),values(initialCapacity,valueTypeSize) {}
+   HashMultiMap(size_t initialCapacity, size_t entryTypeSize, size_t valueTypeSize, Arena* arena) : ht(initialCapacity * 2), hashMask(initialCapacity * 2 - 1), entries(initialCapacity,entryTypeSize,arena),values(initialCapacity,valueTypeSize,arena) {}
 
    public:
    void resize();
@@ -16,7 +16,8 @@ class Hashtable {
    runtime::FlexibleBuffer values;
    size_t typeSize;
    //initial value follows...
-   Hashtable(size_t initialCapacity, size_t typeSize) : ht(initialCapacity * 2), hashMask(initialCapacity * 2 - 1), values(initialCapacity, typeSize), typeSize(typeSize) {}
+   Hashtable(size_t initialCapacity, size_t typeSize, Arena* arena) : ht(initialCapacity * 2), hashMask(initialCapacity * 2 - 1), values(initialCapacity, typeSize, arena), typeSize(typeSize) {}
+   void link(Entry* entry);
 
    public:
    void resize();
@@ -18,7 +18,7 @@ class Index {
    std::string name;
    std::vector<std::string> indexedColumns;
    Relation& relation;
-   bool persist;
+   bool persist = false;
 
    public:
    Index(Relation& r, std::vector<std::string> indexedColumns) : indexedColumns(indexedColumns), relation(r) {}
@@ -12,7 +12,18 @@ class HashIndexedView {
    };
    Entry** ht;
    size_t htMask; //NOLINT(clang-diagnostic-unused-private-field)
-   HashIndexedView(size_t htSize,size_t htMask);
+   //blocked bloom filter over all hashes: checked by the generated lookup code before accessing the hash table
+   uint64_t* filter;
+   size_t filterMask; //NOLINT(clang-diagnostic-unused-private-field)
+   HashIndexedView(runtime::Arena& arena, size_t htSize, size_t htMask, size_t filterSize);
+   static size_t filterPos(uint64_t hash, size_t filterMask) {
+      return (hash >> 32) & filterMask;
+   }
+   static uint64_t filterBits(uint64_t hash) {
+      return (1ull << ((hash >> 20) & 63)) | (1ull << ((hash >> 26) & 63)) | (1ull << (hash >> 58));
+   }
+   static size_t filterSize(size_t numValues);
+   void addToFilter(uint64_t hash);
    static uint64_t nextPow2(uint64_t v) {
       v--;
       v |= v >> 1;
@@ -25,10 +36,12 @@ class HashIndexedView {
       return v;
    }
 
+   //partitions the entries by bucket before building, so that every partition is built in a cache-sized range of buckets
+   static HashIndexedView* buildPartitioned(runtime::ExecutionContext* executionContext,GrowingBuffer* buffer, size_t htSize);
+
    public:
    static HashIndexedView* build(runtime::ExecutionContext* executionContext,GrowingBuffer* buffer);
    static void destroy(HashIndexedView*);
-   ~HashIndexedView();
 };
 } // end namespace runtime
 #endif // RUNTIME_LAZYJOINHASHTABLE_H
@@ -0,0 +1,25 @@
+#ifndef RUNTIME_NUMA_H
+#define RUNTIME_NUMA_H
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <arrow/type_fwd.h>
+namespace runtime {
+//NUMA topology and placement of table data (uses the syscalls directly, no dependency on libnuma)
+class Numa {
+   public:
+   //1 on non-NUMA systems or if NUMA-awareness is disabled (LINGODB_NUMA=OFF)
+   static size_t getNumNodes();
+   static size_t getCurrentNode();
+   //node of the page containing each address, getNumNodes() if unknown (e.g., page not populated yet)
+   static std::vector<size_t> getNodes(const std::vector<const void*>& addresses);
+   //distributes the record batches over all nodes in contiguous ranges: their pages are populated on, or moved to, the node of the batch
+   static void placeRecordBatches(const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches);
+   //same as placeRecordBatches, but only for the given columns (e.g., columns that were just loaded)
+   static void placeColumns(const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches, const std::vector<int>& columnIds);
+   //places only the record batches starting at index first (e.g., appended to a table), round-robin over all nodes
+   static void placeAppendedRecordBatches(const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches, size_t first);
+};
+} // end namespace runtime
+#endif //RUNTIME_NUMA_H
@@ -4,6 +4,9 @@
 #include "runtime/ThreadLocal.h"
 #include <cstddef>
 #include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
 namespace runtime {
 class PreAggregationHashtableFragment {
    public:
@@ -19,9 +22,15 @@ class PreAggregationHashtableFragment {
    size_t typeSize;
    size_t len;
    runtime::FlexibleBuffer* outputs[numOutputs];
-   PreAggregationHashtableFragment(size_t typeSize) : ht(), typeSize(typeSize), len(0), outputs() {}
+   //spilling: if the memory budget is exceeded, all outputs are written to temporary files (one per output)
+   runtime::ExecutionContext* executionContext;
+   size_t accountedBytes;
+   std::FILE* spillFiles[numOutputs];
+   size_t spilled[numOutputs];
+   PreAggregationHashtableFragment(runtime::ExecutionContext* executionContext, size_t typeSize) : ht(), typeSize(typeSize), len(0), outputs(), executionContext(executionContext), accountedBytes(0), spillFiles(), spilled() {}
    static PreAggregationHashtableFragment* create(runtime::ExecutionContext* context, size_t typeSize);
    Entry* insert(size_t hash);
+   void spill();
    ~PreAggregationHashtableFragment();
 };
 class PreAggregationHashtable {
@@ -32,7 +41,12 @@ class PreAggregationHashtable {
    };
    PartitionHt ht[PreAggregationHashtableFragment::numOutputs];
    runtime::FlexibleBuffer buffer;
-   PreAggregationHashtable() : ht(), buffer(1, sizeof(PreAggregationHashtableFragment::Entry*)) {
+   //entries read back from spill files
+   std::vector<std::unique_ptr<runtime::FlexibleBuffer>> reloaded;
+   runtime::ExecutionContext* executionContext;
+   //partition hash tables, entry pointers and reloaded entries, accounted against the memory budget
+   size_t accountedBytes;
+   PreAggregationHashtable(runtime::ExecutionContext* executionContext) : ht(), buffer(1, sizeof(PreAggregationHashtableFragment::Entry*)), executionContext(executionContext), accountedBytes(0) {
 
    }
 
@@ -5,6 +5,7 @@
 #pragma once
 namespace arrow {
 class RecordBatch;
+class ArrayData;
 } // end namespace arrow
 namespace runtime {
 struct ColumnInfo {
@@ -18,6 +19,11 @@ struct ColumnInfo {
    uint8_t* dataBuffer;
    // Pointer to  variable size data
    uint8_t* varLenBuffer;
+   // Dictionary-encoded columns: pointer to the (int32) dictionary indices, dataBuffer/varLenBuffer then belong to the dictionary
+   // nullptr for all other columns
+   uint8_t* indexBuffer;
+   // Dictionary code matches: code of the restriction value in the dictionary of the record batch (-1 if not contained)
+   int32_t code;
 };
 struct RecordBatchInfo {
    size_t numRows;
@@ -25,6 +31,9 @@ struct RecordBatchInfo {
 
    // Access buffers for record batch and handle case where valid buffer is omitted
    static uint8_t* getBuffer(arrow::RecordBatch* batch, size_t columnId, size_t bufferId);
+   static uint8_t* getBuffer(const arrow::ArrayData& data, size_t bufferId);
+   // Fill column info (without row offset of the column) for the given column of a record batch
+   static void initColumnInfo(ColumnInfo& colInfo, arrow::RecordBatch* batch, size_t columnId);
 };
 
 } // end namespace runtime
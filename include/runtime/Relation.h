@@ -5,6 +5,7 @@
 #include "metadata.h"
 namespace runtime {
 struct ExternalHashIndexMapping;
+class ZoneMap;
 class Relation {
    protected:
    std::string name;
@@ -18,18 +19,27 @@ class Relation {
       Relation::persist = persist;
    }
    virtual std::shared_ptr<TableMetaData> getMetaData() = 0;
+   //computes column statistics that are missing in the metadata, called by the optimizer before it uses them
+   virtual void ensureStatistics() {}
    virtual std::shared_ptr<arrow::RecordBatch> getSample() = 0;
    virtual std::shared_ptr<arrow::Table> getTable() = 0;
    virtual std::shared_ptr<arrow::Schema> getArrowSchema() = 0;
-   virtual const std::vector<std::shared_ptr<arrow::RecordBatch>>& getRecordBatches() = 0;
+   //immutable version of the record batches: loading columns concurrently replaces it, but does not modify it
+   virtual std::shared_ptr<const std::vector<std::shared_ptr<arrow::RecordBatch>>> getRecordBatches() = 0;
    virtual std::shared_ptr<Index> getIndex(const std::string name) = 0;
+   //min/max synopses per record batch (may be null)
+   virtual std::shared_ptr<ZoneMap> getZoneMap() = 0;
    static std::shared_ptr<Relation> loadRelation(std::string dbDir, std::string name, std::string json,bool eagerLoading);
    static std::shared_ptr<Relation> createLocalRelation(std::string name, std::shared_ptr<TableMetaData>);
    static std::shared_ptr<Relation> createDBRelation(std::string dbDir, std::string name, std::shared_ptr<TableMetaData>);
 
    //really load data
    virtual void loadData() = 0;
+   //only load the given columns (if the relation is loaded lazily)
+   virtual void loadColumns(const std::vector<std::string>& columns) = 0;
    virtual void append(std::shared_ptr<arrow::Table> toAppend) = 0;
+   //append record batches that are read incrementally (e.g. from a file), by default all batches are collected and appended at once
+   virtual void appendBatches(std::shared_ptr<arrow::RecordBatchReader> batches);
 
    virtual ~Relation(){};
 };
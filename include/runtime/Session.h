@@ -2,17 +2,39 @@
 #define RUNTIME_SESSION_H
 #include "Catalog.h"
 #include <memory>
+#include <optional>
+#include <unordered_map>
 namespace runtime {
 class ExecutionContext;
+//compiled code of a prepared statement (see execution::CompiledQuery)
+class CompiledStatement {
+   public:
+   virtual ~CompiledStatement() {}
+};
+struct PreparedStatement {
+   //sql of the PREPARE statement
+   std::string sql;
+   //number of values EXECUTE has to provide (known after the first execution)
+   std::optional<size_t> numParameters;
+   //created by the first execution and reused by all following executions
+   std::shared_ptr<CompiledStatement> compiled;
+};
 class Session {
    std::shared_ptr<Catalog> catalog;
+   std::unordered_map<std::string, std::shared_ptr<PreparedStatement>> preparedStatements;
    Session(std::shared_ptr<Catalog> catalog) : catalog(catalog) {}
 
    public:
    static std::shared_ptr<Session> createSession();
    static std::shared_ptr<Session> createSession(std::string dbDir,bool eagerLoading=true);
+   //shares the catalog (e.g., between the connections of a server), but has its own prepared statements
+   static std::shared_ptr<Session> createSession(std::shared_ptr<Catalog> catalog);
    std::shared_ptr<Catalog> getCatalog();
    std::unique_ptr<ExecutionContext> createExecutionContext();
+   void addPreparedStatement(std::string name, std::string sql);
+   std::shared_ptr<PreparedStatement> getPreparedStatement(std::string name);
+   void removePreparedStatement(std::string name);
+   void removeAllPreparedStatements();
 };
 } //end namespace runtime
 #endif //RUNTIME_SESSION_H
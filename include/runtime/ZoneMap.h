@@ -0,0 +1,31 @@
+#ifndef RUNTIME_ZONEMAP_H
+#define RUNTIME_ZONEMAP_H
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <arrow/type_fwd.h>
+namespace runtime {
+//restriction of the form "column cmp value" (cmp: eq, lt, lte, gt, gte)
+struct ScanRestriction {
+   std::string column;
+   std::string cmp;
+   std::string value;
+};
+//min/max values and null counts of all columns for every record batch of a table
+class ZoneMap {
+   //one row per record batch
+   std::shared_ptr<arrow::RecordBatch> synopses;
+
+   public:
+   ZoneMap(std::shared_ptr<arrow::RecordBatch> synopses) : synopses(synopses) {}
+   static std::shared_ptr<ZoneMap> create(const std::vector<std::shared_ptr<arrow::RecordBatch>>& recordBatches);
+   //keeps the synopses of the first record batches (that were not modified), only the following batches are analyzed
+   std::shared_ptr<ZoneMap> extend(const std::vector<std::shared_ptr<arrow::RecordBatch>>& recordBatches, size_t first) const;
+   static std::shared_ptr<ZoneMap> load(std::string file);
+   void store(std::string file);
+   //removes all record batches that can not contain a row satisfying all restrictions
+   std::vector<std::shared_ptr<arrow::RecordBatch>> filter(const std::vector<std::shared_ptr<arrow::RecordBatch>>& recordBatches, const std::vector<ScanRestriction>& restrictions);
+};
+} // end namespace runtime
+#endif //RUNTIME_ZONEMAP_H
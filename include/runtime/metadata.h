@@ -4,6 +4,7 @@
 #include <unordered_map>
 #include <variant>
 
+#include "runtime/ColumnStatistics.h"
 #include "runtime/Index.h"
 
 #include <arrow/record_batch.h>
@@ -12,14 +13,24 @@ struct ColumnType {
    std::string base;
    bool nullable;
    std::vector<std::variant<size_t, std::string>> modifiers;
+   //low-cardinality string columns can be stored dictionary-encoded (type modifier "dictionary")
+   //codes are only used by scans (equality restrictions): codes are local to a record batch, hashing (group by, joins) uses the decoded strings
+   bool isDictionaryEncoded() const;
 };
 class ColumnMetaData {
    std::optional<size_t> distinctValues;
    ColumnType columnType;
+   std::shared_ptr<ColumnStatistics> statistics;
 
    public:
    const std::optional<size_t>& getDistinctValues() const;
    void setDistinctValues(const std::optional<size_t>& distinctValues);
+   const std::shared_ptr<ColumnStatistics>& getStatistics() const {
+      return statistics;
+   }
+   void setStatistics(const std::shared_ptr<ColumnStatistics>& statistics) {
+      ColumnMetaData::statistics = statistics;
+   }
    const ColumnType& getColumnType() const;
    void setColumnType(const ColumnType& columnType);
 };
@@ -1121,6 +1121,8 @@ void DBToStdLoweringPass::runOnOperation() {
             arrowPhysicalType = mlir::IntegerType::get(t.getContext(), 128);
          } else if (auto dateType = t.dyn_cast_or_null<mlir::db::DateType>()) {
             arrowPhysicalType = dateType.getUnit() == mlir::db::DateUnitAttr::day ? mlir::IntegerType::get(t.getContext(), 32) : mlir::IntegerType::get(t.getContext(), 64);
+         } else if (auto dictionaryType = t.dyn_cast_or_null<mlir::dsa::DictionaryEncodedType>()) {
+            arrowPhysicalType = mlir::dsa::DictionaryEncodedType::get(t.getContext(), typeConverter.convertType(dictionaryType.getValueType()));
          }
          types.push_back(arrowPhysicalType);
       }
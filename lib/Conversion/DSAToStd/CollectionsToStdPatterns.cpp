@@ -97,6 +97,10 @@ class AtLowering : public OpConversionPattern<mlir::dsa::At> {
    LogicalResult matchAndRewrite(mlir::dsa::At atOp, OpAdaptor adaptor, ConversionPatternRewriter& rewriter) const override {
       auto loc = atOp->getLoc();
       auto baseType = getBaseType(atOp.getType(0));
+      //dictionary-encoding is a static property of the column (part of the row type)
+      auto columnType = atOp.getCollection().getType().cast<mlir::dsa::RecordType>().getRowType().getType(atOp.getPos());
+      bool isDictionary = columnType.isa<mlir::dsa::DictionaryEncodedType>();
+      bool isCodeMatch = columnType.isa<mlir::dsa::DictionaryCodeMatchType>();
       mlir::Value index;
       mlir::Value columnOffset;
       auto indexType = rewriter.getIndexType();
@@ -104,6 +108,8 @@ class AtLowering : public OpConversionPattern<mlir::dsa::At> {
       mlir::Value valueBuffer;
       mlir::Value validityBuffer;
       mlir::Value varLenBuffer;
+      mlir::Value indexBuffer;
+      mlir::Value code;
       mlir::Value nullMultiplier;
       {
          mlir::OpBuilder::InsertionGuard guard(rewriter);
@@ -114,7 +120,7 @@ class AtLowering : public OpConversionPattern<mlir::dsa::At> {
          index = unpacked.getResult(0);
          auto info = unpacked.getResult(1);
          size_t column = atOp.getPos();
-         size_t baseOffset = 1 + column * 5; // each column contains the following 5 values
+         size_t baseOffset = 1 + column * 7; // each column contains the following 7 values
          // columnOffset: Offset where the values for the column begins in the originalValueBuffer
          columnOffset = rewriter.create<mlir::util::GetTupleOp>(loc, rewriter.getIndexType(), info, baseOffset);
          // nullMultiplier: necessary to compute the position of validity bit in validityBuffer
@@ -126,15 +132,29 @@ class AtLowering : public OpConversionPattern<mlir::dsa::At> {
          valueBuffer = rewriter.create<mlir::util::ArrayElementPtrOp>(loc, originalValueBuffer.getType(), originalValueBuffer, columnOffset); // pointer to the column
          // varLenBuffer: pointer to variable sized data store
          varLenBuffer = rewriter.create<mlir::util::GetTupleOp>(loc, info.getType().cast<TupleType>().getType(baseOffset + 4), info, baseOffset + 4);
+         // indexBuffer: dictionary codes for dictionary-encoded columns (then, originalValueBuffer and varLenBuffer belong to the dictionary)
+         indexBuffer = rewriter.create<mlir::util::GetTupleOp>(loc, info.getType().cast<TupleType>().getType(baseOffset + 5), info, baseOffset + 5);
+         // code: code of the restriction value in the dictionary (dictionary code matches)
+         code = rewriter.create<mlir::util::GetTupleOp>(loc, rewriter.getI32Type(), info, baseOffset + 6);
       }
       Value val;
       auto* context = rewriter.getContext();
-      if (baseType.isa<util::VarLen32Type>()) {
-         Value pos1 = rewriter.create<util::LoadOp>(loc, rewriter.getI32Type(), valueBuffer, index);
+      auto loadCode = [&]() -> Value {
+         Value codes = rewriter.create<util::ArrayElementPtrOp>(loc, indexBuffer.getType(), indexBuffer, columnOffset);
+         Value rowCode = rewriter.create<util::LoadOp>(loc, rewriter.getI32Type(), codes, index);
+         rowCode.getDefiningOp()->setAttr("nosideffect", rewriter.getUnitAttr());
+         return rowCode;
+      };
+      if (isCodeMatch) {
+         val = rewriter.create<arith::CmpIOp>(loc, arith::CmpIPredicate::eq, loadCode(), code);
+      } else if (baseType.isa<util::VarLen32Type>()) {
+         // position in the offsets buffer: the code for dictionary-encoded columns
+         Value offsetPos = isDictionary ? rewriter.create<arith::IndexCastOp>(loc, indexType, loadCode()).getResult() : rewriter.create<arith::AddIOp>(loc, indexType, columnOffset, index).getResult();
+         Value pos1 = rewriter.create<util::LoadOp>(loc, rewriter.getI32Type(), originalValueBuffer, offsetPos);
          pos1.getDefiningOp()->setAttr("nosideffect", rewriter.getUnitAttr());
          Value const1 = rewriter.create<mlir::arith::ConstantIndexOp>(loc, 1);
-         Value ip1 = rewriter.create<arith::AddIOp>(loc, indexType, index, const1);
-         Value pos2 = rewriter.create<util::LoadOp>(loc, rewriter.getI32Type(), valueBuffer, ip1);
+         Value ip1 = rewriter.create<arith::AddIOp>(loc, indexType, offsetPos, const1);
+         Value pos2 = rewriter.create<util::LoadOp>(loc, rewriter.getI32Type(), originalValueBuffer, ip1);
          pos2.getDefiningOp()->setAttr("nosideffect", rewriter.getUnitAttr());
          Value len = rewriter.create<arith::SubIOp>(loc, rewriter.getI32Type(), pos2, pos1);
          Value pos1AsIndex = rewriter.create<arith::IndexCastOp>(loc, indexType, pos1);
@@ -253,6 +273,11 @@ void mlir::dsa::populateCollectionsToStdPatterns(mlir::TypeConverter& typeConver
       types.push_back(indexType);
       if (auto tupleT = recordBatchType.getRowType().dyn_cast_or_null<TupleType>()) {
          for (auto t : tupleT.getTypes()) {
+            if (auto dictionaryType = t.dyn_cast_or_null<mlir::dsa::DictionaryEncodedType>()) {
+               t = dictionaryType.getValueType();
+            } else if (t.isa<mlir::dsa::DictionaryCodeMatchType>()) {
+               t = mlir::IntegerType::get(context, 32);
+            }
             if (t.isa<mlir::util::VarLen32Type>()) {
                t = mlir::IntegerType::get(context, 32);
             } else if (t == mlir::IntegerType::get(context, 1)) {
@@ -264,6 +289,8 @@ void mlir::dsa::populateCollectionsToStdPatterns(mlir::TypeConverter& typeConver
             types.push_back(i8ptrType);
             types.push_back(mlir::util::RefType::get(context, t));
             types.push_back(i8ptrType);
+            types.push_back(mlir::util::RefType::get(context, mlir::IntegerType::get(context, 32)));
+            types.push_back(mlir::IntegerType::get(context, 32));
          }
       }
       return (Type) TupleType::get(context, types);
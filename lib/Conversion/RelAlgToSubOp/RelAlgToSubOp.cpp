@@ -1,3 +1,4 @@
+#include "json.h"
 #include "mlir-support/parsing.h"
 #include "mlir/Conversion/RelAlgToSubOp/OrderedAttributes.h"
 #include "mlir/Conversion/RelAlgToSubOp/RelAlgToSubOpPass.h"
@@ -6,6 +7,7 @@
 #include "mlir/Dialect/DB/IR/DBDialect.h"
 #include "mlir/Dialect/DB/IR/DBOps.h"
 #include "mlir/Dialect/DSA/IR/DSADialect.h"
+#include "mlir/Dialect/DSA/IR/DSAOps.h"
 #include "mlir/Dialect/Func/Transforms/FuncConversions.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "mlir/Dialect/LLVMIR/LLVMTypes.h"
@@ -38,7 +40,7 @@ struct RelalgToSubOpLoweringPass
 
    RelalgToSubOpLoweringPass() {}
    void getDependentDialects(DialectRegistry& registry) const override {
-      registry.insert<LLVM::LLVMDialect, mlir::db::DBDialect, scf::SCFDialect, mlir::cf::ControlFlowDialect, util::UtilDialect, memref::MemRefDialect, arith::ArithDialect, mlir::relalg::RelAlgDialect, mlir::subop::SubOperatorDialect>();
+      registry.insert<LLVM::LLVMDialect, mlir::db::DBDialect, mlir::dsa::DSADialect, scf::SCFDialect, mlir::cf::ControlFlowDialect, util::UtilDialect, memref::MemRefDialect, arith::ArithDialect, mlir::relalg::RelAlgDialect, mlir::subop::SubOperatorDialect>();
    }
    void runOnOperation() final;
 };
@@ -61,6 +63,102 @@ static mlir::relalg::ColumnSet getRequired(Operator op) {
    }
    return available.intersect(required);
 }
+static std::optional<std::string> getConstantValue(mlir::Value v, mlir::Type columnType) {
+   if (auto asNullableOp = mlir::dyn_cast_or_null<mlir::db::AsNullableOp>(v.getDefiningOp())) {
+      v = asNullableOp.getVal();
+   }
+   auto constantOp = mlir::dyn_cast_or_null<mlir::db::ConstantOp>(v.getDefiningOp());
+   if (!constantOp || getBaseType(constantOp.getType()) != getBaseType(columnType)) {
+      return {};
+   }
+   auto value = constantOp.getValue();
+   if (auto strAttr = value.dyn_cast_or_null<mlir::StringAttr>()) {
+      return strAttr.str();
+   } else if (auto intAttr = value.dyn_cast_or_null<mlir::IntegerAttr>()) {
+      return std::to_string(intAttr.getInt());
+   } else if (auto floatAttr = value.dyn_cast_or_null<mlir::FloatAttr>()) {
+      return nlohmann::json(floatAttr.getValueAsDouble()).dump();
+   }
+   return {};
+}
+// conditions of a selection directly consuming the base table
+static std::vector<mlir::Value> getScanConditions(mlir::relalg::BaseTableOp baseTableOp) {
+   std::vector<mlir::Value> conditions;
+   if (!baseTableOp->hasOneUse()) return conditions;
+   auto selectionOp = mlir::dyn_cast_or_null<mlir::relalg::SelectionOp>(*baseTableOp->getUsers().begin());
+   if (!selectionOp) return conditions;
+   auto returnOp = mlir::dyn_cast_or_null<mlir::tuples::ReturnOp>(selectionOp.getPredicate().front().getTerminator());
+   if (!returnOp || returnOp.getResults().size() != 1) return conditions;
+   if (auto andOp = mlir::dyn_cast_or_null<mlir::db::AndOp>(returnOp.getResults()[0].getDefiningOp())) {
+      conditions.insert(conditions.end(), andOp.getVals().begin(), andOp.getVals().end());
+   } else {
+      conditions.push_back(returnOp.getResults()[0]);
+   }
+   return conditions;
+}
+// name of the table column, if the value is a column of the base table
+static std::optional<std::string> getScanColumnName(mlir::relalg::BaseTableOp baseTableOp, mlir::Value v) {
+   if (auto getColumnOp = mlir::dyn_cast_or_null<mlir::tuples::GetColumnOp>(v.getDefiningOp())) {
+      for (auto namedAttr : baseTableOp.getColumns().getValue()) {
+         if (&namedAttr.getValue().cast<mlir::tuples::ColumnDefAttr>().getColumn() == &getColumnOp.getAttr().getColumn()) {
+            return namedAttr.getName().str();
+         }
+      }
+   }
+   return {};
+}
+// collect simple restrictions (column cmp constant) of a selection directly consuming the base table: they allow to skip record batches using zone maps
+static nlohmann::json getScanRestrictions(mlir::relalg::BaseTableOp baseTableOp) {
+   nlohmann::json restrictions = nlohmann::json::array();
+   auto addRestriction = [&](mlir::Value column, std::string cmp, mlir::Value constant) {
+      if (auto columnName = getScanColumnName(baseTableOp, column)) {
+         if (auto value = getConstantValue(constant, column.getType())) {
+            restrictions.push_back({{"column", columnName.value()}, {"cmp", cmp}, {"value", value.value()}});
+         } else if (auto parameter = mlir::db::getPreparedStatementParameter(constant); parameter && getBaseType(constant.getType()) == getBaseType(column.getType())) {
+            //value is only known at execution time
+            restrictions.push_back({{"column", columnName.value()}, {"cmp", cmp}, {"parameter", parameter->first}});
+         }
+      }
+   };
+   for (auto c : getScanConditions(baseTableOp)) {
+      if (auto cmpOp = mlir::dyn_cast_or_null<mlir::db::CmpOp>(c.getDefiningOp())) {
+         std::string cmp;
+         std::string flipped;
+         switch (cmpOp.getPredicate()) {
+            case mlir::db::DBCmpPredicate::eq: cmp = "eq"; flipped = "eq"; break;
+            case mlir::db::DBCmpPredicate::lt: cmp = "lt"; flipped = "gt"; break;
+            case mlir::db::DBCmpPredicate::lte: cmp = "lte"; flipped = "gte"; break;
+            case mlir::db::DBCmpPredicate::gt: cmp = "gt"; flipped = "lt"; break;
+            case mlir::db::DBCmpPredicate::gte: cmp = "gte"; flipped = "lte"; break;
+            default: continue;
+         }
+         addRestriction(cmpOp.getLeft(), cmp, cmpOp.getRight());
+         addRestriction(cmpOp.getRight(), flipped, cmpOp.getLeft());
+      } else if (auto betweenOp = mlir::dyn_cast_or_null<mlir::db::BetweenOp>(c.getDefiningOp())) {
+         addRestriction(betweenOp.getVal(), betweenOp.getLowerInclusive() ? "gte" : "gt", betweenOp.getLower());
+         addRestriction(betweenOp.getVal(), betweenOp.getUpperInclusive() ? "lte" : "lt", betweenOp.getUpper());
+      }
+   }
+   //equality predicates that were replaced by comparisons of dictionary codes
+   if (auto matches = baseTableOp->getAttrOfType<mlir::ArrayAttr>("dictionary_matches")) {
+      for (auto m : matches.getAsRange<mlir::DictionaryAttr>()) {
+         nlohmann::json restriction = {{"column", m.getAs<mlir::StringAttr>("column").str()}, {"cmp", "eq"}};
+         if (auto value = m.getAs<mlir::StringAttr>("value")) {
+            restriction["value"] = value.str();
+         } else {
+            restriction["parameter"] = m.getAs<mlir::IntegerAttr>("parameter").getInt();
+         }
+         restrictions.push_back(restriction);
+      }
+   }
+   return restrictions;
+}
+static bool isDictionaryEncoded(mlir::relalg::BaseTableOp baseTableOp, const std::string& column) {
+   auto meta = baseTableOp.getMeta().getMeta();
+   if (!meta->isPresent()) return false;
+   const auto& columns = meta->getOrderedColumns();
+   return std::find(columns.begin(), columns.end(), column) != columns.end() && meta->getColumnMetaData(column)->getColumnType().isDictionaryEncoded();
+}
 class BaseTableLowering : public OpConversionPattern<mlir::relalg::BaseTableOp> {
    public:
    using OpConversionPattern<mlir::relalg::BaseTableOp>::OpConversionPattern;
@@ -86,12 +184,40 @@ class BaseTableLowering : public OpConversionPattern<mlir::relalg::BaseTableOp>
          scanDescription += "\"" + memberName + "\" :\"" + identifier.str() + "\"";
 
          colNames.push_back(rewriter.getStringAttr(memberName));
-         colTypes.push_back(mlir::TypeAttr::get(attrDef.getColumn().type));
+         auto columnType = attrDef.getColumn().type;
+         if (isDictionaryEncoded(baseTableOp, identifier.str())) {
+            //the generated code accesses the values through the dictionary
+            colTypes.push_back(mlir::TypeAttr::get(mlir::dsa::DictionaryEncodedType::get(getContext(), getBaseType(columnType))));
+         } else {
+            colTypes.push_back(mlir::TypeAttr::get(columnType));
+         }
          if (required.contains(&attrDef.getColumn())) {
             mapping.push_back(rewriter.getNamedAttr(memberName, attrDef));
          }
       }
-      scanDescription += "} }";
+      auto restrictions = getScanRestrictions(baseTableOp);
+      nlohmann::json dictionaryMatches = nlohmann::json::object();
+      if (auto matches = baseTableOp->getAttrOfType<mlir::ArrayAttr>("dictionary_matches")) {
+         //the restrictions of the dictionary matches come last
+         size_t restrictionId = restrictions.size() - matches.size();
+         for (auto m : matches.getAsRange<mlir::DictionaryAttr>()) {
+            auto column = m.getAs<mlir::StringAttr>("column").str();
+            auto memberName = getUniqueMember(getContext(), column + "_match");
+            scanDescription += ",\"" + memberName + "\" :\"" + column + "\"";
+            colNames.push_back(rewriter.getStringAttr(memberName));
+            colTypes.push_back(mlir::TypeAttr::get(mlir::dsa::DictionaryCodeMatchType::get(getContext())));
+            mapping.push_back(rewriter.getNamedAttr(memberName, m.get("def")));
+            dictionaryMatches[memberName] = restrictionId++;
+         }
+      }
+      scanDescription += "}";
+      if (!restrictions.empty()) {
+         scanDescription += R"(, "restrictions": )" + restrictions.dump();
+      }
+      if (!dictionaryMatches.empty()) {
+         scanDescription += R"(, "dictionary_matches": )" + dictionaryMatches.dump();
+      }
+      scanDescription += " }";
       auto tableRefType = mlir::subop::TableType::get(rewriter.getContext(), mlir::subop::StateMembersAttr::get(rewriter.getContext(), rewriter.getArrayAttr(colNames), rewriter.getArrayAttr(colTypes)));
       mlir::Value tableRef = rewriter.create<mlir::subop::GetExternalOp>(baseTableOp->getLoc(), tableRefType, rewriter.getStringAttr(scanDescription));
       rewriter.replaceOpWithNewOp<mlir::subop::ScanOp>(baseTableOp, tableRef, rewriter.getDictionaryAttr(mapping));
@@ -134,6 +260,42 @@ static std::pair<mlir::tuples::ColumnDefAttr, mlir::tuples::ColumnRefAttr> creat
    ra.type = type;
    return {markAttrDef, columnManager.createRef(&ra)};
 }
+// equality predicates on dictionary-encoded columns (column = constant/parameter) are replaced by a column that compares the int32 codes of the column with the code of the value
+// the code is only resolved once per record batch (when scanning the table)
+static void useDictionaryCodes(mlir::relalg::BaseTableOp baseTableOp) {
+   auto* ctxt = baseTableOp.getContext();
+   std::vector<mlir::Attribute> matches;
+   for (auto c : getScanConditions(baseTableOp)) {
+      auto cmpOp = mlir::dyn_cast_or_null<mlir::db::CmpOp>(c.getDefiningOp());
+      if (!cmpOp || cmpOp.getPredicate() != mlir::db::DBCmpPredicate::eq) continue;
+      mlir::Value column = cmpOp.getLeft();
+      mlir::Value value = cmpOp.getRight();
+      if (!getScanColumnName(baseTableOp, column)) {
+         std::swap(column, value);
+      }
+      auto columnName = getScanColumnName(baseTableOp, column);
+      if (!columnName || !isDictionaryEncoded(baseTableOp, columnName.value())) continue;
+      std::vector<mlir::NamedAttribute> match;
+      match.push_back(mlir::NamedAttribute(mlir::StringAttr::get(ctxt, "column"), mlir::StringAttr::get(ctxt, columnName.value())));
+      if (auto constant = getConstantValue(value, column.getType())) {
+         match.push_back(mlir::NamedAttribute(mlir::StringAttr::get(ctxt, "value"), mlir::StringAttr::get(ctxt, constant.value())));
+      } else if (auto parameter = mlir::db::getPreparedStatementParameter(value); parameter && getBaseType(value.getType()) == getBaseType(column.getType())) {
+         match.push_back(mlir::NamedAttribute(mlir::StringAttr::get(ctxt, "parameter"), mlir::IntegerAttr::get(mlir::IntegerType::get(ctxt, 32), parameter->first)));
+      } else {
+         continue;
+      }
+      auto [matchDef, matchRef] = createColumn(cmpOp.getType(), "dict", "match");
+      match.push_back(mlir::NamedAttribute(mlir::StringAttr::get(ctxt, "def"), matchDef));
+      matches.push_back(mlir::DictionaryAttr::get(ctxt, match));
+      mlir::OpBuilder builder(cmpOp);
+      mlir::Value codesEqual = builder.create<mlir::tuples::GetColumnOp>(cmpOp->getLoc(), cmpOp.getType(), matchRef, cmpOp->getBlock()->getArgument(0));
+      cmpOp.replaceAllUsesWith(codesEqual);
+      cmpOp->erase();
+   }
+   if (!matches.empty()) {
+      baseTableOp->setAttr("dictionary_matches", mlir::ArrayAttr::get(ctxt, matches));
+   }
+}
 static mlir::Value map(mlir::Value stream, mlir::ConversionPatternRewriter& rewriter, mlir::Location loc, mlir::ArrayAttr createdColumns, std::function<std::vector<mlir::Value>(mlir::ConversionPatternRewriter&, mlir::Value, mlir::Location)> fn) {
    Block* mapBlock = new Block;
    auto tupleArg = mapBlock->addArgument(mlir::tuples::TupleType::get(rewriter.getContext()), loc);
@@ -961,6 +1123,16 @@ static mlir::Value translateINLJ(mlir::Value left, mlir::Value right, mlir::Arra
    std::vector<Attribute> keyColNames, keyColTypes, valColNames, valColTypes;
    std::vector<NamedAttribute> mapping;
 
+   // dictionary-encoded columns keep the member types of the table
+   auto tableMembers = rightScan.getState().getType().cast<mlir::subop::TableType>().getMembers();
+   auto getMemberType = [&](mlir::StringAttr member, mlir::Type columnType) -> mlir::Attribute {
+      for (size_t i = 0; i < tableMembers.getNames().size(); i++) {
+         if (tableMembers.getNames()[i] == member) {
+            return tableMembers.getTypes()[i];
+         }
+      }
+      return mlir::TypeAttr::get(columnType);
+   };
    // Create description for external index get operation
    std::string externalIndexDescription = R"({"type": "hash", "index": ")" + std::string("pk_hash") + R"(", "relation": ")" + tableName + R"(", "mapping": { )";
    for (auto namedAttr : rightScan.getMapping()) {
@@ -977,12 +1149,12 @@ static mlir::Value translateINLJ(mlir::Value left, mlir::Value right, mlir::Arra
 
       if (keyColumns.contains(&attrDef.getColumn())) {
          keyColNames.push_back((rewriter.getStringAttr(memberName)));
-         keyColTypes.push_back(mlir::TypeAttr::get(attrDef.getColumn().type));
+         keyColTypes.push_back(getMemberType(identifier, attrDef.getColumn().type));
          mapping.push_back(rewriter.getNamedAttr(memberName, attrDef));
       }
       if (valueColumns.contains(&attrDef.getColumn())) {
          keyColNames.push_back((rewriter.getStringAttr(memberName)));
-         keyColTypes.push_back(mlir::TypeAttr::get(attrDef.getColumn().type));
+         keyColTypes.push_back(getMemberType(identifier, attrDef.getColumn().type));
          mapping.push_back(rewriter.getNamedAttr(memberName, attrDef));
       }
    }
@@ -1439,11 +1611,13 @@ static mlir::Value createSortedView(ConversionPatternRewriter& rewriter, mlir::V
    block->addArguments(argumentTypes, locs);
    block->addArguments(argumentTypes, locs);
    std::vector<std::pair<mlir::Value, mlir::Value>> sortCriteria;
+   std::vector<bool> descending;
    for (auto attr : sortSpecs) {
       auto sortspecAttr = attr.cast<mlir::relalg::SortSpecificationAttr>();
       mlir::Value left = block->getArgument(sortCriteria.size());
       mlir::Value right = block->getArgument(sortCriteria.size() + sortSpecs.size());
-      if (sortspecAttr.getSortSpec() == mlir::relalg::SortSpec::desc) {
+      descending.push_back(sortspecAttr.getSortSpec() == mlir::relalg::SortSpec::desc);
+      if (descending.back()) {
          std::swap(left, right);
       }
       sortCriteria.push_back({left, right});
@@ -1459,6 +1633,8 @@ static mlir::Value createSortedView(ConversionPatternRewriter& rewriter, mlir::V
 
    auto subOpSort = rewriter.create<mlir::subop::CreateSortedViewOp>(loc, mlir::subop::SortedViewType::get(rewriter.getContext(), buffer.getType().cast<mlir::subop::State>()), buffer, rewriter.getArrayAttr(sortByMembers));
    subOpSort.getRegion().getBlocks().push_back(block);
+   //sort directions allow the lowering to compute normalized sort keys
+   subOpSort->setAttr("descending", rewriter.getBoolArrayAttr(descending));
    return subOpSort.getResult();
 }
 class SortLowering : public OpConversionPattern<mlir::relalg::SortOp> {
@@ -2676,6 +2852,7 @@ class TrackTuplesLowering : public OpConversionPattern<mlir::relalg::TrackTuples
 void RelalgToSubOpLoweringPass::runOnOperation() {
    auto module = getOperation();
    getContext().getLoadedDialect<mlir::util::UtilDialect>()->getFunctionHelper().setParentModule(module);
+   module.walk([](mlir::relalg::BaseTableOp baseTableOp) { useDictionaryCodes(baseTableOp); });
 
    // Define Conversion Target
    ConversionTarget target(getContext());
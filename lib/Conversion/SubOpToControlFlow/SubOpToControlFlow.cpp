@@ -1338,6 +1338,41 @@ class MergePreAggrHashMap : public SubOpConversionPattern<mlir::subop::MergeOp>
    }
 };
 class SortLowering : public SubOpConversionPattern<mlir::subop::CreateSortedViewOp> {
+   //maps the value of a sort key to an unsigned 64 bit integer, preserving the order (but not necessarily uniqueness)
+   static mlir::Value createNormalizedKey(mlir::OpBuilder& rewriter, mlir::Location loc, mlir::Value memberPtr, mlir::Type type) {
+      auto i64Type = rewriter.getI64Type();
+      mlir::Value signBit = rewriter.create<arith::ConstantIntOp>(loc, static_cast<int64_t>(1ull << 63), i64Type);
+      if (type.isa<mlir::db::DateType, mlir::db::TimestampType>()) {
+         mlir::Value casted = rewriter.create<mlir::util::GenericMemrefCastOp>(loc, mlir::util::RefType::get(rewriter.getContext(), i64Type), memberPtr);
+         mlir::Value value = rewriter.create<mlir::util::LoadOp>(loc, casted);
+         return rewriter.create<arith::XOrIOp>(loc, value, signBit);
+      }
+      mlir::Value value = rewriter.create<mlir::util::LoadOp>(loc, memberPtr);
+      if (auto intType = type.dyn_cast_or_null<mlir::IntegerType>()) {
+         if (intType.getWidth() == 1) {
+            value = rewriter.create<arith::ExtUIOp>(loc, i64Type, value);
+         } else if (intType.getWidth() < 64) {
+            value = rewriter.create<arith::ExtSIOp>(loc, i64Type, value);
+         }
+         return rewriter.create<arith::XOrIOp>(loc, value, signBit);
+      }
+      if (type.isa<mlir::db::DecimalType>()) {
+         value = rewriter.create<mlir::db::CastOp>(loc, rewriter.getF64Type(), value);
+      } else if (type.isF32()) {
+         value = rewriter.create<arith::ExtFOp>(loc, rewriter.getF64Type(), value);
+      }
+      //IEEE floats: flip all bits of negative values, only the sign bit of positive values
+      mlir::Value bits = rewriter.create<arith::BitcastOp>(loc, i64Type, value);
+      mlir::Value negativeMask = rewriter.create<arith::ShRSIOp>(loc, bits, rewriter.create<arith::ConstantIntOp>(loc, 63, i64Type));
+      return rewriter.create<arith::XOrIOp>(loc, bits, rewriter.create<arith::OrIOp>(loc, negativeMask, signBit));
+   }
+   static bool supportsNormalizedKey(mlir::Type type) {
+      if (auto intType = type.dyn_cast_or_null<mlir::IntegerType>()) {
+         return intType.getWidth() <= 64;
+      }
+      return type.isa<mlir::db::DateType, mlir::db::TimestampType, mlir::db::DecimalType>() || type.isF32() || type.isF64();
+   }
+
    public:
    using SubOpConversionPattern<mlir::subop::CreateSortedViewOp>::SubOpConversionPattern;
 
@@ -1368,6 +1403,37 @@ class SortLowering : public SubOpConversionPattern<mlir::subop::CreateSortedView
       });
 
       Value functionPointer = rewriter.create<mlir::func::ConstantOp>(sortOp->getLoc(), funcOp.getFunctionType(), SymbolRefAttr::get(rewriter.getStringAttr(funcOp.getSymName())));
+      auto descending = sortOp->getAttrOfType<mlir::ArrayAttr>("descending");
+      auto firstMember = sortOp.getSortBy()[0].cast<mlir::StringAttr>();
+      mlir::Type firstType;
+      for (auto m : llvm::zip(bufferType.getMembers().getNames(), bufferType.getMembers().getTypes())) {
+         if (std::get<0>(m) == firstMember) {
+            firstType = std::get<1>(m).cast<mlir::TypeAttr>().getValue();
+         }
+      }
+      if (descending && supportsNormalizedKey(firstType)) {
+         //radix sort on a normalized prefix of the first sort criterion, compare function only for ties
+         mlir::func::FuncOp keyFuncOp;
+         rewriter.atStartOf(parentModule.getBody(), [&](SubOpRewriter& rewriter) {
+            keyFuncOp = rewriter.create<mlir::func::FuncOp>(parentModule.getLoc(), "dsa_sort_key" + std::to_string(id++), mlir::FunctionType::get(getContext(), TypeRange({ptrType}), TypeRange(rewriter.getI64Type())));
+         });
+         auto* keyFuncBody = new Block;
+         keyFuncBody->addArgument(ptrType, parentModule->getLoc());
+         keyFuncOp.getBody().push_back(keyFuncBody);
+         rewriter.atStartOf(keyFuncBody, [&](SubOpRewriter& rewriter) {
+            auto loc = sortOp->getLoc();
+            Value ref = storageHelper.ensureRefType(keyFuncBody->getArgument(0), rewriter, loc);
+            Value key = createNormalizedKey(rewriter, loc, storageHelper.getPointer(ref, firstMember.str(), rewriter, loc), firstType);
+            if (descending[0].cast<mlir::BoolAttr>().getValue()) {
+               key = rewriter.create<arith::XOrIOp>(loc, key, rewriter.create<arith::ConstantIntOp>(loc, -1, rewriter.getI64Type()));
+            }
+            rewriter.create<mlir::func::ReturnOp>(loc, key);
+         });
+         Value keyFunctionPointer = rewriter.create<mlir::func::ConstantOp>(sortOp->getLoc(), keyFuncOp.getFunctionType(), SymbolRefAttr::get(rewriter.getStringAttr(keyFuncOp.getSymName())));
+         auto genericBuffer = rt::GrowingBuffer::sortWithKey(rewriter, sortOp->getLoc())({adaptor.getToSort(), getExecutionContext(rewriter, sortOp), functionPointer, keyFunctionPointer})[0];
+         rewriter.replaceOpWithNewOp<mlir::util::BufferCastOp>(sortOp, typeConverter->convertType(sortOp.getType()), genericBuffer);
+         return mlir::success();
+      }
       auto genericBuffer = rt::GrowingBuffer::sort(rewriter, sortOp->getLoc())({adaptor.getToSort(), getExecutionContext(rewriter, sortOp), functionPointer})[0];
       rewriter.replaceOpWithNewOp<mlir::util::BufferCastOp>(sortOp, typeConverter->convertType(sortOp.getType()), genericBuffer);
       return mlir::success();
@@ -2535,18 +2601,39 @@ class LookupHashIndexedViewLowering : public SubOpTupleStreamConsumerConversionP
       mlir::Value hash = mapping.resolve(lookupOp.getKeys())[0];
       auto* context = getContext();
       auto indexType = rewriter.getIndexType();
-      auto htType = util::RefType::get(context, mlir::util::RefType::get(context, rewriter.getI8Type()));
+      auto i8PtrType = mlir::util::RefType::get(context, rewriter.getI8Type());
+      auto htType = util::RefType::get(context, i8PtrType);
+      auto filterType = util::RefType::get(context, indexType);
 
-      Value castedPointer = rewriter.create<mlir::util::GenericMemrefCastOp>(loc, util::RefType::get(context, TupleType::get(context, {htType, indexType})), adaptor.getState());
+      Value castedPointer = rewriter.create<mlir::util::GenericMemrefCastOp>(loc, util::RefType::get(context, TupleType::get(context, {htType, indexType, filterType, indexType})), adaptor.getState());
 
       auto loaded = rewriter.create<util::LoadOp>(loc, castedPointer.getType().cast<mlir::util::RefType>().getElementType(), castedPointer, Value());
       auto unpacked = rewriter.create<mlir::util::UnPackOp>(loc, loaded);
       Value ht = unpacked.getResult(0);
       Value htMask = unpacked.getResult(1);
-      Value buckedPos = rewriter.create<arith::AndIOp>(loc, htMask, hash);
-      Value ptr = rewriter.create<util::LoadOp>(loc, mlir::util::RefType::get(getContext(), rewriter.getI8Type()), ht, buckedPos);
-      //optimization
-      ptr = rewriter.create<mlir::util::FilterTaggedPtr>(loc, ptr.getType(), ptr, hash);
+      Value filter = unpacked.getResult(2);
+      Value filterMask = unpacked.getResult(3);
+
+      //check the bloom filter (see runtime::HashIndexedView) before touching the hash table
+      auto shiftedBit = [&](int64_t shift) -> Value {
+         Value shifted = rewriter.create<arith::ShRUIOp>(loc, hash, rewriter.create<arith::ConstantIndexOp>(loc, shift));
+         Value bitPos = rewriter.create<arith::AndIOp>(loc, shifted, rewriter.create<arith::ConstantIndexOp>(loc, 63));
+         return rewriter.create<arith::ShLIOp>(loc, rewriter.create<arith::ConstantIndexOp>(loc, 1), bitPos);
+      };
+      Value filterPos = rewriter.create<arith::AndIOp>(loc, filterMask, rewriter.create<arith::ShRUIOp>(loc, hash, rewriter.create<arith::ConstantIndexOp>(loc, 32)));
+      Value filterWord = rewriter.create<util::LoadOp>(loc, indexType, filter, filterPos);
+      Value filterBits = rewriter.create<arith::OrIOp>(loc, rewriter.create<arith::OrIOp>(loc, shiftedBit(20), shiftedBit(26)), shiftedBit(58));
+      Value maybeContained = rewriter.create<arith::CmpIOp>(loc, arith::CmpIPredicate::eq, rewriter.create<arith::AndIOp>(loc, filterWord, filterBits), filterBits);
+      Value ptr = rewriter.create<scf::IfOp>(
+                             loc, maybeContained, [&](OpBuilder& b, Location loc) {
+                                Value buckedPos = rewriter.create<arith::AndIOp>(loc, htMask, hash);
+                                Value ptr = rewriter.create<util::LoadOp>(loc, i8PtrType, ht, buckedPos);
+                                //optimization
+                                ptr = rewriter.create<mlir::util::FilterTaggedPtr>(loc, ptr.getType(), ptr, hash);
+                                b.create<scf::YieldOp>(loc, ptr); }, [&](OpBuilder& b, Location loc) {
+                                Value invalidPtr = rewriter.create<mlir::util::InvalidRefOp>(loc, i8PtrType);
+                                b.create<scf::YieldOp>(loc, invalidPtr); })
+                     .getResult(0);
       Value matches = rewriter.create<mlir::util::PackOp>(loc, ValueRange{ptr, hash});
 
       mapping.define(lookupOp.getRef(), matches);
@@ -38,6 +38,17 @@ int getIntegerWidth(mlir::Type type, bool isUnSigned) {
    }
    return 0;
 }
+std::optional<std::pair<uint32_t, std::string>> mlir::db::getPreparedStatementParameter(mlir::Value v) {
+   while (mlir::isa_and_nonnull<mlir::db::CastOp, mlir::db::AsNullableOp>(v.getDefiningOp())) {
+      v = v.getDefiningOp()->getOperand(0);
+   }
+   auto runtimeCall = mlir::dyn_cast_or_null<mlir::db::RuntimeCall>(v.getDefiningOp());
+   if (!runtimeCall || runtimeCall.getFn() != "GetParameter") return {};
+   auto idx = runtimeCall->getAttrOfType<mlir::IntegerAttr>("parameter");
+   auto value = runtimeCall->getAttrOfType<mlir::StringAttr>("parameter_value");
+   if (!idx || !value) return {};
+   return std::make_pair(static_cast<uint32_t>(idx.getInt()), value.str());
+}
 namespace {
 
 std::tuple<arrow::Type::type, uint32_t, uint32_t> convertTypeToArrow(mlir::Type type) {
@@ -4,6 +4,7 @@
 #include "runtime-defs/DateRuntime.h"
 #include "runtime-defs/DecimalRuntime.h"
 #include "runtime-defs/DumpRuntime.h"
+#include "runtime-defs/ExecutionContext.h"
 #include "runtime-defs/FloatRuntime.h"
 #include "runtime-defs/IntegerRuntime.h"
 #include "runtime-defs/StringRuntime.h"
@@ -245,6 +246,7 @@ std::shared_ptr<mlir::db::RuntimeFunctionRegistry> mlir::db::RuntimeFunctionRegi
    auto resTypeIsF64 = [](mlir::Type t, mlir::TypeRange) { return t.isF64(); };
    auto resTypeIsBool = [](mlir::Type t, mlir::TypeRange) { return t.isInteger(1); };
    auto resTypeIsIndex = [](mlir::Type t, mlir::TypeRange) { return t.isIndex(); };
+   auto resTypeIsString = [](mlir::Type t, mlir::TypeRange) { return t.isa<mlir::db::StringType>(); };
    builtinRegistry->add("Substring").implementedAs(rt::StringRuntime::substr).matchesTypes({RuntimeFunction::stringLike, RuntimeFunction::intLike, RuntimeFunction::intLike}, RuntimeFunction::matchesArgument());
    builtinRegistry->add("StringFind").implementedAs(rt::StringRuntime::findNext).matchesTypes({RuntimeFunction::stringLike, RuntimeFunction::stringLike, RuntimeFunction::intLike}, resTypeIsI64);
    builtinRegistry->add("StringLength").implementedAs(rt::StringRuntime::len).matchesTypes({RuntimeFunction::stringLike}, resTypeIsI64);
@@ -264,6 +266,7 @@ std::shared_ptr<mlir::db::RuntimeFunctionRegistry> mlir::db::RuntimeFunctionRegi
       return res;
    });
    builtinRegistry->add("RoundInt64").implementedAs(rt::IntegerRuntime::round64).matchesTypes({RuntimeFunction::intLike, RuntimeFunction::intLike}, RuntimeFunction::matchesArgument());
+   builtinRegistry->add("GetParameter").implementedAs(rt::ExecutionContext::getParameter).matchesTypes({RuntimeFunction::anyType, RuntimeFunction::intLike}, resTypeIsString);
    builtinRegistry->add("startTiming").implementedAs(rt::Timing::start).matchesTypes({}, resTypeIsI64);
    builtinRegistry->add("startPerf").implementedAs(rt::Timing::startPerf).matchesTypes({}, RuntimeFunction::noReturnType);
    builtinRegistry->add("stopPerf").implementedAs(rt::Timing::stopPerf).matchesTypes({}, RuntimeFunction::noReturnType);
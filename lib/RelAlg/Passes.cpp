@@ -31,7 +31,7 @@ void mlir::relalg::createQueryOptPipeline(mlir::OpPassManager& pm, runtime::Cata
    }
    pm.addNestedPass<mlir::func::FuncOp>(mlir::relalg::createReduceGroupByKeysPass());
    pm.addNestedPass<mlir::func::FuncOp>(mlir::relalg::createExpandTransitiveEqualities());
-   pm.addNestedPass<mlir::func::FuncOp>(mlir::relalg::createOptimizeJoinOrderPass());
+   pm.addNestedPass<mlir::func::FuncOp>(mlir::relalg::createOptimizeJoinOrderPass(catalog ? catalog->getCardinalityFeedback() : nullptr));
 
    pm.addNestedPass<mlir::func::FuncOp>(mlir::relalg::createCombinePredicatesPass());
    pm.addNestedPass<mlir::func::FuncOp>(mlir::relalg::createOptimizeImplementationsPass());
@@ -16,6 +16,7 @@ class AttachMetaData : public mlir::PassWrapper<AttachMetaData, mlir::OperationP
       getOperation().walk([&](mlir::relalg::BaseTableOp op) {
          auto relation = catalog.findRelation(op.getTableIdentifier().str());
          if (relation) {
+            relation->ensureStatistics();
             op.setMetaAttr(mlir::relalg::TableMetaDataAttr::get(&getContext(), relation->getMetaData()));
          }
       });
@@ -14,8 +14,11 @@ class OptimizeJoinOrder : public mlir::PassWrapper<OptimizeJoinOrder, mlir::Oper
 
    public:
    MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(OptimizeJoinOrder)
+   OptimizeJoinOrder(std::shared_ptr<runtime::CardinalityFeedback> cardinalityFeedback) : cardinalityFeedback(cardinalityFeedback) {}
+
    private:
    llvm::SmallPtrSet<mlir::Operation*, 12> alreadyOptimized;
+   std::shared_ptr<runtime::CardinalityFeedback> cardinalityFeedback;
 
    bool isUnsupportedOp(mlir::Operation* op) {
       return ::llvm::TypeSwitch<mlir::Operation*, bool>(op)
@@ -113,6 +116,7 @@ class OptimizeJoinOrder : public mlir::PassWrapper<OptimizeJoinOrder, mlir::Oper
          mlir::relalg::QueryGraphBuilder queryGraphBuilder(op, alreadyOptimized);
          queryGraphBuilder.generate();
          mlir::relalg::QueryGraph& queryGraph = queryGraphBuilder.getQueryGraph();
+         queryGraph.cardinalityFeedback = cardinalityFeedback;
          queryGraph.estimate();
          //queryGraph.dump();
          //enumerates possible plans and find best one
@@ -178,6 +182,6 @@ class OptimizeJoinOrder : public mlir::PassWrapper<OptimizeJoinOrder, mlir::Oper
 
 namespace mlir {
 namespace relalg {
-std::unique_ptr<Pass> createOptimizeJoinOrderPass() { return std::make_unique<OptimizeJoinOrder>(); }
+std::unique_ptr<Pass> createOptimizeJoinOrderPass(std::shared_ptr<runtime::CardinalityFeedback> cardinalityFeedback) { return std::make_unique<OptimizeJoinOrder>(cardinalityFeedback); }
 } // end namespace relalg
 } // end namespace mlir
\ No newline at end of file
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 
 #define NDEBUG
@@ -7,6 +8,9 @@
 #include "mlir-support/eval.h"
 #include "mlir-support/parsing.h"
 #include "mlir/Dialect/RelAlg/Transforms/queryopt/QueryGraph.h"
+#include "mlir/Dialect/RelAlg/Transforms/queryopt/SubPlanSignature.h"
+#include "runtime/CardinalityFeedback.h"
+#include "runtime/metadata.h"
 
 void mlir::relalg::QueryGraph::print(llvm::raw_ostream& out) {
    out << "QueryGraph:{\n";
@@ -178,7 +182,158 @@ std::unique_ptr<support::eval::expr> mlir::relalg::buildEvalExpr(mlir::Value val
    return support::eval::createInvalid();
 }
 
-std::optional<double> estimateUsingSample(mlir::relalg::QueryGraph::Node& n) {
+//number of matching sample rows below which the sample is too coarse and column statistics are preferred
+static constexpr size_t minSampleMatches = 10;
+std::unordered_map<const mlir::tuples::Column*, std::shared_ptr<runtime::ColumnStatistics>> getColumnStatistics(mlir::relalg::QueryGraph::Node& n) {
+   std::unordered_map<const mlir::tuples::Column*, std::shared_ptr<runtime::ColumnStatistics>> res;
+   if (!n.op) return res;
+   if (auto baseTableOp = mlir::dyn_cast_or_null<mlir::relalg::BaseTableOp>(n.op.getOperation())) {
+      auto meta = baseTableOp.getMeta().getMeta();
+      const auto& orderedColumns = meta->getOrderedColumns();
+      for (auto c : baseTableOp.getColumns()) {
+         auto name = c.getName().str();
+         if (std::find(orderedColumns.begin(), orderedColumns.end(), name) == orderedColumns.end()) continue;
+         if (auto statistics = meta->getColumnMetaData(name)->getStatistics()) {
+            res[&c.getValue().cast<mlir::tuples::ColumnDefAttr>().getColumn()] = statistics;
+         }
+      }
+   }
+   return res;
+}
+static std::optional<double> parseHistogramValue(mlir::Type type, const std::string& str) {
+   std::variant<int64_t, double, std::string> parsed;
+   if (auto dateType = type.dyn_cast_or_null<mlir::db::DateType>()) {
+      if (dateType.getUnit() != mlir::db::DateUnitAttr::day) return {};
+      parsed = support::parse(str, arrow::Type::type::DATE32);
+   } else if (auto timestampType = type.dyn_cast_or_null<mlir::db::TimestampType>()) {
+      parsed = support::parse(str, arrow::Type::type::TIMESTAMP, static_cast<uint32_t>(timestampType.getUnit()));
+   } else {
+      return {};
+   }
+   if (auto* intValue = std::get_if<int64_t>(&parsed)) {
+      return static_cast<double>(*intValue);
+   }
+   return {};
+}
+//maps the value of a prepared statement parameter to the domain of the histograms
+static std::optional<double> getParameterHistogramValue(mlir::Type type, const std::string& str) {
+   try {
+      if (type.isa<mlir::db::DecimalType, mlir::FloatType>()) {
+         return std::stod(str);
+      }
+      if (type.isa<mlir::IntegerType>()) {
+         if (isIntegerType(type, 1)) return {};
+         return static_cast<double>(std::stoll(str));
+      }
+      return parseHistogramValue(type, str);
+   } catch (...) {
+      return {};
+   }
+}
+//maps a constant to the domain of the histograms (see runtime::ColumnStatistics)
+std::optional<double> getHistogramValue(mlir::Value val) {
+   if (auto parameter = mlir::db::getPreparedStatementParameter(val)) {
+      return getParameterHistogramValue(getBaseType(val.getType()), parameter->second);
+   }
+   auto constantOp = mlir::dyn_cast_or_null<mlir::db::ConstantOp>(val.getDefiningOp());
+   if (!constantOp) return {};
+   auto type = constantOp.getType();
+   auto attr = constantOp.getValue();
+   if (type.isa<mlir::db::DecimalType>()) {
+      if (auto stringAttr = attr.dyn_cast_or_null<mlir::StringAttr>()) {
+         return std::stod(stringAttr.str());
+      }
+      return {};
+   }
+   if (auto integerAttr = attr.dyn_cast_or_null<mlir::IntegerAttr>()) {
+      if (isIntegerType(type, 1)) return {};
+      return static_cast<double>(integerAttr.getInt());
+   }
+   if (auto floatAttr = attr.dyn_cast_or_null<mlir::FloatAttr>()) {
+      return floatAttr.getValueAsDouble();
+   }
+   auto stringAttr = attr.dyn_cast_or_null<mlir::StringAttr>();
+   if (!stringAttr) return {};
+   return parseHistogramValue(type, stringAttr.str());
+}
+std::optional<double> estimateUsingStatistics(mlir::Value val, std::unordered_map<const mlir::tuples::Column*, std::shared_ptr<runtime::ColumnStatistics>>& statistics) {
+   auto* op = val.getDefiningOp();
+   if (!op) return {};
+   auto getStatistics = [&](mlir::Value v) -> std::shared_ptr<runtime::ColumnStatistics> {
+      if (auto getColumnOp = mlir::dyn_cast_or_null<mlir::tuples::GetColumnOp>(v.getDefiningOp())) {
+         auto it = statistics.find(&getColumnOp.getAttr().getColumn());
+         if (it != statistics.end()) return it->second;
+      }
+      return {};
+   };
+   auto estimateComparison = [&](mlir::Value column, std::string cmp, mlir::Value constant) -> std::optional<double> {
+      auto columnStatistics = getStatistics(column);
+      if (!columnStatistics) return {};
+      if (!mlir::isa_and_nonnull<mlir::db::ConstantOp>(constant.getDefiningOp()) && !mlir::db::getPreparedStatementParameter(constant)) return {};
+      if (auto value = getHistogramValue(constant)) {
+         return columnStatistics->estimateSelectivity(cmp, value.value());
+      }
+      //no histogram for e.g. strings, but equality only depends on the number of distinct values
+      auto distinctValues = columnStatistics->getDistinctValues();
+      if (cmp == "eq" && distinctValues && distinctValues.value() > 0) {
+         return 1.0 / distinctValues.value();
+      }
+      return {};
+   };
+   if (auto andOp = mlir::dyn_cast_or_null<mlir::db::AndOp>(op)) {
+      //assume independence between conjuncts
+      double selectivity = 1;
+      for (auto v : andOp.getVals()) {
+         auto estimation = estimateUsingStatistics(v, statistics);
+         if (!estimation) return {};
+         selectivity *= estimation.value();
+      }
+      return selectivity;
+   } else if (auto cmpOp = mlir::dyn_cast_or_null<mlir::relalg::CmpOpInterface>(op)) {
+      auto left = cmpOp.getLeft();
+      auto right = cmpOp.getRight();
+      bool swapped = false;
+      if (!getStatistics(left)) {
+         std::swap(left, right);
+         swapped = true;
+      }
+      if (cmpOp.isEqualityPred(false)) {
+         return estimateComparison(left, "eq", right);
+      } else if (cmpOp.isLessPred(false)) {
+         return estimateComparison(left, swapped ? "gt" : "lt", right);
+      } else if (cmpOp.isGreaterPred(false)) {
+         return estimateComparison(left, swapped ? "lt" : "gt", right);
+      } else if (cmpOp.isLessPred(true)) {
+         return estimateComparison(left, swapped ? "gte" : "lte", right);
+      } else if (cmpOp.isGreaterPred(true)) {
+         return estimateComparison(left, swapped ? "lte" : "gte", right);
+      }
+   } else if (auto betweenOp = mlir::dyn_cast_or_null<mlir::db::BetweenOp>(op)) {
+      auto columnStatistics = getStatistics(betweenOp.getVal());
+      auto upper = estimateComparison(betweenOp.getVal(), betweenOp.getUpperInclusive() ? "lte" : "lt", betweenOp.getUpper());
+      auto lower = estimateComparison(betweenOp.getVal(), betweenOp.getLowerInclusive() ? "lt" : "lte", betweenOp.getLower());
+      if (!columnStatistics || !upper || !lower) return {};
+      return std::max(upper.value() - lower.value(), 1.0 / std::max<size_t>(1, columnStatistics->getRows()));
+   }
+   return {};
+}
+std::optional<double> estimateUsingStatistics(mlir::relalg::QueryGraph::Node& n) {
+   if (n.additionalPredicates.empty()) return {};
+   auto statistics = getColumnStatistics(n);
+   if (statistics.empty()) return {};
+   double selectivity = 1;
+   for (auto pred : n.additionalPredicates) {
+      auto selOp = mlir::dyn_cast_or_null<mlir::relalg::SelectionOp>(pred.getOperation());
+      if (!selOp) return {};
+      auto v = mlir::cast<mlir::tuples::ReturnOp>(selOp.getPredicateBlock().getTerminator()).getResults()[0];
+      auto estimation = estimateUsingStatistics(v, statistics);
+      if (!estimation) return {};
+      selectivity *= estimation.value();
+   }
+   return selectivity;
+}
+//returns the estimated selectivity and the number of matching sample rows
+std::optional<std::pair<double, size_t>> estimateUsingSample(mlir::relalg::QueryGraph::Node& n) {
    if (!n.op) return {};
    if (n.additionalPredicates.empty()) return {};
    if (auto baseTableOp = mlir::dyn_cast_or_null<mlir::relalg::BaseTableOp>(n.op.getOperation())) {
@@ -198,9 +353,9 @@ std::optional<double> estimateUsingSample(mlir::relalg::QueryGraph::Node& n) {
       }
       auto optionalCount = support::eval::countResults(sample, support::eval::createAnd(expressions));
       if (!optionalCount.has_value()) return {};
-      auto count = optionalCount.value();
-      if (count == 0) count = 1;
-      return static_cast<double>(count) / static_cast<double>(sample->num_rows());
+      auto matches = optionalCount.value();
+      auto count = matches == 0 ? 1 : matches;
+      return std::make_pair(static_cast<double>(count) / static_cast<double>(sample->num_rows()), matches);
    }
 
    return {};
@@ -254,12 +409,18 @@ void mlir::relalg::QueryGraph::estimate() {
             predicatesLeft.insert(predicate.left);
          }
          bool pKeyIncluded = !pkey.empty() && pkey.isSubsetOf(predicatesLeft);
-         if (pKeyIncluded) {
+         auto observed = getObservedRows(NodeSet::single(numNodes, node.id));
+         if (observed.has_value()) {
+            node.selectivity = std::max(observed.value(), 1.0) / node.rows;
+         } else if (pKeyIncluded) {
             node.selectivity = 1 / node.rows;
          } else {
-            auto estimation = estimateUsingSample(node);
-            if (estimation.has_value()) {
-               node.selectivity = estimation.value();
+            auto sampleEstimation = estimateUsingSample(node);
+            auto statisticsEstimation = estimateUsingStatistics(node);
+            if (sampleEstimation.has_value() && (sampleEstimation->second >= minSampleMatches || !statisticsEstimation.has_value())) {
+               node.selectivity = sampleEstimation->first;
+            } else if (statisticsEstimation.has_value()) {
+               node.selectivity = statisticsEstimation.value();
             } else {
                for (auto predicate : predicates) {
                   if (predicate.isEq) {
@@ -282,6 +443,57 @@ void mlir::relalg::QueryGraph::estimate() {
       }
    }
 }
+std::optional<double> mlir::relalg::QueryGraph::getObservedRows(const NodeSet& s) {
+   if (!cardinalityFeedback || cardinalityFeedback->empty()) return {};
+   if (auto it = observedRows.find(s); it != observedRows.end()) {
+      return it->second;
+   }
+   SubPlanSignature signature;
+   for (auto v : s) {
+      if (v >= nodes.size()) {
+         //pseudo node
+         signature.invalidate();
+         continue;
+      }
+      auto& node = nodes[v];
+      if (auto baseTableOp = mlir::dyn_cast_or_null<mlir::relalg::BaseTableOp>(node.op.getOperation())) {
+         signature.addTable(baseTableOp);
+      } else {
+         signature.invalidate();
+      }
+      for (auto pred : node.additionalPredicates) {
+         if (auto predicateOperator = mlir::dyn_cast_or_null<PredicateOperator>(pred.getOperation())) {
+            signature.addPredicate(predicateOperator);
+         } else {
+            signature.invalidate();
+         }
+      }
+   }
+   auto addEdge = [&](Operator op) {
+      if (!op) return; //forced cross product
+      if (mlir::isa<mlir::relalg::SelectionOp, mlir::relalg::InnerJoinOp>(op.getOperation())) {
+         signature.addPredicate(mlir::cast<PredicateOperator>(op.getOperation()));
+      } else {
+         signature.invalidate();
+      }
+   };
+   for (auto& edge : joins) {
+      if (edge.left.isSubsetOf(s) && edge.right.isSubsetOf(s)) {
+         addEdge(edge.op);
+      }
+   }
+   for (auto& edge : selections) {
+      if (edge.required.isSubsetOf(s)) {
+         addEdge(edge.op);
+      }
+   }
+   std::optional<double> res;
+   if (auto key = signature.get()) {
+      res = cardinalityFeedback->lookup(key.value());
+   }
+   observedRows.insert({s, res});
+   return res;
+}
 double mlir::relalg::QueryGraph::calculateSelectivity(SelectionEdge& edge, NodeSet left, NodeSet right) {
    if (edge.required.count() == 2 && left.any() && right.any()) return edge.selectivity;
    auto key = left & edge.required;
@@ -300,10 +512,12 @@ double mlir::relalg::QueryGraph::estimateSelectivity(Operator op, NodeSet left,
    double selectivity = 1.0;
    std::vector<std::pair<double, ColumnSet>> pkeysLeft;
    std::vector<std::pair<double, ColumnSet>> pkeysRight;
+   std::unordered_map<const mlir::tuples::Column*, std::shared_ptr<runtime::ColumnStatistics>> statistics;
    iterateNodes(left, [&](auto node) {
       if (node.op) {
          if (auto baseTableOp = mlir::dyn_cast_or_null<mlir::relalg::BaseTableOp>(node.op.getOperation())) {
             pkeysLeft.push_back({node.rows, getPKey(node)});
+            statistics.merge(getColumnStatistics(node));
          }
       }
    });
@@ -311,9 +525,16 @@ double mlir::relalg::QueryGraph::estimateSelectivity(Operator op, NodeSet left,
       if (node.op) {
          if (auto baseTableOp = mlir::dyn_cast_or_null<mlir::relalg::BaseTableOp>(node.op.getOperation())) {
             pkeysRight.push_back({node.rows, getPKey(node)});
+            statistics.merge(getColumnStatistics(node));
          }
       }
    });
+   auto getDistinctValues = [&](const ColumnSet& columns) -> std::optional<size_t> {
+      if (columns.size() != 1) return {};
+      auto it = statistics.find(*columns.begin());
+      if (it == statistics.end()) return {};
+      return it->second->getDistinctValues();
+   };
 
    ColumnSet predicatesLeft;
    ColumnSet predicatesRight;
@@ -338,7 +559,14 @@ double mlir::relalg::QueryGraph::estimateSelectivity(Operator op, NodeSet left,
    for (auto predicate : predicates) {
       if (predicate.left.isSubsetOf(predicatesLeft) && predicate.right.isSubsetOf(predicatesRight)) {
          if (predicate.isEq) {
-            selectivity *= 0.1;
+            auto distinctLeft = getDistinctValues(predicate.left);
+            auto distinctRight = getDistinctValues(predicate.right);
+            if (distinctLeft && distinctRight) {
+               //containment of value sets: every value of the smaller domain finds a join partner
+               selectivity *= 1.0 / std::max<size_t>(1, std::max(distinctLeft.value(), distinctRight.value()));
+            } else {
+               selectivity *= 0.1;
+            }
          } else {
             selectivity *= 0.25;
          }
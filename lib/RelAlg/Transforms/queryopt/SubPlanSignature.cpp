@@ -0,0 +1,140 @@
+#include "mlir/Dialect/RelAlg/Transforms/queryopt/SubPlanSignature.h"
+#include "mlir/Dialect/DB/IR/DBOps.h"
+#include "mlir/Dialect/TupleStream/TupleStreamOps.h"
+
+#include "llvm/ADT/EquivalenceClasses.h"
+
+#include <algorithm>
+#include <set>
+#include <unordered_map>
+namespace {
+using ColumnNames = std::unordered_map<const mlir::tuples::Column*, std::string>;
+std::optional<std::string> describe(mlir::Value v, const ColumnNames& columnNames) {
+   auto* op = v.getDefiningOp();
+   if (!op) return {};
+   if (auto getColumnOp = mlir::dyn_cast_or_null<mlir::tuples::GetColumnOp>(op)) {
+      auto it = columnNames.find(&getColumnOp.getAttr().getColumn());
+      if (it == columnNames.end()) return {};
+      return it->second;
+   }
+   if (auto deriveTruth = mlir::dyn_cast_or_null<mlir::db::DeriveTruth>(op)) {
+      return describe(deriveTruth.getVal(), columnNames);
+   }
+   std::string res;
+   llvm::raw_string_ostream out(res);
+   if (auto constantOp = mlir::dyn_cast_or_null<mlir::db::ConstantOp>(op)) {
+      constantOp.getValue().print(out);
+      out << ":" << constantOp.getType();
+      return out.str();
+   }
+   if (op->getNumRegions() > 0) return {};
+   //values of prepared statement parameters change between executions of the same (cached) plan: such predicates have no signature
+   if (op->hasAttr("parameter")) return {};
+   std::vector<std::string> operands;
+   for (auto operand : op->getOperands()) {
+      auto described = describe(operand, columnNames);
+      if (!described) return {};
+      operands.push_back(described.value());
+   }
+   auto cmpOp = mlir::dyn_cast_or_null<mlir::relalg::CmpOpInterface>(op);
+   if (mlir::isa<mlir::db::AndOp, mlir::db::OrOp>(op) || (cmpOp && cmpOp.isEqualityPred(true))) {
+      std::sort(operands.begin(), operands.end());
+   }
+   out << op->getName().getStringRef();
+   for (auto attr : op->getAttrs()) {
+      out << "[" << attr.getName().getValue() << "=" << attr.getValue() << "]";
+   }
+   out << "(";
+   for (size_t i = 0; i < operands.size(); i++) {
+      out << (i == 0 ? "" : ",") << operands[i];
+   }
+   out << ")";
+   return out.str();
+}
+void collectConjuncts(mlir::Value v, std::vector<mlir::Value>& conjuncts) {
+   if (auto andOp = mlir::dyn_cast_or_null<mlir::db::AndOp>(v.getDefiningOp())) {
+      for (auto val : andOp.getVals()) {
+         collectConjuncts(val, conjuncts);
+      }
+   } else if (auto deriveTruth = mlir::dyn_cast_or_null<mlir::db::DeriveTruth>(v.getDefiningOp())) {
+      collectConjuncts(deriveTruth.getVal(), conjuncts);
+   } else {
+      conjuncts.push_back(v);
+   }
+}
+bool collect(Operator op, mlir::relalg::SubPlanSignature& signature) {
+   if (auto baseTableOp = mlir::dyn_cast_or_null<mlir::relalg::BaseTableOp>(op.getOperation())) {
+      signature.addTable(baseTableOp);
+      return true;
+   }
+   if (mlir::isa<mlir::relalg::SelectionOp, mlir::relalg::InnerJoinOp>(op.getOperation())) {
+      signature.addPredicate(mlir::cast<PredicateOperator>(op.getOperation()));
+   } else if (!mlir::isa<mlir::relalg::CrossProductOp>(op.getOperation())) {
+      return false;
+   }
+   for (auto child : op.getChildren()) {
+      if (!collect(child, signature)) return false;
+   }
+   return true;
+}
+} // end anonymous namespace
+
+std::optional<std::string> mlir::relalg::SubPlanSignature::get() const {
+   if (!valid || tables.empty()) return {};
+   ColumnNames columnNames;
+   std::multiset<std::string> tableNames;
+   for (auto baseTableOp : tables) {
+      auto tableName = baseTableOp.getTableIdentifier().str();
+      //observations become stale once the table changes
+      tableNames.insert(tableName + "@" + std::to_string(baseTableOp.getMeta().getMeta()->getNumRows()));
+      for (auto c : baseTableOp.getColumns()) {
+         columnNames[&c.getValue().cast<mlir::tuples::ColumnDefAttr>().getColumn()] = tableName + "." + c.getName().str();
+      }
+   }
+   //equalities between columns are represented by equivalence classes: redundant (transitive) join predicates do not change the signature
+   llvm::EquivalenceClasses<std::string> equivalentColumns;
+   std::set<std::string> conjuncts;
+   for (auto predicateOperator : predicates) {
+      auto returnOp = mlir::cast<mlir::tuples::ReturnOp>(predicateOperator.getPredicateBlock().getTerminator());
+      if (returnOp.getResults().empty()) return {};
+      std::vector<mlir::Value> values;
+      collectConjuncts(returnOp.getResults()[0], values);
+      for (auto v : values) {
+         if (auto cmpOp = mlir::dyn_cast_or_null<mlir::relalg::CmpOpInterface>(v.getDefiningOp())) {
+            if (cmpOp.isEqualityPred(true) && mlir::isa_and_nonnull<mlir::tuples::GetColumnOp>(cmpOp.getLeft().getDefiningOp()) && mlir::isa_and_nonnull<mlir::tuples::GetColumnOp>(cmpOp.getRight().getDefiningOp())) {
+               auto left = describe(cmpOp.getLeft(), columnNames);
+               auto right = describe(cmpOp.getRight(), columnNames);
+               if (!left || !right) return {};
+               equivalentColumns.unionSets(left.value(), right.value());
+               continue;
+            }
+         }
+         auto described = describe(v, columnNames);
+         if (!described) return {};
+         conjuncts.insert(described.value());
+      }
+   }
+   for (auto it = equivalentColumns.begin(); it != equivalentColumns.end(); ++it) {
+      if (!it->isLeader()) continue;
+      std::set<std::string> members(equivalentColumns.member_begin(it), equivalentColumns.member_end());
+      std::string equalities;
+      for (const auto& member : members) {
+         equalities += (equalities.empty() ? "" : "=") + member;
+      }
+      conjuncts.insert(equalities);
+   }
+   std::string res;
+   for (const auto& tableName : tableNames) {
+      res += tableName + ",";
+   }
+   res += "|";
+   for (const auto& conjunct : conjuncts) {
+      res += conjunct + "&";
+   }
+   return res;
+}
+std::optional<std::string> mlir::relalg::SubPlanSignature::of(Operator op) {
+   SubPlanSignature signature;
+   if (!collect(op, signature)) return {};
+   return signature.get();
+}
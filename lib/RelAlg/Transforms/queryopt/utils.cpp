@@ -237,6 +237,7 @@ std::shared_ptr<Plan> Plan::joinPlans(NodeSet s1, NodeSet s2, std::shared_ptr<Pl
       }
    }
    std::shared_ptr<Plan> currPlan;
+   auto observedRows = queryGraph.getObservedRows(s);
 
    if (specialJoin) {
       double estimatedResultSize;
@@ -248,15 +249,15 @@ std::shared_ptr<Plan> Plan::joinPlans(NodeSet s1, NodeSet s2, std::shared_ptr<Pl
          case detail::BinaryOperatorType::MarkJoin: estimatedResultSize = p1->getRows(); break;
          default: estimatedResultSize = p1->getRows() * p2->getRows() * totalSelectivity;
       }
-      currPlan = std::make_shared<Plan>(specialJoin, std::vector<std::shared_ptr<Plan>>({p1, p2}), std::vector<Operator>(predicates.begin(), predicates.end()), estimatedResultSize);
+      currPlan = std::make_shared<Plan>(specialJoin, std::vector<std::shared_ptr<Plan>>({p1, p2}), std::vector<Operator>(predicates.begin(), predicates.end()), observedRows.value_or(estimatedResultSize));
    } else if (!predicates.empty()) {
-      auto estimatedResultSize = p1->getRows() * p2->getRows() * totalSelectivity;
+      auto estimatedResultSize = observedRows.value_or(p1->getRows() * p2->getRows() * totalSelectivity);
       if (p1->getRows() > p2->getRows()) {
          std::swap(p1, p2);
       }
       currPlan = std::make_shared<Plan>(*predicates.begin(), std::vector<std::shared_ptr<Plan>>({p1, p2}), std::vector<Operator>(++predicates.begin(), predicates.end()), estimatedResultSize);
    } else {
-      auto estimatedResultSize = p1->getRows() * p2->getRows() * totalSelectivity;
+      auto estimatedResultSize = observedRows.value_or(p1->getRows() * p2->getRows() * totalSelectivity);
       currPlan = std::make_shared<Plan>(Operator(), std::vector<std::shared_ptr<Plan>>({p1, p2}), std::vector<Operator>({}), estimatedResultSize);
    }
    currPlan->setDescription("(" + p1->getDescription() + ") join (" + p2->getDescription() + ")");
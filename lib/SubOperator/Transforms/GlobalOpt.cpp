@@ -96,23 +96,33 @@ class GlobalOptPass : public mlir::PassWrapper<GlobalOptPass, mlir::OperationPas
       getOperation().walk([&](mlir::subop::GetExternalOp op) {
          if (auto tableType = op.getType().dyn_cast_or_null<mlir::subop::TableType>()) {
             auto json = nlohmann::json::parse(op.getDescr().str());
-            externalOpByTableName[json["table"]].push_back(op);
+            //scans with different restrictions can not share the table state
+            std::string restrictions = json.contains("restrictions") ? json["restrictions"].dump() : "";
+            externalOpByTableName[json["table"].get<std::string>() + restrictions].push_back(op);
          }
       });
       mlir::OpBuilder builder(&getContext());
+      //members comparing dictionary codes refer to the same column as the member for its values
+      auto getColumnKey = [](nlohmann::json& json, const std::string& member) {
+         auto key = json["mapping"][member].get<std::string>();
+         if (json.contains("dictionary_matches") && json["dictionary_matches"].contains(member)) {
+            key += "#" + json["dictionary_matches"][member].dump();
+         }
+         return key;
+      };
       for (auto t : externalOpByTableName) {
          auto first = t.second[0];
          auto firstJson = nlohmann::json::parse(first.getDescr().str());
          std::unordered_map<std::string, std::string> columnToFirstMember;
          for (auto m : firstJson["mapping"].get<nlohmann::json::object_t>()) {
-            columnToFirstMember.insert({m.second.get<std::string>(), m.first});
+            columnToFirstMember.insert({getColumnKey(firstJson, m.first), m.first});
          }
          for (size_t i = 1; i < t.second.size(); i++) {
             auto other = t.second[i];
             auto otherJson = nlohmann::json::parse(other.getDescr().str());
             std::unordered_map<std::string, std::string> otherMemberToFirstMember;
             for (auto m : otherJson["mapping"].get<nlohmann::json::object_t>()) {
-               otherMemberToFirstMember.insert({m.first, columnToFirstMember.at(m.second.get<std::string>())});
+               otherMemberToFirstMember.insert({m.first, columnToFirstMember.at(getColumnKey(otherJson, m.first))});
             }
             if (other->getBlock() != first->getBlock()) continue;
             std::vector<mlir::Value> replaceUses;
@@ -3,56 +3,171 @@
 #include "mlir/Conversion/SCFToControlFlow/SCFToControlFlow.h"
 #include "mlir/Dialect/cranelift/CraneliftExecutionEngine.h"
 #include "mlir/Dialect/util/UtilOps.h"
+#include "mlir/ExecutionEngine/ExecutionEngine.h"
 #include "mlir/InitAllPasses.h"
+#include "mlir/Parser/Parser.h"
 #include "mlir/Pass/PassManager.h"
 
 #include "execution/Backend.h"
 #include "execution/BackendPasses.h"
 #include "execution/CraneliftBackend.h"
+#include "execution/Frontend.h"
+#include "execution/LLVMBackends.h"
+
+#include "utility/Tracer.h"
 
 #include <chrono>
+#include <cstdlib>
+#include <thread>
+namespace {
+static utility::Tracer::Event tierUp("Adaptive", "tierUp");
+
+static std::unique_ptr<mlir::cranelift::CraneliftExecutionEngine> compileWithCranelift(mlir::ModuleOp& moduleOp, bool verify, execution::Error& error, std::unordered_map<std::string, double>& timing) {
+   auto startLowerToLLVM = std::chrono::high_resolution_clock::now();
+   if (auto mainFunc = moduleOp.lookupSymbol<mlir::func::FuncOp>("main")) {
+      mlir::OpBuilder builder(moduleOp->getContext());
+      builder.setInsertionPointToStart(moduleOp.getBody());
+      builder.create<mlir::func::FuncOp>(moduleOp.getLoc(), "rt_set_execution_context", builder.getFunctionType(mlir::TypeRange({mlir::util::RefType::get(moduleOp->getContext(), mlir::IntegerType::get(moduleOp->getContext(), 8))}), mlir::TypeRange()), builder.getStringAttr("private"), mlir::ArrayAttr{}, mlir::ArrayAttr{});
+   }
+
+   mlir::PassManager pm2(moduleOp->getContext());
+   pm2.enableVerifier(verify);
+   pm2.addPass(mlir::createConvertSCFToCFPass());
+   pm2.addPass(execution::createDecomposeTuplePass());
+   pm2.addPass(mlir::createCanonicalizerPass());
+   pm2.addPass(mlir::cranelift::createLowerToCraneliftPass());
+   if (mlir::failed(pm2.run(moduleOp))) {
+      return {};
+   }
+   auto endLowerToLLVM = std::chrono::high_resolution_clock::now();
+   timing["lowerToLLVM"] = std::chrono::duration_cast<std::chrono::microseconds>(endLowerToLLVM - startLowerToLLVM).count() / 1000.0;
+   auto startJIT = std::chrono::high_resolution_clock::now();
+
+   auto engine = std::make_unique<mlir::cranelift::CraneliftExecutionEngine>(moduleOp);
+   if (!engine->succeeded()) {
+      error.emit() << "can not create cranelift execution engine";
+      return {};
+   }
+   auto endJIT = std::chrono::high_resolution_clock::now();
+   timing["llvmCodeGen"] = std::chrono::duration_cast<std::chrono::microseconds>(endJIT - startJIT).count() / 1000.0;
+   return engine;
+}
+} // end namespace
 class CraneliftBackend : public execution::ExecutionBackend {
    void execute(mlir::ModuleOp& moduleOp, runtime::ExecutionContext* executionContext) override {
-      auto startLowerToLLVM = std::chrono::high_resolution_clock::now();
-      if (auto mainFunc = moduleOp.lookupSymbol<mlir::func::FuncOp>("main")) {
-         mlir::OpBuilder builder(moduleOp->getContext());
-         builder.setInsertionPointToStart(moduleOp.getBody());
-         builder.create<mlir::func::FuncOp>(moduleOp.getLoc(), "rt_set_execution_context", builder.getFunctionType(mlir::TypeRange({mlir::util::RefType::get(moduleOp->getContext(), mlir::IntegerType::get(moduleOp->getContext(), 8))}), mlir::TypeRange()), builder.getStringAttr("private"), mlir::ArrayAttr{}, mlir::ArrayAttr{});
+      auto engine = compileWithCranelift(moduleOp, verify, error, timing);
+      if (!engine) {
+         return;
       }
+      auto setExecutionContextFn = reinterpret_cast<execution::setExecutionContextFnType>(engine->getFunction("rt_set_execution_context"));
+      auto mainFunc = reinterpret_cast<execution::mainFnType>(engine->getFunction("main"));
 
-      mlir::PassManager pm2(moduleOp->getContext());
-      pm2.enableVerifier(verify);
-      pm2.addPass(mlir::createConvertSCFToCFPass());
-      pm2.addPass(execution::createDecomposeTuplePass());
-      pm2.addPass(mlir::createCanonicalizerPass());
-      pm2.addPass(mlir::cranelift::createLowerToCraneliftPass());
-      if (mlir::failed(pm2.run(moduleOp))) {
-         return;
+      setExecutionContextFn(executionContext);
+      std::vector<double> measuredTimes;
+      for (size_t i = 0; i < numRepetitions; i++) {
+         auto executionStart = std::chrono::high_resolution_clock::now();
+         mainFunc();
+         auto executionEnd = std::chrono::high_resolution_clock::now();
+         executionContext->reset();
+         measuredTimes.push_back(std::chrono::duration_cast<std::chrono::microseconds>(executionEnd - executionStart).count() / 1000.0);
       }
-      auto endLowerToLLVM = std::chrono::high_resolution_clock::now();
-      timing["lowerToLLVM"] = std::chrono::duration_cast<std::chrono::microseconds>(endLowerToLLVM - startLowerToLLVM).count() / 1000.0;
-      auto startJIT = std::chrono::high_resolution_clock::now();
 
-      mlir::cranelift::CraneliftExecutionEngine engine(moduleOp);
-      if (!engine.succeeded()) {
-         error.emit() << "can not create cranelift execution engine";
+      timing["executionTime"] = (measuredTimes.size() > 1 ? *std::min_element(measuredTimes.begin() + 1, measuredTimes.end()) : measuredTimes[0]);
+   }
+   bool requiresSnapshotting() override {
+      return false;
+   }
+};
+//tiered execution: starts executing the query with cranelift-compiled code, while optimized code is generated with LLVM in the background
+//as soon as the optimized code is available, pipelines switch to it at the next morsel (see DataSourceIteration)
+//with LINGODB_ADAPTIVE_SWITCH=FORCE (for testing), the optimized code is awaited and every pipeline started by the cranelift code switches to it
+class AdaptiveBackend : public execution::ExecutionBackend {
+   void execute(mlir::ModuleOp& moduleOp, runtime::ExecutionContext* executionContext) override {
+      //the background compilation parses a copy of the module into its own context: MLIR contexts must not be used concurrently
+      std::string optimizedModuleSource;
+      llvm::raw_string_ostream optimizedModuleStream(optimizedModuleSource);
+      moduleOp.print(optimizedModuleStream, mlir::OpPrintingFlags().printGenericOpForm());
+      optimizedModuleStream.flush();
+      const char* switchMode = std::getenv("LINGODB_ADAPTIVE_SWITCH");
+      bool forceSwitch = switchMode && std::string(switchMode) == "FORCE";
+      std::vector<std::string> functionNames;
+      moduleOp.walk([&](mlir::func::FuncOp funcOp) {
+         if (!funcOp.isExternal()) {
+            functionNames.push_back(funcOp.getSymName().str());
+         }
+      });
+      auto engine = compileWithCranelift(moduleOp, verify, error, timing);
+      if (!engine) {
          return;
       }
-      auto setExecutionContextFn = reinterpret_cast<execution::setExecutionContextFnType>(engine.getFunction("rt_set_execution_context"));
-      auto mainFunc = reinterpret_cast<execution::mainFnType>(engine.getFunction("main"));
-      auto endJIT = std::chrono::high_resolution_clock::now();
-
-      auto totalJITTime = std::chrono::duration_cast<std::chrono::microseconds>(endJIT - startJIT).count() / 1000.0;
+      auto setExecutionContextFn = reinterpret_cast<execution::setExecutionContextFnType>(engine->getFunction("rt_set_execution_context"));
+      auto mainFunc = reinterpret_cast<execution::mainFnType>(engine->getFunction("main"));
+      std::vector<std::pair<std::string, void*>> craneliftFunctions;
+      for (auto& name : functionNames) {
+         craneliftFunctions.push_back({name, engine->getFunction(name)});
+      }
       setExecutionContextFn(executionContext);
+      //both versions use the same globals (i.e., the execution context set above)
+      std::unordered_map<std::string, void*> sharedGlobals = {{"execution_context", engine->getData("execution_context")}};
+
+      std::atomic<bool> cancelled = false;
+      std::atomic<execution::mainFnType> optimizedMainFunc = nullptr;
+      mlir::MLIRContext optimizedContext(mlir::MLIRContext::Threading::DISABLED);
+      std::unique_ptr<mlir::ExecutionEngine> optimizedEngine;
+      std::unordered_map<void*, void*> replacements;
+      std::thread compileThread([&]() {
+         utility::Tracer::Trace trace(tierUp);
+         execution::initializeContext(optimizedContext);
+         auto optimizedModule = mlir::parseSourceString<mlir::ModuleOp>(optimizedModuleSource, &optimizedContext);
+         if (!optimizedModule || cancelled) {
+            return;
+         }
+         auto optimizedModuleOp = optimizedModule.get();
+         optimizedEngine = execution::createOptimizedLLVMEngine(optimizedModuleOp, verify, cancelled, sharedGlobals);
+         if (!optimizedEngine || cancelled) {
+            return;
+         }
+         //optimization and code generation happen on the first lookup (and are stopped if cancelled in between)
+         auto setExecutionContextLookup = optimizedEngine->lookup("rt_set_execution_context");
+         if (!setExecutionContextLookup) {
+            llvm::consumeError(setExecutionContextLookup.takeError());
+            return;
+         }
+         for (auto& [name, craneliftFn] : craneliftFunctions) {
+            if (cancelled) return;
+            auto lookupResult = optimizedEngine->lookup(name);
+            if (!lookupResult) {
+               llvm::consumeError(lookupResult.takeError());
+               continue;
+            }
+            replacements[craneliftFn] = lookupResult.get();
+         }
+         if (cancelled) return;
+         if (replacements.contains(reinterpret_cast<void*>(mainFunc)) && !forceSwitch) {
+            optimizedMainFunc = reinterpret_cast<execution::mainFnType>(replacements[reinterpret_cast<void*>(mainFunc)]);
+         }
+         executionContext->setFunctionReplacements(&replacements);
+         executionContext->count("optimized functions", replacements.size());
+         trace.stop();
+      });
+      if (forceSwitch) {
+         compileThread.join();
+      }
+
       std::vector<double> measuredTimes;
       for (size_t i = 0; i < numRepetitions; i++) {
          auto executionStart = std::chrono::high_resolution_clock::now();
-         mainFunc();
+         auto* currentMainFunc = optimizedMainFunc.load();
+         (currentMainFunc ? currentMainFunc : mainFunc)();
          auto executionEnd = std::chrono::high_resolution_clock::now();
          executionContext->reset();
          measuredTimes.push_back(std::chrono::duration_cast<std::chrono::microseconds>(executionEnd - executionStart).count() / 1000.0);
       }
-      timing["llvmCodeGen"] = totalJITTime;
+      cancelled = true;
+      if (compileThread.joinable()) {
+         compileThread.join();
+      }
+      executionContext->setFunctionReplacements(nullptr);
 
       timing["executionTime"] = (measuredTimes.size() > 1 ? *std::min_element(measuredTimes.begin() + 1, measuredTimes.end()) : measuredTimes[0]);
    }
@@ -63,3 +178,6 @@ class CraneliftBackend : public execution::ExecutionBackend {
 std::unique_ptr<execution::ExecutionBackend> execution::createCraneliftBackend() {
    return std::make_unique<CraneliftBackend>();
 }
+std::unique_ptr<execution::ExecutionBackend> execution::createAdaptiveBackend() {
+   return std::make_unique<AdaptiveBackend>();
+}
@@ -7,7 +7,9 @@
 #include "mlir/Conversion/DSAToStd/DSAToStd.h"
 #include "mlir/Conversion/RelAlgToSubOp/RelAlgToSubOpPass.h"
 #include "mlir/Conversion/SubOpToControlFlow/SubOpToControlFlowPass.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/RelAlg/Passes.h"
+#include "mlir/Dialect/RelAlg/Transforms/queryopt/SubPlanSignature.h"
 #include "mlir/Dialect/SubOperator/SubOperatorOps.h"
 #include "mlir/Dialect/SubOperator/Transforms/Passes.h"
 #include "mlir/InitAllPasses.h"
@@ -33,6 +35,63 @@ static void snapshot(mlir::ModuleOp moduleOp, execution::Error& error, std::stri
 }
 } // namespace
 namespace execution {
+//data that must be loaded before a query is executed: an index of a relation, some of its columns or the whole relation
+struct RequiredData {
+   std::string relation;
+   std::optional<std::string> index;
+   std::optional<std::vector<std::string>> columns;
+};
+static std::vector<RequiredData> collectRequiredData(mlir::ModuleOp moduleOp) {
+   std::vector<RequiredData> res;
+   moduleOp.walk([&](mlir::subop::GetExternalOp getExternalOp) {
+      auto json = nlohmann::json::parse(getExternalOp.getDescr().str());
+      auto tableName = json.value("table", "");
+      if (!tableName.size()) {
+         if (json.contains("index")) {
+            res.push_back({json["relation"], json["index"], {}});
+         }
+         return;
+      }
+      // only load the columns that are actually scanned
+      std::vector<std::string> columns;
+      for (auto* user : getExternalOp->getUsers()) {
+         auto scanOp = mlir::dyn_cast_or_null<mlir::subop::ScanOp>(user);
+         if (!scanOp) {
+            res.push_back({tableName, {}, {}});
+            return;
+         }
+         for (auto member : scanOp.getReadMembers()) {
+            columns.push_back(json["mapping"][member]);
+         }
+      }
+      res.push_back({tableName, {}, columns});
+   });
+   return res;
+}
+static void loadRequiredData(runtime::Catalog* catalog, const std::vector<RequiredData>& requiredData) {
+   for (const auto& r : requiredData) {
+      if (auto relation = catalog->findRelation(r.relation)) {
+         if (r.index) {
+            relation->loadData();
+            relation->getIndex(r.index.value())->ensureLoaded();
+         } else if (r.columns) {
+            relation->loadColumns(r.columns.value());
+         } else {
+            relation->loadData();
+         }
+      }
+   }
+}
+//a compiled prepared statement: executed again without translation, optimization and compilation
+class CachedQuery : public runtime::CompiledStatement {
+   public:
+   std::shared_ptr<CompiledQuery> compiledQuery;
+   std::vector<RequiredData> requiredData;
+   std::unordered_map<uint32_t, std::string> trackedSignatures;
+   //expected tuple counts of hash join build sides (empty if the plan can not be re-optimized)
+   std::unordered_map<uint32_t, double> expectedTupleCounts;
+   size_t numThreads;
+};
 class DefaultQueryOptimizer : public QueryOptimizer {
    void optimize(mlir::ModuleOp& moduleOp) override {
       auto start = std::chrono::high_resolution_clock::now();
@@ -62,26 +121,18 @@ class RelAlgLoweringStep : public LoweringStep {
       timing["lowerRelAlg"] = std::chrono::duration_cast<std::chrono::microseconds>(endLowerRelAlg - startLowerRelAlg).count() / 1000.0;
 
       // Load the required tables/indices for the query
-      moduleOp.walk([&](mlir::Operation* op) {
-         if (auto getExternalOp = mlir::dyn_cast_or_null<mlir::subop::GetExternalOp>(*op)) {
-            auto* catalog = getCatalog();
-            auto json = nlohmann::json::parse(getExternalOp.getDescr().str());
-            auto tableName = json.value("table", "");
-            bool addIndex = false;
-            if (!tableName.size()) {
-               addIndex = json.contains("index");
-               if (!addIndex) return;
-               tableName = json["relation"];
-            }
-            // Load table
-            if (auto relation = catalog->findRelation(tableName)) {
-               relation->loadData();
-               if (addIndex) {
-                  relation->getIndex(json["index"])->ensureLoaded();
-               }
-            }
+      auto requiredData = collectRequiredData(moduleOp);
+      loadRequiredData(getCatalog(), requiredData);
+      //compiled code (e.g., in the object cache) is only valid for the same table schemas
+      std::string schemas;
+      for (const auto& r : requiredData) {
+         if (auto relation = getCatalog()->findRelation(r.relation)) {
+            schemas += r.relation + ":" + relation->getArrowSchema()->ToString() + ";";
          }
-      });
+      }
+      std::stringstream fingerprint;
+      fingerprint << std::hex << std::hash<std::string>{}(schemas);
+      moduleOp->setAttr("relalg.schema_fingerprint", mlir::StringAttr::get(moduleOp->getContext(), fingerprint.str()));
    }
 };
 class SubOpLoweringStep : public LoweringStep {
@@ -175,15 +226,38 @@ ExecutionMode getExecutionMode() {
          runMode = ExecutionMode::SPEED;
       } else if (std::string(mode) == "C") {
          runMode = ExecutionMode::C;
+      } else if (std::string(mode) == "ADAPTIVE") {
+         runMode = ExecutionMode::ADAPTIVE;
       }
    }
    return runMode;
 }
 
+static tbb::task_arena::priority getArenaPriority(QueryPriority priority) {
+   switch (priority) {
+      case QueryPriority::LOW: return tbb::task_arena::priority::low;
+      case QueryPriority::HIGH: return tbb::task_arena::priority::high;
+      default: return tbb::task_arena::priority::normal;
+   }
+}
+static QueryPriority getQueryPriority() {
+   if (const char* priority = std::getenv("LINGODB_QUERY_PRIORITY")) {
+      if (std::string(priority) == "LOW") {
+         return QueryPriority::LOW;
+      } else if (std::string(priority) == "HIGH") {
+         return QueryPriority::HIGH;
+      }
+   }
+   return QueryPriority::NORMAL;
+}
+
 class DefaultQueryExecuter : public QueryExecuter {
    size_t snapShotCounter = 0;
    void handleError(std::string phase, Error& e) {
       if (e) {
+         if (!queryExecutionConfig->exitOnError) {
+            throw std::runtime_error(phase + ": " + e.getMessage());
+         }
          std::cerr << phase << ": " << e.getMessage() << std::endl;
          exit(1);
       }
@@ -204,26 +278,56 @@ class DefaultQueryExecuter : public QueryExecuter {
       }
    }
 
-   public:
-   using QueryExecuter::QueryExecuter;
-   void execute() override {
-      if (!executionContext) {
-         std::cerr << "Execution Context is missing" << std::endl;
-         exit(1);
-      }
+   //queries that modify the database can not be restarted
+   static bool isRestartable(mlir::ModuleOp moduleOp) {
+      bool restartable = true;
+      moduleOp.walk([&](mlir::func::CallOp callOp) {
+         if (callOp.getCallee().contains("RelationHelper")) {
+            restartable = false;
+         }
+      });
+      return restartable;
+   }
+   //returns false if the execution was cancelled for re-optimization
+   bool executeCached(CachedQuery& cachedQuery, bool restarted) {
       auto* catalog = executionContext->getSession().getCatalog().get();
-
-      if (!queryExecutionConfig->frontend) {
-         std::cerr << "Frontend is missing" << std::endl;
-         exit(1);
+      loadRequiredData(catalog, cachedQuery.requiredData);
+      //the plan was optimized for the parameter values of the first execution: other values may be misestimated as well
+      if (!restarted && queryExecutionConfig->reoptimizationFactor > 0) {
+         for (auto [resultId, rows] : cachedQuery.expectedTupleCounts) {
+            executionContext->expectTupleCount(resultId, rows, queryExecutionConfig->reoptimizationFactor);
+         }
       }
-      if (!queryExecutionConfig->executionBackend) {
-         std::cerr << "Execution Backend is missing" << std::endl;
-         exit(1);
+      auto& executionBackend = *queryExecutionConfig->executionBackend;
+      tbb::task_arena arena(cachedQuery.numThreads, 1, getArenaPriority(queryExecutionConfig->priority));
+      arena.execute([&]() {
+         executionBackend.executeCompiled(*cachedQuery.compiledQuery, executionContext.get());
+      });
+      handleError("BACKEND", executionBackend.getError());
+      handleTiming(executionBackend.getTiming());
+      bool cancelled = executionContext->isReoptimizationRequested();
+      if ((queryExecutionConfig->cardinalityFeedback || cancelled) && !cachedQuery.trackedSignatures.empty()) {
+         std::unordered_map<std::string, double> observations;
+         for (auto& [resultId, signature] : cachedQuery.trackedSignatures) {
+            if (auto tupleCount = executionContext->getTupleCount(resultId)) {
+               observations[signature] = tupleCount.value();
+            }
+         }
+         catalog->getCardinalityFeedback()->record(observations);
       }
+      return !cancelled;
+   }
+   //returns false if the execution was cancelled for re-optimization
+   bool executeOnce(bool restarted) {
+      bool reoptimize = !restarted && queryExecutionConfig->reoptimizationFactor > 0;
+      //result id of the tracked tuple count -> signature of the subplan
+      std::unordered_map<uint32_t, std::string> trackedSignatures;
+      std::unordered_map<uint32_t, double> expectedTupleCounts;
+      auto* catalog = executionContext->getSession().getCatalog().get();
       auto& frontend = *queryExecutionConfig->frontend;
 
       frontend.setCatalog(catalog);
+      frontend.setSession(&executionContext->getSession());
       if (data) {
          frontend.loadFromString(data.value());
       } else if (file) {
@@ -233,6 +337,20 @@ class DefaultQueryExecuter : public QueryExecuter {
          exit(1);
       }
       handleError("FRONTEND", frontend.getError());
+      executionContext->setParameters(frontend.getParameters());
+      std::shared_ptr<runtime::PreparedStatement> preparedStatement;
+      if (auto name = frontend.getExecutedStatement(); !name.empty()) {
+         preparedStatement = executionContext->getSession().getPreparedStatement(name);
+      }
+      if (preparedStatement && preparedStatement->compiled) {
+         auto cachedQuery = std::static_pointer_cast<CachedQuery>(preparedStatement->compiled);
+         if (executeCached(*cachedQuery, restarted)) {
+            return true;
+         }
+         //the restart compiles the statement again, now with the observed cardinalities
+         preparedStatement->compiled.reset();
+         return false;
+      }
       mlir::ModuleOp& moduleOp = *queryExecutionConfig->frontend->getModule();
       performSnapShot(moduleOp, "input.mlir");
       if (queryExecutionConfig->queryOptimizer) {
@@ -241,7 +359,8 @@ class DefaultQueryExecuter : public QueryExecuter {
          queryOptimizer.optimize(moduleOp);
          handleError("OPTIMIZER", queryOptimizer.getError());
          handleTiming(queryOptimizer.getTiming());
-         if (queryExecutionConfig->trackTupleCount) {
+         reoptimize = reoptimize && isRestartable(moduleOp);
+         if (queryExecutionConfig->trackTupleCount || queryExecutionConfig->cardinalityFeedback || reoptimize) {
             mlir::PassManager pm(moduleOp.getContext());
             pm.addPass(mlir::relalg::createTrackTuplesPass());
             if (pm.run(moduleOp).failed()) {
@@ -250,6 +369,24 @@ class DefaultQueryExecuter : public QueryExecuter {
                handleError("TUPLE_TRACKING", e);
             }
          }
+         if (queryExecutionConfig->cardinalityFeedback || reoptimize) {
+            moduleOp.walk([&](mlir::relalg::TrackTuplesOP trackTuplesOp) {
+               if (auto tracked = mlir::dyn_cast_or_null<Operator>(trackTuplesOp.getRel().getDefiningOp())) {
+                  if (auto signature = mlir::relalg::SubPlanSignature::of(tracked)) {
+                     trackedSignatures[trackTuplesOp.getResultId()] = signature.value();
+                     //build sides of hash joins are complete before the rest of the plan is executed
+                     auto rowsAttr = tracked->getAttrOfType<mlir::FloatAttr>("rows");
+                     bool isBuildSide = llvm::any_of(tracked->getUses(), [](mlir::OpOperand& use) {
+                        return use.getOperandNumber() == 0 && use.getOwner()->hasAttr("useHashJoin");
+                     });
+                     if (reoptimize && rowsAttr && isBuildSide) {
+                        expectedTupleCounts[trackTuplesOp.getResultId()] = rowsAttr.getValueAsDouble();
+                        executionContext->expectTupleCount(trackTuplesOp.getResultId(), rowsAttr.getValueAsDouble(), queryExecutionConfig->reoptimizationFactor);
+                     }
+                  }
+               }
+            });
+         }
          performSnapShot(moduleOp);
       }
       bool parallelismEnabled = queryExecutionConfig->parallel;
@@ -261,10 +398,15 @@ class DefaultQueryExecuter : public QueryExecuter {
             numThreads = std::stol(mode);
          }
       }
+      if (queryExecutionConfig->concurrency) {
+         numThreads = queryExecutionConfig->concurrency;
+      }
       if (!frontend.isParallelismAllowed() || !parallelismEnabled) {
          moduleOp->setAttr("subop.sequential", mlir::UnitAttr::get(moduleOp->getContext()));
          numThreads = 1;
       }
+      numThreads = std::max<size_t>(numThreads, 1);
+      std::vector<RequiredData> requiredData;
       for (auto& loweringStepPtr : queryExecutionConfig->loweringSteps) {
          auto& loweringStep = *loweringStepPtr;
          loweringStep.setCatalog(catalog);
@@ -272,30 +414,89 @@ class DefaultQueryExecuter : public QueryExecuter {
          handleError("LOWERING", loweringStep.getError());
          handleTiming(loweringStep.getTiming());
          performSnapShot(moduleOp);
+         if (preparedStatement && requiredData.empty()) {
+            requiredData = collectRequiredData(moduleOp);
+         }
       }
 
-      auto& executionBackend = *queryExecutionConfig->executionBackend;
+      //a restarted query is recompiled cheaply if possible
+      auto& executionBackend = restarted && queryExecutionConfig->reoptimizationBackend ? *queryExecutionConfig->reoptimizationBackend : *queryExecutionConfig->executionBackend;
       executionBackend.setSnapShotCounter(snapShotCounter);
 
-      tbb::global_control c(tbb::global_control::max_allowed_parallelism, numThreads);
-      int sum = oneapi::tbb::parallel_reduce(
-         oneapi::tbb::blocked_range<int>(1, 100000), 0,
-         [](oneapi::tbb::blocked_range<int> const& r, int init) -> int {
-            for (int v = r.begin(); v != r.end(); v++) {
-               init += v;
-            }
-            return init;
-         },
-         [](int lhs, int rhs) -> int {
-            return lhs + rhs;
-         });
-      if (sum < 0) { exit(0); }
-      executionBackend.execute(moduleOp, executionContext.get());
+      //the query only uses the threads of its own arena: concurrent queries do not interfere via global tbb state
+      tbb::task_arena arena(numThreads, 1, getArenaPriority(queryExecutionConfig->priority));
+      arena.execute([&]() {
+         int sum = oneapi::tbb::parallel_reduce(
+            oneapi::tbb::blocked_range<int>(1, 100000), 0,
+            [](oneapi::tbb::blocked_range<int> const& r, int init) -> int {
+               for (int v = r.begin(); v != r.end(); v++) {
+                  init += v;
+               }
+               return init;
+            },
+            [](int lhs, int rhs) -> int {
+               return lhs + rhs;
+            });
+         if (sum < 0) { exit(0); }
+         executionBackend.execute(moduleOp, executionContext.get());
+      });
 #ifdef TRACER
       utility::Tracer::dump();
 #endif
       handleError("BACKEND", executionBackend.getError());
       handleTiming(executionBackend.getTiming());
+      bool cancelled = executionContext->isReoptimizationRequested();
+      //later executions of the prepared statement reuse the compiled code (and the plan optimized for the first parameter values)
+      if (preparedStatement && !cancelled) {
+         if (auto compiledQuery = executionBackend.getCompiledQuery()) {
+            auto cachedQuery = std::make_shared<CachedQuery>();
+            cachedQuery->compiledQuery = compiledQuery;
+            cachedQuery->requiredData = std::move(requiredData);
+            cachedQuery->trackedSignatures = trackedSignatures;
+            cachedQuery->expectedTupleCounts = std::move(expectedTupleCounts);
+            cachedQuery->numThreads = numThreads;
+            preparedStatement->compiled = cachedQuery;
+         }
+      }
+      //the observed cardinalities of the cancelled execution are used for optimizing the restarted query
+      if (!trackedSignatures.empty() && (queryExecutionConfig->cardinalityFeedback || cancelled)) {
+         std::unordered_map<std::string, double> observations;
+         for (auto& [resultId, signature] : trackedSignatures) {
+            if (auto tupleCount = executionContext->getTupleCount(resultId)) {
+               observations[signature] = tupleCount.value();
+            }
+         }
+         catalog->getCardinalityFeedback()->record(observations);
+      }
+      return !cancelled;
+   }
+
+   public:
+   using QueryExecuter::QueryExecuter;
+   void execute() override {
+      if (!executionContext) {
+         std::cerr << "Execution Context is missing" << std::endl;
+         exit(1);
+      }
+      if (!queryExecutionConfig->frontend) {
+         std::cerr << "Frontend is missing" << std::endl;
+         exit(1);
+      }
+      if (!queryExecutionConfig->executionBackend) {
+         std::cerr << "Execution Backend is missing" << std::endl;
+         exit(1);
+      }
+      if (!executeOnce(false)) {
+         //restart at most once: the query is parsed and optimized again, now with the observed cardinalities
+         executionContext = executionContext->getSession().createExecutionContext();
+         executionContext->count("query restarts");
+         executeOnce(true);
+      }
+      if (std::getenv("LINGODB_COUNTERS")) {
+         for (const auto& [name, value] : executionContext->getCounters()) {
+            std::cerr << name << ": " << value << std::endl;
+         }
+      }
       if (queryExecutionConfig->resultProcessor) {
          auto& resultProcessor = *queryExecutionConfig->resultProcessor;
          resultProcessor.process(executionContext.get());
@@ -327,14 +528,35 @@ std::unique_ptr<QueryExecutionConfig> createQueryExecutionConfig(execution::Exec
       config->executionBackend = createCraneliftBackend();
 #else
       config->executionBackend = createDefaultLLVMBackend();
+#endif
+   } else if (runMode == ExecutionMode::ADAPTIVE) {
+#if CRANELIFT_ENABLED == 1
+      config->executionBackend = createAdaptiveBackend();
+#else
+      config->executionBackend = createDefaultLLVMBackend();
 #endif
    } else {
       config->executionBackend = createDefaultLLVMBackend();
    }
    config->resultProcessor = execution::createTablePrinter();
+   config->priority = getQueryPriority();
+   if (const char* mode = std::getenv("LINGODB_CARDINALITY_FEEDBACK")) {
+      config->cardinalityFeedback = std::string(mode) == "ON";
+   }
+   if (const char* factor = std::getenv("LINGODB_REOPTIMIZATION_FACTOR")) {
+      config->reoptimizationFactor = std::stod(factor);
+#if CRANELIFT_ENABLED == 1
+      if (config->reoptimizationFactor > 0 && (runMode == ExecutionMode::SPEED || runMode == ExecutionMode::DEFAULT)) {
+         config->reoptimizationBackend = createAdaptiveBackend();
+      }
+#endif
+   }
    if (runMode == ExecutionMode::SPEED || runMode == ExecutionMode::EXTREME_CHEAP) {
       config->queryOptimizer->disableVerification();
       config->executionBackend->disableVerification();
+      if (config->reoptimizationBackend) {
+         config->reoptimizationBackend->disableVerification();
+      }
       for (auto& loweringStep : config->loweringSteps) {
          loweringStep->disableVerification();
       }
@@ -86,6 +86,8 @@ class SQLFrontend : public execution::Frontend {
    mlir::MLIRContext context;
    mlir::OwningOpRef<mlir::ModuleOp> module;
    bool parallismAllowed;
+   std::vector<std::string> parameters;
+   std::string executedStatement;
    void loadFromString(std::string sql) override {
       execution::initializeContext(context);
 
@@ -93,8 +95,10 @@ class SQLFrontend : public execution::Frontend {
 
       mlir::ModuleOp moduleOp = builder.create<mlir::ModuleOp>(builder.getUnknownLoc());
       frontend::sql::Parser translator(sql, *catalog, moduleOp);
+      translator.session = session;
       builder.setInsertionPointToStart(moduleOp.getBody());
       auto* queryBlock = new mlir::Block;
+      translator.queryBlock = queryBlock;
       std::vector<mlir::Type> returnTypes;
       {
          mlir::OpBuilder::InsertionGuard guard(builder);
@@ -109,6 +113,8 @@ class SQLFrontend : public execution::Frontend {
       funcOp.getBody().push_back(queryBlock);
       module = moduleOp;
       parallismAllowed=translator.isParallelismAllowed();
+      parameters = translator.parameters;
+      executedStatement = translator.executedStatement;
    }
    void loadFromFile(std::string fileName) override {
       std::ifstream istream{fileName};
@@ -127,6 +133,12 @@ class SQLFrontend : public execution::Frontend {
    bool isParallelismAllowed() override{
       return parallismAllowed;
    }
+   std::vector<std::string> getParameters() override {
+      return parameters;
+   }
+   std::string getExecutedStatement() override {
+      return executedStatement;
+   }
 };
 } // namespace
 std::unique_ptr<execution::Frontend> execution::createMLIRFrontend() {
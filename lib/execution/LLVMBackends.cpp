@@ -19,27 +19,55 @@
 #include "mlir/Target/LLVMIR/Dialect/LLVMIR/LLVMToLLVMIRTranslation.h"
 #include "mlir/Target/LLVMIR/Export.h"
 
+#include "llvm/Analysis/InlineCost.h"
 #include "llvm/BinaryFormat/Dwarf.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/CodeGen/TargetRegisterInfo.h"
+#include "llvm/ExecutionEngine/Orc/CompileUtils.h"
+#include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
+#include "llvm/ExecutionEngine/Orc/ExecutorProcessControl.h"
+#include "llvm/ExecutionEngine/Orc/IndirectionUtils.h"
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/ExecutionEngine/Orc/LazyReexports.h"
+#include "llvm/IR/InstIterator.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/Linker/Linker.h"
 #include "llvm/MC/TargetRegistry.h"
+#include "llvm/Passes/PassBuilder.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/xxhash.h"
+#include "llvm/Transforms/IPO/Inliner.h"
 #include "llvm/Transforms/InstCombine/InstCombine.h"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Scalar/GVN.h"
+#include "llvm/Transforms/Utils/Cloning.h"
 
+#include <atomic>
+#include <condition_variable>
 #include <csignal>
+#include <deque>
 #include <filesystem>
 #include <fstream>
+#include <mutex>
+#include <sstream>
 #include <spawn.h>
+#include <thread>
+#include <unordered_set>
 
 #include "dlfcn.h"
 #include "unistd.h"
 #include "utility/Tracer.h"
+namespace execution {
+//generated at build time (see lib/execution/CMakeLists.txt), empty if runtime bitcode is not available
+extern const uint8_t runtimeBitcode[];
+extern const size_t runtimeBitcodeSize;
+} // namespace execution
 namespace {
-static utility::Tracer::Event execution("LLVM", "execution");
+static utility::Tracer::Event executionEvent("LLVM", "execution");
 
 static bool lowerToLLVMDialect(mlir::ModuleOp& moduleOp, bool verify) {
    mlir::PassManager pm2(moduleOp->getContext());
@@ -85,7 +113,151 @@ static void addLLVMExecutionContextFuncs(mlir::ModuleOp& moduleOp) {
    }
 }
 
-static llvm::Error performDefaultLLVMPasses(llvm::Module* module) {
+static const std::unordered_set<std::string>& getRuntimeFunctionNames() {
+   static std::unordered_set<std::string> names = []() {
+      std::unordered_set<std::string> res;
+      mlir::util::FunctionHelper::visitAllFunctions([&](std::string s, void* ptr) { res.insert(s); });
+      return res;
+   }();
+   return names;
+}
+static void collectGlobals(llvm::Value* value, std::unordered_set<llvm::GlobalValue*>& globals, std::unordered_set<llvm::Value*>& visited) {
+   if (!visited.insert(value).second) return;
+   if (auto* global = llvm::dyn_cast<llvm::GlobalValue>(value)) {
+      globals.insert(global);
+   } else if (auto* constant = llvm::dyn_cast<llvm::Constant>(value)) {
+      for (auto* operand : constant->operand_values()) {
+         collectGlobals(operand, globals, visited);
+      }
+   }
+}
+//a runtime function can be imported into the query module if all globals it references are available there as well:
+//runtime functions (resolved to the host process), symbols exported by the process (e.g., libc), constants and other importable functions
+//mutable globals must not be duplicated, functions that reference them stay opaque calls
+static bool canImport(llvm::GlobalValue* global, std::unordered_map<llvm::GlobalValue*, bool>& importable) {
+   if (auto it = importable.find(global); it != importable.end()) {
+      return it->second;
+   }
+   auto* function = llvm::dyn_cast<llvm::Function>(global);
+   auto* globalVar = llvm::dyn_cast<llvm::GlobalVariable>(global);
+   if (function && (function->isIntrinsic() || getRuntimeFunctionNames().contains(function->getName().str()))) {
+      return true;
+   }
+   if ((function || globalVar) && global->isDeclaration()) {
+      return dlsym(RTLD_DEFAULT, global->getName().str().c_str()) != nullptr;
+   }
+   if (!function && !(globalVar && globalVar->isConstant() && !globalVar->isThreadLocal())) {
+      return false;
+   }
+   //optimistic for recursive functions
+   importable[global] = true;
+   bool res = true;
+   std::unordered_set<llvm::GlobalValue*> globals;
+   std::unordered_set<llvm::Value*> visited;
+   if (globalVar) {
+      collectGlobals(globalVar->getInitializer(), globals, visited);
+   } else if (auto err = function->materialize()) {
+      llvm::consumeError(std::move(err));
+      res = false;
+   } else {
+      for (auto& inst : llvm::instructions(*function)) {
+         for (auto* operand : inst.operand_values()) {
+            collectGlobals(operand, globals, visited);
+         }
+      }
+   }
+   for (auto* referenced : globals) {
+      if (!res) break;
+      res = canImport(referenced, importable);
+   }
+   importable[global] = res;
+   return res;
+}
+//links the definitions of called runtime functions into the query module (LINGODB_RUNTIME_INLINING=OFF to disable)
+//imported runtime functions are available_externally: if they are not inlined, the runtime function of the process is called
+static bool linkRuntimeBitcode(llvm::Module* module) {
+   static bool enabled = []() {
+      const char* mode = std::getenv("LINGODB_RUNTIME_INLINING");
+      return execution::runtimeBitcodeSize > 0 && !(mode && std::string(mode) == "OFF");
+   }();
+   if (!enabled) return false;
+   auto bitcode = llvm::MemoryBufferRef(llvm::StringRef(reinterpret_cast<const char*>(execution::runtimeBitcode), execution::runtimeBitcodeSize), "runtime.bc");
+   auto maybeRuntimeModule = llvm::getLazyBitcodeModule(bitcode, module->getContext());
+   if (!maybeRuntimeModule) {
+      //e.g., bitcode produced by a different LLVM version
+      llvm::consumeError(maybeRuntimeModule.takeError());
+      return false;
+   }
+   auto runtimeModule = std::move(maybeRuntimeModule.get());
+   runtimeModule->setDataLayout(module->getDataLayout());
+   runtimeModule->setTargetTriple(module->getTargetTriple());
+   std::unordered_map<llvm::GlobalValue*, bool> importable;
+   std::unordered_set<std::string> imported;
+   for (auto& function : *module) {
+      if (!function.isDeclaration() || !getRuntimeFunctionNames().contains(function.getName().str())) continue;
+      auto* runtimeFunction = runtimeModule->getFunction(function.getName());
+      if (runtimeFunction && !runtimeFunction->isDeclaration() && canImport(runtimeFunction, importable)) {
+         imported.insert(function.getName().str());
+      }
+   }
+   if (imported.empty()) return false;
+   for (auto& function : *runtimeModule) {
+      if (!function.isDeclaration() && !importable[&function]) {
+         function.deleteBody();
+         function.setComdat(nullptr);
+      }
+   }
+   for (auto& globalVar : runtimeModule->globals()) {
+      if (!globalVar.isDeclaration() && !importable[&globalVar]) {
+         globalVar.setInitializer(nullptr);
+         globalVar.setLinkage(llvm::GlobalValue::ExternalLinkage);
+         globalVar.setComdat(nullptr);
+      }
+   }
+   for (auto& [global, canBeImported] : importable) {
+      if (canBeImported && llvm::isa<llvm::Function>(global)) imported.insert(global->getName().str());
+   }
+   if (llvm::Linker::linkModules(*module, std::move(runtimeModule), llvm::Linker::Flags::LinkOnlyNeeded)) {
+      return false;
+   }
+   for (auto& function : *module) {
+      if (function.isDeclaration() || !imported.contains(function.getName().str())) continue;
+      if (getRuntimeFunctionNames().contains(function.getName().str())) {
+         function.setLinkage(llvm::GlobalValue::AvailableExternallyLinkage);
+      } else if (!function.hasLocalLinkage()) {
+         function.setLinkage(llvm::GlobalValue::InternalLinkage);
+      }
+      function.setComdat(nullptr);
+      //compiled for the host cpu like the query itself
+      function.removeFnAttr("target-cpu");
+      function.removeFnAttr("target-features");
+      function.removeFnAttr("tune-cpu");
+   }
+   return true;
+}
+static void inlineRuntimeFunctions(llvm::Module* module) {
+   llvm::LoopAnalysisManager loopAM;
+   llvm::FunctionAnalysisManager functionAM;
+   llvm::CGSCCAnalysisManager cgsccAM;
+   llvm::ModuleAnalysisManager moduleAM;
+   llvm::PassBuilder passBuilder;
+   passBuilder.registerModuleAnalyses(moduleAM);
+   passBuilder.registerCGSCCAnalyses(cgsccAM);
+   passBuilder.registerFunctionAnalyses(functionAM);
+   passBuilder.registerLoopAnalyses(loopAM);
+   passBuilder.crossRegisterProxies(loopAM, functionAM, cgsccAM, moduleAM);
+   llvm::ModulePassManager modulePM;
+   modulePM.addPass(llvm::ModuleInlinerWrapperPass(llvm::getInlineParams()));
+   modulePM.run(*module, moduleAM);
+}
+
+static llvm::Error performDefaultLLVMPasses(llvm::Module* module, const std::atomic<bool>* cancelled = nullptr) {
+   if (linkRuntimeBitcode(module)) {
+      if (cancelled && cancelled->load()) {
+         return llvm::make_error<llvm::StringError>("compilation cancelled", llvm::inconvertibleErrorCode());
+      }
+      inlineRuntimeFunctions(module);
+   }
    llvm::legacy::FunctionPassManager funcPM(module);
    funcPM.add(llvm::createInstructionCombiningPass());
    funcPM.add(llvm::createReassociatePass());
@@ -94,11 +266,18 @@ static llvm::Error performDefaultLLVMPasses(llvm::Module* module) {
 
    funcPM.doInitialization();
    for (auto& func : *module) {
+      if (cancelled && cancelled->load()) {
+         return llvm::make_error<llvm::StringError>("compilation cancelled", llvm::inconvertibleErrorCode());
+      }
       if (!func.hasOptNone()) {
          funcPM.run(func);
       }
    }
    funcPM.doFinalization();
+   //code generation follows directly after the optimization
+   if (cancelled && cancelled->load()) {
+      return llvm::make_error<llvm::StringError>("compilation cancelled", llvm::inconvertibleErrorCode());
+   }
    return llvm::Error::success();
 }
 
@@ -154,6 +333,376 @@ static void linkStatic(mlir::ExecutionEngine* engine, execution::Error& error, e
    return;
 }
 
+static llvm::orc::SymbolMap getRuntimeSymbolMap(llvm::orc::MangleAndInterner interner) {
+   auto symbolMap = llvm::orc::SymbolMap();
+   mlir::util::FunctionHelper::visitAllFunctions([&](std::string s, void* ptr) {
+      symbolMap[interner(s)] = llvm::orc::ExecutorSymbolDef(llvm::orc::ExecutorAddr::fromPtr(ptr), llvm::JITSymbolFlags::Exported);
+   });
+   execution::visitBareFunctions([&](std::string s, void* ptr) {
+      symbolMap[interner(s)] = llvm::orc::ExecutorSymbolDef(llvm::orc::ExecutorAddr::fromPtr(ptr), llvm::JITSymbolFlags::Exported);
+   });
+   return symbolMap;
+}
+//cached object files are only valid for the same (lowered) query module, target and build
+//the module carries a fingerprint of the schemas of the scanned tables (relalg.schema_fingerprint), s.t. DDL invalidates the cached objects
+static std::string getObjectCacheKey(mlir::ModuleOp moduleOp) {
+   std::string moduleStr;
+   llvm::raw_string_ostream moduleStream(moduleStr);
+   moduleOp.print(moduleStream);
+   moduleStream.flush();
+   std::string buildId = llvm::sys::getProcessTriple() + llvm::sys::getHostCPUName().str();
+   std::error_code ec;
+   auto executable = std::filesystem::read_symlink("/proc/self/exe", ec);
+   if (!ec) {
+      buildId += executable.string() + std::to_string(std::filesystem::last_write_time(executable, ec).time_since_epoch().count());
+   }
+   std::stringstream key;
+   key << std::hex << llvm::xxHash64(moduleStr) << "-" << llvm::xxHash64(buildId);
+   return key.str();
+}
+static llvm::Error addRuntimeSymbols(llvm::orc::LLJIT& jit) {
+   auto& mainJD = jit.getMainJITDylib();
+   if (auto err = mainJD.define(llvm::orc::absoluteSymbols(getRuntimeSymbolMap(llvm::orc::MangleAndInterner(jit.getExecutionSession(), jit.getDataLayout()))))) {
+      return err;
+   }
+   auto processSymbols = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(jit.getDataLayout().getGlobalPrefix());
+   if (!processSymbols) {
+      return processSymbols.takeError();
+   }
+   mainJD.addGenerator(std::move(*processSymbols));
+   return llvm::Error::success();
+}
+static llvm::Expected<std::unique_ptr<llvm::orc::LLJIT>> loadCachedObject(std::string objectFile) {
+   auto jit = llvm::orc::LLJITBuilder().create();
+   if (!jit) {
+      return jit.takeError();
+   }
+   if (auto err = addRuntimeSymbols(**jit)) {
+      return std::move(err);
+   }
+   auto buffer = llvm::MemoryBuffer::getFile(objectFile);
+   if (!buffer) {
+      return llvm::errorCodeToError(buffer.getError());
+   }
+   if (auto err = (*jit)->addObjectFile(std::move(*buffer))) {
+      return std::move(err);
+   }
+   return jit;
+}
+
+//parallel and lazy compilation (LINGODB_PARALLEL_JIT=OFF to disable): functions whose address escapes (pipelines, callbacks of the runtime)
+//are compiled in separate modules on the compile threads shared by all queries. They are called through stubs that wait for the compilation on the first call
+static size_t getParallelJITThreads() {
+   static size_t threads = []() -> size_t {
+      const char* mode = std::getenv("LINGODB_PARALLEL_JIT");
+      if (mode && std::string(mode) == "OFF") return 0;
+      return std::max(1u, std::thread::hardware_concurrency());
+   }();
+   return threads;
+}
+//modules with fewer separately compiled functions are compiled at once: splitting them costs more than it saves
+static constexpr size_t minParallelJITFunctions = 4;
+static llvm::ThreadPool& getCompileThreads() {
+   static llvm::ThreadPool compileThreads(llvm::hardware_concurrency(getParallelJITThreads()));
+   return compileThreads;
+}
+//runs the materialization tasks of one query on the shared compile threads, at most maxRunning of them at the same time
+class CompileThreadsTaskDispatcher : public llvm::orc::TaskDispatcher {
+   std::mutex mutex;
+   std::condition_variable idle;
+   std::deque<std::unique_ptr<llvm::orc::Task>> pending;
+   size_t maxRunning;
+   size_t running = 0;
+   bool shutDown = false;
+
+   void run(llvm::orc::Task* unownedTask) {
+      std::unique_ptr<llvm::orc::Task> task(unownedTask);
+      while (task) {
+         task->run();
+         task.reset();
+         std::unique_lock<std::mutex> lock(mutex);
+         if (!pending.empty()) {
+            task = std::move(pending.front());
+            pending.pop_front();
+         } else if (--running == 0) {
+            idle.notify_all();
+         }
+      }
+   }
+
+   public:
+   explicit CompileThreadsTaskDispatcher(size_t maxRunning) : maxRunning(std::max<size_t>(1, maxRunning)) {}
+   void dispatch(std::unique_ptr<llvm::orc::Task> task) override {
+      {
+         std::unique_lock<std::mutex> lock(mutex);
+         if (shutDown) {
+            lock.unlock();
+            task->run();
+            return;
+         }
+         if (running == maxRunning) {
+            pending.push_back(std::move(task));
+            return;
+         }
+         running++;
+      }
+      getCompileThreads().async([this, unownedTask = task.release()]() { run(unownedTask); });
+   }
+   //waits for the running compilations of this query
+   void shutdown() override {
+      std::unique_lock<std::mutex> lock(mutex);
+      shutDown = true;
+      idle.wait(lock, [&]() { return running == 0; });
+   }
+};
+//functions whose address escapes: each of them is compiled in a separate module (see partitionQueryModule)
+static size_t countParallelJITFunctions(mlir::ModuleOp moduleOp) {
+   std::unordered_set<std::string> functions;
+   moduleOp.walk([&](mlir::LLVM::AddressOfOp addressOfOp) {
+      if (auto funcOp = mlir::SymbolTable::lookupNearestSymbolFrom<mlir::LLVM::LLVMFuncOp>(addressOfOp, addressOfOp.getGlobalNameAttr())) {
+         if (!funcOp.isExternal()) functions.insert(funcOp.getName().str());
+      }
+   });
+   return functions.size();
+}
+static bool isRequiredInMainModule(const llvm::Function& function) {
+   return function.getName() == "main" || function.getName() == "rt_set_execution_context";
+}
+static bool addressEscapes(const llvm::Function& function) {
+   return std::any_of(function.use_begin(), function.use_end(), [](const llvm::Use& use) {
+      auto* call = llvm::dyn_cast<llvm::CallBase>(use.getUser());
+      return !call || !call->isCallee(&use);
+   });
+}
+//functions that are only called directly are copied into the modules of their callers: they remain inlinable
+static void collectDirectCallees(const llvm::Function* function, std::unordered_set<const llvm::Function*>& functions) {
+   if (!functions.insert(function).second) return;
+   for (const auto& inst : llvm::instructions(*function)) {
+      if (auto* call = llvm::dyn_cast<llvm::CallBase>(&inst)) {
+         auto* callee = call->getCalledFunction();
+         if (callee && !callee->isDeclaration() && callee->hasLocalLinkage()) {
+            collectDirectCallees(callee, functions);
+         }
+      }
+   }
+}
+//every module gets its own LLVMContext: modules sharing a context can not be compiled concurrently
+static llvm::Expected<llvm::orc::ThreadSafeModule> extractModule(const llvm::Module& module, const std::unordered_set<const llvm::Function*>& functions, bool withGlobalVariables) {
+   llvm::ValueToValueMapTy valueMap;
+   auto extracted = llvm::CloneModule(module, valueMap, [&](const llvm::GlobalValue* global) {
+      if (auto* function = llvm::dyn_cast<llvm::Function>(global)) {
+         return functions.contains(function);
+      }
+      return withGlobalVariables || global->hasLocalLinkage();
+   });
+   for (auto& function : llvm::make_early_inc_range(extracted->functions())) {
+      if (function.isDeclaration() && function.use_empty()) function.eraseFromParent();
+   }
+   for (auto& globalVar : llvm::make_early_inc_range(extracted->globals())) {
+      if ((globalVar.isDeclaration() || globalVar.hasLocalLinkage()) && globalVar.use_empty()) globalVar.eraseFromParent();
+   }
+   llvm::SmallVector<char, 0> buffer;
+   llvm::raw_svector_ostream stream(buffer);
+   llvm::WriteBitcodeToFile(*extracted, stream);
+   auto context = std::make_unique<llvm::LLVMContext>();
+   auto res = llvm::parseBitcodeFile(llvm::MemoryBufferRef(llvm::StringRef(buffer.data(), buffer.size()), module.getModuleIdentifier()), *context);
+   if (!res) {
+      return res.takeError();
+   }
+   return llvm::orc::ThreadSafeModule(std::move(res.get()), std::move(context));
+}
+struct QueryModulePartitions {
+   //mutable global variables, main and rt_set_execution_context
+   llvm::orc::ThreadSafeModule mainModule;
+   std::vector<std::pair<std::string, llvm::orc::ThreadSafeModule>> functionModules;
+};
+static llvm::Expected<QueryModulePartitions> partitionQueryModule(llvm::Module& module) {
+   //definitions referenced across modules must be visible to the linker, other functions and local constants are copied into every module using them
+   for (auto& global : module.global_values()) {
+      if (global.isDeclaration()) continue;
+      auto* function = llvm::dyn_cast<llvm::Function>(&global);
+      auto* globalVar = llvm::dyn_cast<llvm::GlobalVariable>(&global);
+      if (globalVar && globalVar->isConstant() && globalVar->hasLocalLinkage()) continue;
+      if (function && !isRequiredInMainModule(*function) && !addressEscapes(*function)) {
+         function->setLinkage(llvm::GlobalValue::InternalLinkage);
+         continue;
+      }
+      if (!global.hasName()) global.setName("global");
+      global.setLinkage(llvm::GlobalValue::ExternalLinkage);
+      global.setVisibility(llvm::GlobalValue::DefaultVisibility);
+      global.setDSOLocal(false);
+      global.setComdat(nullptr);
+   }
+   QueryModulePartitions res;
+   std::unordered_set<const llvm::Function*> mainFunctions;
+   for (auto& function : module) {
+      if (function.isDeclaration() || function.hasLocalLinkage()) continue;
+      if (isRequiredInMainModule(function)) {
+         collectDirectCallees(&function, mainFunctions);
+         continue;
+      }
+      std::unordered_set<const llvm::Function*> functions;
+      collectDirectCallees(&function, functions);
+      auto extracted = extractModule(module, functions, false);
+      if (!extracted) {
+         return extracted.takeError();
+      }
+      res.functionModules.push_back({function.getName().str(), std::move(extracted.get())});
+   }
+   auto mainModule = extractModule(module, mainFunctions, true);
+   if (!mainModule) {
+      return mainModule.takeError();
+   }
+   res.mainModule = std::move(mainModule.get());
+   return res;
+}
+static void reportLazyCompilationFailure() {
+   llvm::errs() << "could not compile query function\n";
+   std::abort();
+}
+class ParallelJIT {
+   std::unique_ptr<llvm::orc::LazyCallThroughManager> lazyCallThroughManager;
+   std::unique_ptr<llvm::orc::IndirectStubsManager> stubsManager;
+   //destroyed (waiting for running compilations) before the stubs
+   std::unique_ptr<llvm::orc::LLJIT> jit;
+   llvm::orc::JITDylib* functionsJD = nullptr;
+   llvm::orc::SymbolLookupSet functions;
+
+   public:
+   static llvm::Expected<std::unique_ptr<ParallelJIT>> create(llvm::Module& module, size_t compileThreads) {
+      auto res = std::make_unique<ParallelJIT>();
+      auto targetMachineBuilder = llvm::orc::JITTargetMachineBuilder::detectHost();
+      if (!targetMachineBuilder) {
+         return targetMachineBuilder.takeError();
+      }
+      auto executorProcessControl = llvm::orc::SelfExecutorProcessControl::Create(nullptr, std::make_unique<CompileThreadsTaskDispatcher>(compileThreads));
+      if (!executorProcessControl) {
+         return executorProcessControl.takeError();
+      }
+      auto jit = llvm::orc::LLJITBuilder()
+                    .setJITTargetMachineBuilder(std::move(targetMachineBuilder.get()))
+                    .setExecutorProcessControl(std::move(executorProcessControl.get()))
+                    .setCompileFunctionCreator([](llvm::orc::JITTargetMachineBuilder jtmb) -> llvm::Expected<std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler>> {
+                       return std::make_unique<llvm::orc::ConcurrentIRCompiler>(std::move(jtmb));
+                    })
+                    .create();
+      if (!jit) {
+         return jit.takeError();
+      }
+      res->jit = std::move(jit.get());
+      module.setDataLayout(res->jit->getDataLayout());
+      module.setTargetTriple(res->jit->getTargetTriple().str());
+      auto partitions = partitionQueryModule(module);
+      if (!partitions) {
+         return partitions.takeError();
+      }
+      //runs on the compile threads, each module with its own context
+      res->jit->getIRTransformLayer().setTransform([](llvm::orc::ThreadSafeModule threadSafeModule, llvm::orc::MaterializationResponsibility&) -> llvm::Expected<llvm::orc::ThreadSafeModule> {
+         if (auto err = threadSafeModule.withModuleDo([](llvm::Module& m) { return performDefaultLLVMPasses(&m); })) {
+            return std::move(err);
+         }
+         return std::move(threadSafeModule);
+      });
+      if (auto err = addRuntimeSymbols(*res->jit)) {
+         return std::move(err);
+      }
+      auto& mainJD = res->jit->getMainJITDylib();
+      auto functionsJD = res->jit->createJITDylib("functions");
+      if (!functionsJD) {
+         return functionsJD.takeError();
+      }
+      res->functionsJD = &functionsJD.get();
+      res->functionsJD->addToLinkOrder(mainJD);
+      const auto& triple = res->jit->getTargetTriple();
+      auto lazyCallThroughManager = llvm::orc::createLocalLazyCallThroughManager(triple, res->jit->getExecutionSession(), llvm::orc::ExecutorAddr::fromPtr(&reportLazyCompilationFailure));
+      if (!lazyCallThroughManager) {
+         return lazyCallThroughManager.takeError();
+      }
+      res->lazyCallThroughManager = std::move(lazyCallThroughManager.get());
+      res->stubsManager = llvm::orc::createLocalIndirectStubsManagerBuilder(triple)();
+      llvm::orc::SymbolAliasMap stubs;
+      for (auto& [name, functionModule] : partitions->functionModules) {
+         auto symbol = res->jit->mangleAndIntern(name);
+         stubs[symbol] = llvm::orc::SymbolAliasMapEntry(symbol, llvm::JITSymbolFlags::Exported | llvm::JITSymbolFlags::Callable);
+         res->functions.add(symbol);
+         if (auto err = res->jit->addIRModule(*res->functionsJD, std::move(functionModule))) {
+            return std::move(err);
+         }
+      }
+      if (!stubs.empty()) {
+         if (auto err = mainJD.define(llvm::orc::lazyReexports(*res->lazyCallThroughManager, *res->stubsManager, *res->functionsJD, std::move(stubs)))) {
+            return std::move(err);
+         }
+      }
+      if (auto err = res->jit->addIRModule(std::move(partitions->mainModule))) {
+         return std::move(err);
+      }
+      return res;
+   }
+   llvm::Expected<llvm::orc::ExecutorAddr> lookup(llvm::StringRef name) {
+      return jit->lookup(name);
+   }
+   //compile all functions in the background: later pipelines are compiled while earlier ones are already executed
+   void compileRemaining() {
+      if (functions.empty()) return;
+      auto& executionSession = jit->getExecutionSession();
+      executionSession.lookup(
+         llvm::orc::LookupKind::Static, llvm::orc::makeJITDylibSearchOrder(functionsJD, llvm::orc::JITDylibLookupFlags::MatchAllSymbols), std::move(functions), llvm::orc::SymbolState::Ready, [&executionSession](llvm::Expected<llvm::orc::SymbolMap> result) {
+            if (!result) {
+               executionSession.reportError(result.takeError());
+            }
+         },
+         llvm::orc::NoDependenciesToRegister);
+   }
+};
+
+std::unique_ptr<mlir::ExecutionEngine> execution::createOptimizedLLVMEngine(mlir::ModuleOp& moduleOp, bool verify, const std::atomic<bool>& cancelled, const std::unordered_map<std::string, void*>& sharedGlobals) {
+   mlir::registerBuiltinDialectTranslation(*moduleOp->getContext());
+   mlir::registerLLVMDialectTranslation(*moduleOp->getContext());
+   llvm::InitializeNativeTarget();
+   llvm::InitializeNativeTargetAsmPrinter();
+   //every step checks if the result is still needed before it starts
+   if (cancelled || !lowerToLLVMDialect(moduleOp, verify) || cancelled) {
+      return {};
+   }
+   addLLVMExecutionContextFuncs(moduleOp);
+   for (auto& [name, ptr] : sharedGlobals) {
+      if (auto globalOp = moduleOp.lookupSymbol<mlir::LLVM::GlobalOp>(name)) {
+         globalOp.setLinkage(mlir::LLVM::Linkage::External);
+         globalOp.removeValueAttr();
+      }
+   }
+   auto convertFn = [&](mlir::Operation* module, llvm::LLVMContext& context) -> std::unique_ptr<llvm::Module> {
+      if (cancelled) return {};
+      return translateModuleToLLVMIR(module, context, "LLVMDialectModule", false);
+   };
+   //optimization (and code generation) is performed on the first lookup: stop early if the result is not needed anymore
+   auto optimizeFn = [&cancelled](llvm::Module* module) -> llvm::Error {
+      return performDefaultLLVMPasses(module, &cancelled);
+   };
+   auto maybeEngine = mlir::ExecutionEngine::create(moduleOp, {.llvmModuleBuilder = convertFn, .transformer = optimizeFn, .jitCodeGenOptLevel = llvm::CodeGenOptLevel::Aggressive});
+   if (!maybeEngine || cancelled) {
+      if (!maybeEngine) llvm::consumeError(maybeEngine.takeError());
+      return {};
+   }
+   auto engine = std::move(maybeEngine.get());
+   engine->registerSymbols([&sharedGlobals](llvm::orc::MangleAndInterner interner) {
+      auto symbolMap = getRuntimeSymbolMap(interner);
+      for (auto& [name, ptr] : sharedGlobals) {
+         symbolMap[interner(name)] = llvm::orc::ExecutorSymbolDef(llvm::orc::ExecutorAddr::fromPtr(ptr), llvm::JITSymbolFlags::Exported);
+      }
+      return symbolMap;
+   });
+   return engine;
+}
+
+//owns the jit the machine code lives in
+class LLVMCompiledQuery : public execution::CompiledQuery {
+   public:
+   std::unique_ptr<llvm::orc::LLJIT> cachedJIT;
+   std::unique_ptr<ParallelJIT> parallelJIT;
+   std::unique_ptr<mlir::ExecutionEngine> engine;
+};
 class DefaultCPULLVMBackend : public execution::ExecutionBackend {
    void execute(mlir::ModuleOp& moduleOp, runtime::ExecutionContext* executionContext) override {
       mlir::registerBuiltinDialectTranslation(*moduleOp->getContext());
@@ -168,74 +717,140 @@ class DefaultCPULLVMBackend : public execution::ExecutionBackend {
       addLLVMExecutionContextFuncs(moduleOp);
       auto endLowerToLLVM = std::chrono::high_resolution_clock::now();
       timing["lowerToLLVM"] = std::chrono::duration_cast<std::chrono::microseconds>(endLowerToLLVM - startLowerToLLVM).count() / 1000.0;
-      double translateToLLVMIRTime;
-      auto convertFn = [&](mlir::Operation* module, llvm::LLVMContext& context) -> std::unique_ptr<llvm::Module> {
-         auto startTranslationToLLVMIR = std::chrono::high_resolution_clock::now();
-         auto res = translateModuleToLLVMIR(module, context, "LLVMDialectModule", false);
-         auto endTranslationToLLVMIR = std::chrono::high_resolution_clock::now();
-         translateToLLVMIRTime = std::chrono::duration_cast<std::chrono::microseconds>(endTranslationToLLVMIR - startTranslationToLLVMIR).count() / 1000.0;
-         return std::move(res);
-      };
-      double llvmPassesTime;
-
-      auto optimizeFn = [&](llvm::Module* module) -> llvm::Error {
-         auto startLLVMIRPasses = std::chrono::high_resolution_clock::now();
-         auto error = performDefaultLLVMPasses(module);
-         auto endLLVMIRPasses = std::chrono::high_resolution_clock::now();
-         llvmPassesTime = std::chrono::duration_cast<std::chrono::microseconds>(endLLVMIRPasses - startLLVMIRPasses).count() / 1000.0;
-         return error;
-      };
-      auto startJIT = std::chrono::high_resolution_clock::now();
 
-      auto maybeEngine = mlir::ExecutionEngine::create(moduleOp, {.llvmModuleBuilder = convertFn, .transformer = optimizeFn, .jitCodeGenOptLevel = llvm::CodeGenOptLevel::Default, .enableObjectDump = false});
-      if (!maybeEngine) {
-         error.emit() << "Could not create execution engine";
-         return;
+      // object cache (LINGODB_OBJECT_CACHE=<dir>): reuse the machine code of previously compiled, identical query modules
+      std::string cachedObjectFile;
+      if (const char* cacheDir = std::getenv("LINGODB_OBJECT_CACHE")) {
+         std::filesystem::create_directories(cacheDir);
+         cachedObjectFile = std::string(cacheDir) + "/" + getObjectCacheKey(moduleOp) + ".o";
       }
-      auto engine = std::move(maybeEngine.get());
-      auto runtimeSymbolMap = [&](llvm::orc::MangleAndInterner interner) {
-         auto symbolMap = llvm::orc::SymbolMap();
-         mlir::util::FunctionHelper::visitAllFunctions([&](std::string s, void* ptr) {
-            symbolMap[interner(s)] = llvm::orc::ExecutorSymbolDef(llvm::orc::ExecutorAddr::fromPtr(ptr), llvm::JITSymbolFlags::Exported);
-         });
-         execution::visitBareFunctions([&](std::string s, void* ptr) {
-            symbolMap[interner(s)] = llvm::orc::ExecutorSymbolDef(llvm::orc::ExecutorAddr::fromPtr(ptr), llvm::JITSymbolFlags::Exported);
-         });
-         return symbolMap;
-      };
-      engine->registerSymbols(runtimeSymbolMap);
-      auto mainFnLookupResult = engine->lookup("main");
-      if (!mainFnLookupResult) {
-         error.emit() << "Could not lookup main function";
-         return;
+      compiledQuery.reset();
+      auto query = std::make_shared<LLVMCompiledQuery>();
+      auto& mainFunc = query->mainFunc;
+      auto& setExecutionContextFunc = query->setExecutionContextFunc;
+      auto& cachedJIT = query->cachedJIT;
+      auto& parallelJIT = query->parallelJIT;
+      auto& engine = query->engine;
+      if (!cachedObjectFile.empty()) {
+         executionContext->count(std::filesystem::exists(cachedObjectFile) ? "object cache hits" : "object cache misses");
       }
-      auto setExecutionContextLookup = engine->lookup("rt_set_execution_context");
-      if (!setExecutionContextLookup) {
-         error.emit() << "Could not lookup function for setting the execution context";
-         return;
-      }
-      auto mainFunc = reinterpret_cast<execution::mainFnType>(mainFnLookupResult.get());
-      auto setExecutionContextFunc = reinterpret_cast<execution::setExecutionContextFnType>(setExecutionContextLookup.get());
-      auto endJIT = std::chrono::high_resolution_clock::now();
-      setExecutionContextFunc(executionContext);
-      auto totalJITTime = std::chrono::duration_cast<std::chrono::microseconds>(endJIT - startJIT).count() / 1000.0;
-      totalJITTime -= translateToLLVMIRTime;
-      totalJITTime -= llvmPassesTime;
+      if (!cachedObjectFile.empty() && std::filesystem::exists(cachedObjectFile)) {
+         auto startLoad = std::chrono::high_resolution_clock::now();
+         auto maybeJIT = loadCachedObject(cachedObjectFile);
+         if (!maybeJIT) {
+            error.emit() << "Could not load cached object file: " << llvm::toString(maybeJIT.takeError());
+            return;
+         }
+         cachedJIT = std::move(maybeJIT.get());
+         auto mainFnLookupResult = cachedJIT->lookup("main");
+         if (!mainFnLookupResult) {
+            llvm::consumeError(mainFnLookupResult.takeError());
+            error.emit() << "Could not lookup main function";
+            return;
+         }
+         auto setExecutionContextLookup = cachedJIT->lookup("rt_set_execution_context");
+         if (!setExecutionContextLookup) {
+            llvm::consumeError(setExecutionContextLookup.takeError());
+            error.emit() << "Could not lookup function for setting the execution context";
+            return;
+         }
+         mainFunc = mainFnLookupResult->toPtr<execution::mainFnType>();
+         setExecutionContextFunc = setExecutionContextLookup->toPtr<execution::setExecutionContextFnType>();
+         auto endLoad = std::chrono::high_resolution_clock::now();
+         timing["objectCacheLoad"] = std::chrono::duration_cast<std::chrono::microseconds>(endLoad - startLoad).count() / 1000.0;
+      } else if (size_t parallelJITFunctions = countParallelJITFunctions(moduleOp); cachedObjectFile.empty() && getParallelJITThreads() > 0 && parallelJITFunctions >= minParallelJITFunctions) {
+         auto startTranslationToLLVMIR = std::chrono::high_resolution_clock::now();
+         llvm::LLVMContext llvmContext;
+         auto llvmModule = mlir::translateModuleToLLVMIR(moduleOp, llvmContext, "LLVMDialectModule", false);
+         if (!llvmModule) {
+            error.emit() << "Could not translate module to llvm ir";
+            return;
+         }
+         auto endTranslationToLLVMIR = std::chrono::high_resolution_clock::now();
+         //the main module and the function modules are compiled concurrently
+         auto maybeJIT = ParallelJIT::create(*llvmModule, std::min(getParallelJITThreads(), parallelJITFunctions + 1));
+         if (!maybeJIT) {
+            error.emit() << "Could not create jit: " << llvm::toString(maybeJIT.takeError());
+            return;
+         }
+         parallelJIT = std::move(maybeJIT.get());
+         //only the main module is compiled before the execution starts
+         auto mainFnLookupResult = parallelJIT->lookup("main");
+         if (!mainFnLookupResult) {
+            llvm::consumeError(mainFnLookupResult.takeError());
+            error.emit() << "Could not lookup main function";
+            return;
+         }
+         auto setExecutionContextLookup = parallelJIT->lookup("rt_set_execution_context");
+         if (!setExecutionContextLookup) {
+            llvm::consumeError(setExecutionContextLookup.takeError());
+            error.emit() << "Could not lookup function for setting the execution context";
+            return;
+         }
+         mainFunc = mainFnLookupResult->toPtr<execution::mainFnType>();
+         setExecutionContextFunc = setExecutionContextLookup->toPtr<execution::setExecutionContextFnType>();
+         parallelJIT->compileRemaining();
+         auto endJIT = std::chrono::high_resolution_clock::now();
+         timing["toLLVMIR"] = std::chrono::duration_cast<std::chrono::microseconds>(endTranslationToLLVMIR - startTranslationToLLVMIR).count() / 1000.0;
+         timing["llvmCodeGen"] = std::chrono::duration_cast<std::chrono::microseconds>(endJIT - endTranslationToLLVMIR).count() / 1000.0;
+      } else {
+         double translateToLLVMIRTime;
+         auto convertFn = [&](mlir::Operation* module, llvm::LLVMContext& context) -> std::unique_ptr<llvm::Module> {
+            auto startTranslationToLLVMIR = std::chrono::high_resolution_clock::now();
+            auto res = translateModuleToLLVMIR(module, context, "LLVMDialectModule", false);
+            auto endTranslationToLLVMIR = std::chrono::high_resolution_clock::now();
+            translateToLLVMIRTime = std::chrono::duration_cast<std::chrono::microseconds>(endTranslationToLLVMIR - startTranslationToLLVMIR).count() / 1000.0;
+            return std::move(res);
+         };
+         double llvmPassesTime;
 
-      std::vector<double> measuredTimes;
-      for (size_t i = 0; i < numRepetitions; i++) {
-         auto executionStart = std::chrono::high_resolution_clock::now();
-         utility::Tracer::Trace trace(execution);
-         mainFunc();
-         trace.stop();
-         auto executionEnd = std::chrono::high_resolution_clock::now();
-         executionContext->reset();
-         measuredTimes.push_back(std::chrono::duration_cast<std::chrono::microseconds>(executionEnd - executionStart).count() / 1000.0);
+         auto optimizeFn = [&](llvm::Module* module) -> llvm::Error {
+            auto startLLVMIRPasses = std::chrono::high_resolution_clock::now();
+            auto error = performDefaultLLVMPasses(module);
+            auto endLLVMIRPasses = std::chrono::high_resolution_clock::now();
+            llvmPassesTime = std::chrono::duration_cast<std::chrono::microseconds>(endLLVMIRPasses - startLLVMIRPasses).count() / 1000.0;
+            return error;
+         };
+         auto startJIT = std::chrono::high_resolution_clock::now();
+
+         auto maybeEngine = mlir::ExecutionEngine::create(moduleOp, {.llvmModuleBuilder = convertFn, .transformer = optimizeFn, .jitCodeGenOptLevel = llvm::CodeGenOptLevel::Default, .enableObjectDump = !cachedObjectFile.empty()});
+         if (!maybeEngine) {
+            error.emit() << "Could not create execution engine";
+            return;
+         }
+         engine = std::move(maybeEngine.get());
+         engine->registerSymbols(getRuntimeSymbolMap);
+         auto mainFnLookupResult = engine->lookup("main");
+         if (!mainFnLookupResult) {
+            error.emit() << "Could not lookup main function";
+            return;
+         }
+         auto setExecutionContextLookup = engine->lookup("rt_set_execution_context");
+         if (!setExecutionContextLookup) {
+            error.emit() << "Could not lookup function for setting the execution context";
+            return;
+         }
+         mainFunc = reinterpret_cast<execution::mainFnType>(mainFnLookupResult.get());
+         setExecutionContextFunc = reinterpret_cast<execution::setExecutionContextFnType>(setExecutionContextLookup.get());
+         auto endJIT = std::chrono::high_resolution_clock::now();
+         auto totalJITTime = std::chrono::duration_cast<std::chrono::microseconds>(endJIT - startJIT).count() / 1000.0;
+         totalJITTime -= translateToLLVMIRTime;
+         totalJITTime -= llvmPassesTime;
+         if (!cachedObjectFile.empty()) {
+            //write to a temporary file first: other processes may read the cache concurrently, and other threads may compile the same query
+            static std::atomic<size_t> tmpFileCounter = 0;
+            auto threadId = std::hash<std::thread::id>{}(std::this_thread::get_id());
+            auto tmpFile = cachedObjectFile + "." + std::to_string(getpid()) + "." + std::to_string(threadId) + "." + std::to_string(tmpFileCounter++) + ".tmp";
+            engine->dumpToObjectFile(tmpFile);
+            std::error_code ec;
+            std::filesystem::rename(tmpFile, cachedObjectFile, ec);
+         }
+         timing["toLLVMIR"] = translateToLLVMIRTime;
+         timing["llvmOptimize"] = llvmPassesTime;
+         timing["llvmCodeGen"] = totalJITTime;
       }
-      timing["toLLVMIR"] = translateToLLVMIRTime;
-      timing["llvmOptimize"] = llvmPassesTime;
-      timing["llvmCodeGen"] = totalJITTime;
-      timing["executionTime"] = (measuredTimes.size() > 1 ? *std::min_element(measuredTimes.begin() + 1, measuredTimes.end()) : measuredTimes[0]);
+      compiledQuery = query;
+      executeCompiled(*query, executionContext);
    }
    bool requiresSnapshotting() override {
       return false;
@@ -479,6 +1094,21 @@ class CPULLVMProfilingBackend : public execution::ExecutionBackend {
 
 } // namespace
 
+void execution::ExecutionBackend::executeCompiled(execution::CompiledQuery& query, runtime::ExecutionContext* executionContext) {
+   query.setExecutionContextFunc(executionContext);
+
+   std::vector<double> measuredTimes;
+   for (size_t i = 0; i < numRepetitions; i++) {
+      auto executionStart = std::chrono::high_resolution_clock::now();
+      utility::Tracer::Trace trace(executionEvent);
+      query.mainFunc();
+      trace.stop();
+      auto executionEnd = std::chrono::high_resolution_clock::now();
+      executionContext->reset();
+      measuredTimes.push_back(std::chrono::duration_cast<std::chrono::microseconds>(executionEnd - executionStart).count() / 1000.0);
+   }
+   timing["executionTime"] = (measuredTimes.size() > 1 ? *std::min_element(measuredTimes.begin() + 1, measuredTimes.end()) : measuredTimes[0]);
+}
 std::unique_ptr<execution::ExecutionBackend> execution::createDefaultLLVMBackend() {
    return std::make_unique<DefaultCPULLVMBackend>();
 }
@@ -278,6 +278,10 @@ void* mlir::cranelift::CraneliftExecutionEngine::getFunction(std::string name) {
    auto funcId = functionIds.at(name);
    return const_cast<void*>(reinterpret_cast<const void*>(cranelift_get_compiled_fun(mod, funcId)));
 }
+void* mlir::cranelift::CraneliftExecutionEngine::getData(std::string name) {
+   auto dataId = dataIds.at(name);
+   return const_cast<void*>(reinterpret_cast<const void*>(cranelift_get_compiled_data(mod, dataId)));
+}
 size_t mlir::cranelift::CraneliftExecutionEngine::getJitTime() const {
    return jitTime;
 }
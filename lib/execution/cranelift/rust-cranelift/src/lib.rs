@@ -287,6 +287,16 @@ pub extern "C" fn cranelift_get_compiled_fun(ptr: *mut ModuleData, func: u32) ->
     code
 }
 
+#[no_mangle]
+pub extern "C" fn cranelift_get_compiled_data(ptr: *mut ModuleData, data: u32) -> *const u8 {
+    let inst = unsafe {
+        assert!(!ptr.is_null());
+        &mut *ptr
+    };
+    let (data, _size) = inst.module.as_mut().unwrap().get_finalized_data(DataId::from_u32(data));
+    data
+}
+
 #[no_mangle]
 pub extern "C" fn cranelift_module_delete(ptr: *mut ModuleData){
     if !ptr.is_null() {
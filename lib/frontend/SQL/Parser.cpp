@@ -1033,10 +1033,7 @@ mlir::Value frontend::sql::Parser::translateExpression(mlir::OpBuilder& builder,
          }
          break;
       }
-      case T_ParamRef: {
-         //expr = ParamRefTransform(parse_result, reinterpret_cast<ParamRef*>(node),context);
-         break;
-      }
+      case T_ParamRef: return translateParamRef(builder, reinterpret_cast<ParamRef*>(node));
       case T_SubLink: {
          auto* subLink = reinterpret_cast<SubLink*>(node);
          //expr = FuncCallTransform(parse_result,,context);
@@ -1219,6 +1216,7 @@ void frontend::sql::Parser::translateCopyStatement(mlir::OpBuilder& builder, Cop
    std::string tableName = copyStatement->relation_->relname_;
    std::string delimiter = ",";
    std::string escape = "";
+   std::string format = "csv";
    for (auto* optionCell = copyStatement->options_->head; optionCell != nullptr; optionCell = optionCell->next) {
       auto* defElem = reinterpret_cast<DefElem*>(optionCell->data.ptr_value);
       std::string optionName = defElem->defname_;
@@ -1227,9 +1225,9 @@ void frontend::sql::Parser::translateCopyStatement(mlir::OpBuilder& builder, Cop
       } else if (optionName == "escape") {
          escape = reinterpret_cast<value*>(defElem->arg_)->val_.str_;
       } else if (optionName == "format") {
-         std::string format = reinterpret_cast<value*>(defElem->arg_)->val_.str_;
-         if (format != "csv") {
-           throw std::runtime_error("copy only supports csv");
+         format = reinterpret_cast<value*>(defElem->arg_)->val_.str_;
+         if (format != "csv" && format != "parquet") {
+           throw std::runtime_error("copy only supports csv and parquet");
          }
       } else if (optionName == "null") {
       } else {
@@ -1240,7 +1238,8 @@ void frontend::sql::Parser::translateCopyStatement(mlir::OpBuilder& builder, Cop
    auto fileNameValue = createStringValue(builder, fileName);
    auto delimiterValue = createStringValue(builder, delimiter);
    auto escapeValue = createStringValue(builder, escape);
-   rt::RelationHelper::copyFromIntoTable(builder, builder.getUnknownLoc())(mlir::ValueRange{getExecutionContextValue(builder), tableNameValue, fileNameValue, delimiterValue, escapeValue});
+   auto formatValue = createStringValue(builder, format);
+   rt::RelationHelper::copyFromIntoTable(builder, builder.getUnknownLoc())(mlir::ValueRange{getExecutionContextValue(builder), tableNameValue, fileNameValue, delimiterValue, escapeValue, formatValue});
 }
 void frontend::sql::Parser::translateVariableSetStatement(mlir::OpBuilder& builder, VariableSetStmt* variableSetStatement) {
    std::string varName = variableSetStatement->name_;
@@ -1256,59 +1255,179 @@ void frontend::sql::Parser::translateVariableSetStatement(mlir::OpBuilder& build
       rt::RelationHelper::setPersist(builder, builder.getUnknownLoc())({getExecutionContextValue(builder), persistValue});
    }
 }
+std::string getParameterValue(Node* node) {
+   if (node->type == T_TypeCast) {
+      node = reinterpret_cast<TypeCast*>(node)->arg_;
+   }
+   if (node->type != T_A_Const) {
+      throw std::runtime_error("parameter values must be constants");
+   }
+   auto constVal = reinterpret_cast<A_Const*>(node)->val_;
+   switch (constVal.type_) {
+      case T_Integer: return std::to_string(constVal.val_.ival_);
+      case T_String:
+      case T_Float: return constVal.val_.str_;
+      default: throw std::runtime_error("unsupported parameter value");
+   }
+}
+mlir::Value frontend::sql::Parser::translateParamRef(mlir::OpBuilder& builder, ParamRef* paramRef) {
+   if (paramRef->number_ < 1 || static_cast<size_t>(paramRef->number_) > parameters.size()) {
+      throw std::runtime_error("no value for parameter $" + std::to_string(paramRef->number_));
+   }
+   uint32_t idx = paramRef->number_ - 1;
+   maxParameter = std::max<size_t>(maxParameter, paramRef->number_);
+   if (parameterValues.contains(idx)) {
+      return parameterValues[idx];
+   }
+   //the value is not part of the generated code: the same code can be reused for different parameter values
+   //it is loaded once at the start of the query, expressions (e.g., predicates evaluated per tuple) only use the loaded value
+   mlir::OpBuilder::InsertionGuard guard(builder);
+   if (queryBlock) {
+      builder.setInsertionPointToStart(queryBlock);
+   }
+   auto loc = builder.getUnknownLoc();
+   mlir::Value idxValue = builder.create<mlir::db::ConstantOp>(loc, builder.getI32Type(), builder.getI32IntegerAttr(idx));
+   auto getParameterOp = builder.create<mlir::db::RuntimeCall>(loc, mlir::db::StringType::get(builder.getContext()), "GetParameter", mlir::ValueRange({getExecutionContextValue(builder), idxValue}));
+   //the query is optimized (e.g., selectivity estimation) for the values of the first execution
+   getParameterOp->setAttr("parameter", builder.getI32IntegerAttr(idx));
+   getParameterOp->setAttr("parameter_value", builder.getStringAttr(parameters[idx]));
+   mlir::Value parameter = getParameterOp.getRes();
+   if (idx < parameterTypes.size()) {
+      parameter = SQLTypeInference::castValueToType(builder, parameter, parameterTypes[idx]);
+   }
+   if (queryBlock) {
+      parameterValues[idx] = parameter;
+   }
+   return parameter;
+}
+std::optional<mlir::Value> frontend::sql::Parser::translateExecuteStatement(mlir::OpBuilder& builder, ExecuteStmt* executeStatement) {
+   if (!session) {
+      throw std::runtime_error("prepared statements require a session");
+   }
+   auto preparedStatement = session->getPreparedStatement(executeStatement->name_);
+   if (!preparedStatement) {
+      throw std::runtime_error("prepared statement does not exist: " + std::string(executeStatement->name_));
+   }
+   if (executeStatement->params_) {
+      for (auto* cell = executeStatement->params_->head; cell != nullptr; cell = cell->next) {
+         parameters.push_back(getParameterValue(reinterpret_cast<Node*>(cell->data.ptr_value)));
+      }
+   }
+   executedStatement = executeStatement->name_;
+   auto wrongNumberOfParameters = [&]() {
+      return std::runtime_error("wrong number of parameters for prepared statement: " + std::string(executeStatement->name_));
+   };
+   if (preparedStatement->numParameters && preparedStatement->numParameters.value() != parameters.size()) {
+      throw wrongNumberOfParameters();
+   }
+   //the compiled code of a previous execution is reused (see execution::QueryExecuter): nothing to translate
+   if (preparedStatement->compiled) {
+      return {};
+   }
+   preparedResult = pg_query_parse(preparedStatement->sql.c_str());
+   if (preparedResult.error || !preparedResult.tree || preparedResult.tree->length != 1) {
+      throw std::runtime_error("invalid prepared statement: " + std::string(executeStatement->name_));
+   }
+   auto* prepareStatement = reinterpret_cast<PrepareStmt*>(preparedResult.tree->head->data.ptr_value);
+   if (prepareStatement->argtypes_) {
+      for (auto* cell = prepareStatement->argtypes_->head; cell != nullptr; cell = cell->next) {
+         auto* typeNameNode = reinterpret_cast<TypeName*>(cell->data.ptr_value);
+         auto* typeName = reinterpret_cast<value*>(typeNameNode->names_->tail->data.ptr_value)->val_.str_;
+         auto columnType = createColumnType(typeName, false, getTypeModList(typeNameNode->typmods_));
+         parameterTypes.push_back(createTypeFromColumnType(builder.getContext(), columnType));
+      }
+   }
+   if (parameters.size() != parameterTypes.size() && !parameterTypes.empty()) {
+      throw wrongNumberOfParameters();
+   }
+   auto res = translateStatement(builder, prepareStatement->query_);
+   //without declared types, the statement expects exactly the referenced parameters
+   if (parameterTypes.empty() && parameters.size() != maxParameter) {
+      throw wrongNumberOfParameters();
+   }
+   preparedStatement->numParameters = parameters.size();
+   return res;
+}
 std::optional<mlir::Value> frontend::sql::Parser::translate(mlir::OpBuilder& builder) {
    if (result.tree && result.tree->length == 1) {
-      auto* statement = static_cast<Node*>(result.tree->head->data.ptr_value);
-      switch (statement->type) {
-         case T_VariableSetStmt: {
-            auto* variableSetStatement = reinterpret_cast<VariableSetStmt*>(statement);
-            translateVariableSetStatement(builder, variableSetStatement);
-            break;
-         }
-         case T_CreateStmt: {
-            translateCreateStatement(builder, reinterpret_cast<CreateStmt*>(statement));
-            break;
-         }
-         case T_CopyStmt: {
-            auto* copyStatement = reinterpret_cast<CopyStmt*>(statement);
-            translateCopyStatement(builder, copyStatement);
-            break;
+      return translateStatement(builder, static_cast<Node*>(result.tree->head->data.ptr_value));
+   }
+   return {};
+}
+std::optional<mlir::Value> frontend::sql::Parser::translateStatement(mlir::OpBuilder& builder, Node* statement) {
+   switch (statement->type) {
+      case T_VariableSetStmt: {
+         auto* variableSetStatement = reinterpret_cast<VariableSetStmt*>(statement);
+         translateVariableSetStatement(builder, variableSetStatement);
+         break;
+      }
+      case T_CreateStmt: {
+         translateCreateStatement(builder, reinterpret_cast<CreateStmt*>(statement));
+         break;
+      }
+      case T_CopyStmt: {
+         auto* copyStatement = reinterpret_cast<CopyStmt*>(statement);
+         translateCopyStatement(builder, copyStatement);
+         break;
+      }
+      case T_SelectStmt: {
+         parallelismAllowed = true;
+         TranslationContext context;
+         auto scope = context.createResolverScope();
+         auto [tree, targetInfo] = translateSelectStmt(builder, reinterpret_cast<SelectStmt*>(statement), context, scope);
+         //::mlir::Type result, ::mlir::Value rel, ::mlir::ArrayAttr attrs, ::mlir::ArrayAttr columns
+         std::vector<mlir::Attribute> attrs;
+         std::vector<mlir::Attribute> names;
+         std::vector<mlir::Attribute> colMemberNames;
+         std::vector<mlir::Attribute> colTypes;
+         auto& memberManager = builder.getContext()->getLoadedDialect<mlir::subop::SubOperatorDialect>()->getMemberManager();
+         for (auto x : targetInfo.namedResults) {
+            if (x.first == "primaryKeyHashValue") continue;
+            names.push_back(builder.getStringAttr(x.first));
+            auto colMemberName = memberManager.getUniqueMember(x.first.empty() ? "unnamed" : x.first);
+            auto columnType = x.second->type;
+            attrs.push_back(attrManager.createRef(x.second));
+            colTypes.push_back(mlir::TypeAttr::get(columnType));
+            colMemberNames.push_back(builder.getStringAttr(colMemberName));
+         }
+         auto resultTableType = mlir::subop::ResultTableType::get(builder.getContext(), mlir::subop::StateMembersAttr::get(builder.getContext(), builder.getArrayAttr(colMemberNames), builder.getArrayAttr(colTypes)));
+         return builder.create<mlir::relalg::MaterializeOp>(builder.getUnknownLoc(), resultTableType, tree, builder.getArrayAttr(attrs), builder.getArrayAttr(names));
+      }
+      case T_InsertStmt: {
+         translateInsertStmt(builder, reinterpret_cast<InsertStmt*>(statement));
+         break;
+      }
+      case T_PrepareStmt: {
+         if (!session) {
+            throw std::runtime_error("prepared statements require a session");
          }
-         case T_SelectStmt: {
-            parallelismAllowed = true;
-            TranslationContext context;
-            auto scope = context.createResolverScope();
-            auto [tree, targetInfo] = translateSelectStmt(builder, reinterpret_cast<SelectStmt*>(statement), context, scope);
-            //::mlir::Type result, ::mlir::Value rel, ::mlir::ArrayAttr attrs, ::mlir::ArrayAttr columns
-            std::vector<mlir::Attribute> attrs;
-            std::vector<mlir::Attribute> names;
-            std::vector<mlir::Attribute> colMemberNames;
-            std::vector<mlir::Attribute> colTypes;
-            auto& memberManager = builder.getContext()->getLoadedDialect<mlir::subop::SubOperatorDialect>()->getMemberManager();
-            for (auto x : targetInfo.namedResults) {
-               if (x.first == "primaryKeyHashValue") continue;
-               names.push_back(builder.getStringAttr(x.first));
-               auto colMemberName = memberManager.getUniqueMember(x.first.empty() ? "unnamed" : x.first);
-               auto columnType = x.second->type;
-               attrs.push_back(attrManager.createRef(x.second));
-               colTypes.push_back(mlir::TypeAttr::get(columnType));
-               colMemberNames.push_back(builder.getStringAttr(colMemberName));
-            }
-            auto resultTableType = mlir::subop::ResultTableType::get(builder.getContext(), mlir::subop::StateMembersAttr::get(builder.getContext(), builder.getArrayAttr(colMemberNames), builder.getArrayAttr(colTypes)));
-            return builder.create<mlir::relalg::MaterializeOp>(builder.getUnknownLoc(), resultTableType, tree, builder.getArrayAttr(attrs), builder.getArrayAttr(names));
+         //the statement is only translated when it is executed (with runtime parameters)
+         session->addPreparedStatement(reinterpret_cast<PrepareStmt*>(statement)->name_, sql);
+         break;
+      }
+      case T_ExecuteStmt: {
+         return translateExecuteStatement(builder, reinterpret_cast<ExecuteStmt*>(statement));
+      }
+      case T_DeallocateStmt: {
+         if (!session) {
+            throw std::runtime_error("prepared statements require a session");
          }
-         case T_InsertStmt: {
-            translateInsertStmt(builder, reinterpret_cast<InsertStmt*>(statement));
-            break;
+         auto* name = reinterpret_cast<DeallocateStmt*>(statement)->name_;
+         if (name) {
+            session->removePreparedStatement(name);
+         } else {
+            session->removeAllPreparedStatements();
          }
-         default:
-           throw std::runtime_error("unsupported statement type");
+         break;
       }
+      default:
+        throw std::runtime_error("unsupported statement type");
    }
    return {};
 }
 frontend::sql::Parser::~Parser() {
    pg_query_free_parse_result(result);
+   pg_query_free_parse_result(preparedResult);
 }
 std::shared_ptr<runtime::TableMetaData> frontend::sql::Parser::translateTableMetaData(List* metaData) {
    auto tableMetaData = std::make_shared<runtime::TableMetaData>();
@@ -1371,6 +1490,10 @@ runtime::ColumnType frontend::sql::Parser::createColumnType(std::string datatype
    if (datatypeName == "char" && std::get<size_t>(typeModifiers[0]) > 8) {
       typeModifiers.clear();
       datatypeName = "string";
+      //fixed-length strings are mostly codes/flags with few distinct values: optionally store them dictionary-encoded
+      if (const char* mode = std::getenv("LINGODB_DICTIONARY_ENCODING"); mode && std::string(mode) == "ON") {
+         typeModifiers.push_back("dictionary");
+      }
    }
    if (datatypeName == "date") {
       typeModifiers.clear();
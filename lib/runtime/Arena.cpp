@@ -0,0 +1,105 @@
+#include "runtime/Arena.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <stdexcept>
+
+#include <sys/mman.h>
+#include <unistd.h>
+namespace {
+//explicit huge pages have to be reserved by the system: stop trying after the first failure
+std::atomic<bool> hugeTLBAvailable = true;
+size_t roundUp(size_t bytes, size_t alignment) {
+   return (bytes + alignment - 1) & ~(alignment - 1);
+}
+} // end namespace
+runtime::Arena::Chunk runtime::Arena::mapChunk(size_t bytes) {
+   size_t size = roundUp(bytes, hugePageSize);
+#ifdef MAP_HUGETLB
+   if (hugeTLBAvailable.load(std::memory_order_relaxed)) {
+      void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (ptr != MAP_FAILED) {
+         return {reinterpret_cast<uint8_t*>(ptr), size};
+      }
+      hugeTLBAvailable = false;
+   }
+#endif
+   //transparent huge pages: over-allocate to align the chunk to the huge page size
+   void* mapped = mmap(nullptr, size + hugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+   if (mapped == MAP_FAILED) {
+      throw std::runtime_error("arena: could not allocate memory");
+   }
+   auto begin = reinterpret_cast<uintptr_t>(mapped);
+   auto alignedBegin = roundUp(begin, hugePageSize);
+   if (alignedBegin > begin) {
+      munmap(mapped, alignedBegin - begin);
+   }
+   size_t tail = begin + size + hugePageSize - (alignedBegin + size);
+   if (tail) {
+      munmap(reinterpret_cast<void*>(alignedBegin + size), tail);
+   }
+#ifdef MADV_HUGEPAGE
+   madvise(reinterpret_cast<void*>(alignedBegin), size, MADV_HUGEPAGE);
+#endif
+   return {reinterpret_cast<uint8_t*>(alignedBegin), size};
+}
+runtime::Arena::Chunk runtime::Arena::mapFileChunk(size_t bytes) {
+   size_t size = roundUp(bytes, hugePageSize);
+   std::FILE* file = std::tmpfile();
+   if (!file) {
+      throw std::runtime_error("arena: could not create spill file");
+   }
+   void* ptr = MAP_FAILED;
+   if (ftruncate(fileno(file), size) == 0) {
+      ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fileno(file), 0);
+   }
+   //the mapping keeps the (already unlinked) file alive
+   std::fclose(file);
+   if (ptr == MAP_FAILED) {
+      throw std::runtime_error("arena: could not map spill file");
+   }
+   return {reinterpret_cast<uint8_t*>(ptr), size};
+}
+runtime::Arena::Chunk runtime::Arena::newChunk(size_t bytes) {
+   if (!allocateAccounted) {
+      return mapChunk(bytes);
+   }
+   size_t size = roundUp(bytes, hugePageSize);
+   if (allocateAccounted(size)) {
+      return mapFileChunk(size);
+   }
+   accountedBytes += size;
+   return mapChunk(size);
+}
+uint8_t* runtime::Arena::allocate(size_t bytes) {
+   bytes = roundUp(std::max(bytes, 1ul), 64);
+   auto& local = localArenas.local();
+   if (bytes > chunkSize / 4) {
+      //large allocations (e.g., hash tables) get their own chunk, the current chunk can still be used
+      auto chunk = newChunk(bytes);
+      local.chunks.push_back(chunk);
+      return chunk.ptr;
+   }
+   if (bytes > local.remaining) {
+      auto chunk = newChunk(chunkSize);
+      local.chunks.push_back(chunk);
+      local.current = chunk.ptr;
+      local.remaining = chunk.size;
+   }
+   auto* res = local.current;
+   local.current += bytes;
+   local.remaining -= bytes;
+   return res;
+}
+void runtime::Arena::release() {
+   for (auto& local : localArenas) {
+      for (auto chunk : local.chunks) {
+         munmap(chunk.ptr, chunk.size);
+      }
+   }
+   localArenas.clear();
+   if (auto bytes = accountedBytes.exchange(0)) {
+      releaseAccounted(bytes);
+   }
+}
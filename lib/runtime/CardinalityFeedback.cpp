@@ -0,0 +1,102 @@
+#include "runtime/CardinalityFeedback.h"
+
+#include "json.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include <unistd.h>
+
+std::shared_ptr<runtime::CardinalityFeedback> runtime::CardinalityFeedback::load(std::string file) {
+   auto res = std::make_shared<CardinalityFeedback>(file);
+   if (!file.empty() && std::filesystem::exists(file)) {
+      std::ifstream t(file);
+      auto json = nlohmann::json::parse(std::string((std::istreambuf_iterator<char>(t)), std::istreambuf_iterator<char>()), nullptr, false);
+      //ignore a corrupt file, it is rewritten with the next observations
+      if (json.is_object()) {
+         for (auto& [signature, entry] : json.items()) {
+            //older files only store the number of rows
+            if (entry.is_number()) {
+               res->observed[signature] = {entry.get<double>(), 0};
+            } else if (entry.is_object() && entry.contains("rows") && entry["rows"].is_number() && entry.contains("used") && entry["used"].is_number_unsigned()) {
+               size_t lastUse = entry["used"].get<size_t>();
+               res->observed[signature] = {entry["rows"].get<double>(), lastUse};
+               res->uses = std::max(res->uses, lastUse + 1);
+            }
+         }
+         res->evict();
+      }
+   }
+   return res;
+}
+std::optional<double> runtime::CardinalityFeedback::lookup(const std::string& signature) {
+   std::lock_guard<std::mutex> lock(mutex);
+   if (auto it = observed.find(signature); it != observed.end()) {
+      it->second.lastUse = uses++;
+      return it->second.rows;
+   }
+   return {};
+}
+void runtime::CardinalityFeedback::record(const std::unordered_map<std::string, double>& observations) {
+   if (observations.empty()) return;
+   std::lock_guard<std::mutex> lock(mutex);
+   for (auto& [signature, rows] : observations) {
+      observed[signature] = {rows, uses++};
+   }
+   evict();
+   dirty = true;
+   if (persist && std::chrono::steady_clock::now() - lastStore >= storeInterval) {
+      store();
+   }
+}
+bool runtime::CardinalityFeedback::empty() {
+   std::lock_guard<std::mutex> lock(mutex);
+   return observed.empty();
+}
+void runtime::CardinalityFeedback::setPersist(bool value) {
+   std::lock_guard<std::mutex> lock(mutex);
+   persist = value && !file.empty();
+   if (persist) {
+      store();
+   }
+}
+runtime::CardinalityFeedback::~CardinalityFeedback() {
+   if (persist && dirty) {
+      store();
+   }
+}
+void runtime::CardinalityFeedback::evict() {
+   if (observed.size() <= maxEntries) return;
+   std::vector<size_t> lastUses;
+   lastUses.reserve(observed.size());
+   for (auto& [signature, entry] : observed) {
+      lastUses.push_back(entry.lastUse);
+   }
+   auto threshold = lastUses.begin() + (observed.size() - maxEntries);
+   std::nth_element(lastUses.begin(), threshold, lastUses.end());
+   std::erase_if(observed, [minLastUse = *threshold](const auto& item) { return item.second.lastUse < minLastUse; });
+}
+void runtime::CardinalityFeedback::store() {
+   nlohmann::json json = nlohmann::json::object();
+   for (auto& [signature, entry] : observed) {
+      json[signature] = {{"rows", entry.rows}, {"used", entry.lastUse}};
+   }
+   //write to a temporary file first: a crash while writing must not corrupt the stored observations
+   auto tmpFile = file + "." + std::to_string(getpid()) + ".tmp";
+   {
+      std::ofstream ostream(tmpFile);
+      ostream << json.dump();
+      ostream.flush();
+      if (!ostream) return;
+   }
+   std::error_code ec;
+   std::filesystem::rename(tmpFile, file, ec);
+   if (ec) {
+      std::filesystem::remove(tmpFile, ec);
+      return;
+   }
+   dirty = false;
+   lastStore = std::chrono::steady_clock::now();
+}
@@ -6,6 +6,7 @@
 
 namespace runtime {
 class EmptyCatalog : public Catalog {
+   std::shared_ptr<CardinalityFeedback> cardinalityFeedback = CardinalityFeedback::load("");
    std::shared_ptr<Relation> findRelation(std::string name) override {
       return {};
    }
@@ -19,6 +20,9 @@ class EmptyCatalog : public Catalog {
          throw std::runtime_error("can not persist");
       }
    }
+   std::shared_ptr<CardinalityFeedback> getCardinalityFeedback() override {
+      return cardinalityFeedback;
+   }
 };
 
 std::shared_ptr<Relation> LocalCatalog::findRelation(std::string name) {
@@ -41,12 +45,16 @@ void LocalCatalog::setPersist(bool value) {
       throw std::runtime_error("can not persist");
    }
 }
+std::shared_ptr<CardinalityFeedback> LocalCatalog::getCardinalityFeedback() {
+   return nested->getCardinalityFeedback();
+}
 std::shared_ptr<Catalog> Catalog::createEmpty() {
    return std::make_shared<EmptyCatalog>();
 }
 std::shared_ptr<DBCatalog> DBCatalog::create(std::shared_ptr<Catalog> nested, std::string dbDir,bool eagerLoading) {
    auto* catalog = new DBCatalog(nested);
    catalog->dbDirectory = dbDir;
+   catalog->cardinalityFeedback = CardinalityFeedback::load(dbDir + "/cardinalities.json");
    for (const auto& p : std::filesystem::directory_iterator(dbDir)) {
       auto path = p.path();
       if (path.extension().string() == ".json" && path.stem().string().ends_with(".metadata")) {
@@ -76,5 +84,9 @@ void DBCatalog::setPersist(bool value) {
    for (auto rel : relations) {
       rel.second->setPersist(value);
    }
+   cardinalityFeedback->setPersist(value);
+}
+std::shared_ptr<CardinalityFeedback> DBCatalog::getCardinalityFeedback() {
+   return cardinalityFeedback;
 }
 } // end namespace runtime
\ No newline at end of file
@@ -0,0 +1,315 @@
+#include "runtime/ColumnStatistics.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <random>
+#include <string_view>
+
+#include <arrow/api.h>
+#include <arrow/compute/api.h>
+namespace {
+//values of large columns are sampled for building histograms
+constexpr int64_t histogramSampleSize = 16384;
+constexpr uint32_t histogramSampleSeed = 42;
+
+uint64_t mix(uint64_t h) {
+   //murmur3 finalizer
+   h ^= h >> 33;
+   h *= 0xff51afd7ed558ccdull;
+   h ^= h >> 33;
+   h *= 0xc4ceb9fe1a85ec53ull;
+   h ^= h >> 33;
+   return h;
+}
+uint64_t hashBytes(const uint8_t* data, size_t len) {
+   return mix(std::hash<std::string_view>{}(std::string_view(reinterpret_cast<const char*>(data), len)));
+}
+bool addHashes(runtime::HyperLogLog& hyperLogLog, const std::shared_ptr<arrow::Array>& array) {
+   auto type = array->type();
+   if (type->id() == arrow::Type::DICTIONARY) {
+      auto decoded = arrow::compute::Cast(*array, std::static_pointer_cast<arrow::DictionaryType>(type)->value_type());
+      return decoded.ok() && addHashes(hyperLogLog, decoded.ValueOrDie());
+   }
+   if (type->id() == arrow::Type::STRING || type->id() == arrow::Type::BINARY) {
+      auto binaryArray = std::static_pointer_cast<arrow::BinaryArray>(array);
+      for (int64_t i = 0; i < array->length(); i++) {
+         if (array->IsNull(i)) continue;
+         auto view = binaryArray->GetView(i);
+         hyperLogLog.add(hashBytes(reinterpret_cast<const uint8_t*>(view.data()), view.size()));
+      }
+      return true;
+   }
+   if (type->id() == arrow::Type::BOOL) {
+      auto boolArray = std::static_pointer_cast<arrow::BooleanArray>(array);
+      for (int64_t i = 0; i < array->length(); i++) {
+         if (array->IsNull(i)) continue;
+         uint8_t value = boolArray->Value(i);
+         hyperLogLog.add(hashBytes(&value, 1));
+      }
+      return true;
+   }
+   auto* fixedWidthType = dynamic_cast<const arrow::FixedWidthType*>(type.get());
+   if (!fixedWidthType || fixedWidthType->bit_width() % 8 != 0 || array->data()->buffers.size() < 2) {
+      return false;
+   }
+   size_t byteWidth = fixedWidthType->bit_width() / 8;
+   const auto* values = array->data()->buffers[1]->data() + array->offset() * byteWidth;
+   for (int64_t i = 0; i < array->length(); i++) {
+      if (array->IsNull(i)) continue;
+      hyperLogLog.add(hashBytes(values + i * byteWidth, byteWidth));
+   }
+   return true;
+}
+//maps the values of ordered types to doubles: numbers to their value, dates/timestamps to their integer representation
+std::optional<std::vector<double>> toDoubles(std::shared_ptr<arrow::Array> array) {
+   switch (array->type_id()) {
+      case arrow::Type::INT8:
+      case arrow::Type::INT16:
+      case arrow::Type::INT32:
+      case arrow::Type::INT64:
+      case arrow::Type::UINT8:
+      case arrow::Type::UINT16:
+      case arrow::Type::UINT32:
+      case arrow::Type::UINT64:
+      case arrow::Type::FLOAT:
+      case arrow::Type::DOUBLE:
+      case arrow::Type::DECIMAL128:
+         break;
+      case arrow::Type::DATE32: {
+         auto casted = arrow::compute::Cast(*array, arrow::int32());
+         if (!casted.ok()) return {};
+         array = casted.ValueOrDie();
+         break;
+      }
+      case arrow::Type::DATE64:
+      case arrow::Type::TIMESTAMP: {
+         auto casted = arrow::compute::Cast(*array, arrow::int64());
+         if (!casted.ok()) return {};
+         array = casted.ValueOrDie();
+         break;
+      }
+      default:
+         return {};
+   }
+   auto casted = arrow::compute::Cast(*array, arrow::float64());
+   if (!casted.ok()) return {};
+   auto doubleArray = std::static_pointer_cast<arrow::DoubleArray>(casted.ValueOrDie());
+   std::vector<double> res;
+   for (int64_t i = 0; i < doubleArray->length(); i++) {
+      if (doubleArray->IsValid(i)) {
+         res.push_back(doubleArray->Value(i));
+      }
+   }
+   return res;
+}
+std::optional<runtime::Histogram> createHistogram(const std::shared_ptr<arrow::ChunkedArray>& column) {
+   int64_t nonNull = column->length() - column->null_count();
+   if (nonNull == 0) return {};
+   std::shared_ptr<arrow::Array> sample;
+   if (column->length() <= histogramSampleSize) {
+      auto concatenated = arrow::Concatenate(column->chunks());
+      if (!concatenated.ok()) return {};
+      sample = concatenated.ValueOrDie();
+   } else {
+      //fixed seed: the same data always results in the same histogram (and plan)
+      auto rng = std::mt19937{histogramSampleSeed};
+      std::uniform_int_distribution<int64_t> distribution(0, column->length() - 1);
+      arrow::Int64Builder indicesBuilder;
+      for (int64_t i = 0; i < histogramSampleSize; i++) {
+         if (!indicesBuilder.Append(distribution(rng)).ok()) return {};
+      }
+      auto taken = arrow::compute::Take(column, indicesBuilder.Finish().ValueOrDie());
+      if (!taken.ok()) return {};
+      auto concatenated = arrow::Concatenate(taken.ValueOrDie().chunked_array()->chunks());
+      if (!concatenated.ok()) return {};
+      sample = concatenated.ValueOrDie();
+   }
+   auto values = toDoubles(sample);
+   if (!values || values->empty()) return {};
+   double scale = static_cast<double>(nonNull) / values->size();
+   return runtime::Histogram::create(values.value(), scale);
+}
+} // end namespace
+
+void runtime::HyperLogLog::add(uint64_t hash) {
+   size_t idx = hash >> (64 - precision);
+   uint64_t remaining = hash << precision;
+   uint8_t rank = remaining == 0 ? 64 - precision + 1 : std::countl_zero(remaining) + 1;
+   registers[idx] = std::max(registers[idx], rank);
+}
+void runtime::HyperLogLog::merge(const HyperLogLog& other) {
+   for (size_t i = 0; i < numRegisters; i++) {
+      registers[i] = std::max(registers[i], other.registers[i]);
+   }
+}
+double runtime::HyperLogLog::estimate() const {
+   double m = numRegisters;
+   double alpha = 0.7213 / (1 + 1.079 / m);
+   double sum = 0;
+   size_t zeros = 0;
+   for (auto r : registers) {
+      sum += std::ldexp(1.0, -r);
+      zeros += r == 0;
+   }
+   double estimate = alpha * m * m / sum;
+   //small range correction: linear counting
+   if (estimate <= 2.5 * m && zeros > 0) {
+      estimate = m * std::log(m / zeros);
+   }
+   return estimate;
+}
+
+runtime::Histogram runtime::Histogram::create(std::vector<double>& values, double scale) {
+   std::sort(values.begin(), values.end());
+   Histogram res;
+   size_t buckets = std::min(numBuckets, values.size());
+   for (size_t i = 0; i < buckets; i++) {
+      size_t begin = i * values.size() / buckets;
+      size_t end = (i + 1) * values.size() / buckets;
+      res.bounds.push_back(values[begin]);
+      res.counts.push_back((end - begin) * scale);
+   }
+   res.bounds.push_back(values.back());
+   return res;
+}
+double runtime::Histogram::getCount() const {
+   double res = 0;
+   for (auto c : counts) {
+      res += c;
+   }
+   return res;
+}
+double runtime::Histogram::countLess(double value, bool inclusive) const {
+   double res = 0;
+   for (size_t i = 0; i < counts.size(); i++) {
+      double lower = bounds[i];
+      double upper = bounds[i + 1];
+      if (upper < value || (upper == value && (inclusive || lower < upper))) {
+         res += counts[i];
+      } else if (lower < value && upper > value) {
+         //values are assumed to be uniformly distributed within a bucket
+         res += counts[i] * (value - lower) / (upper - lower);
+      }
+   }
+   return res;
+}
+double runtime::Histogram::countEqual(double value, double distinctValues) const {
+   double total = getCount();
+   double res = 0;
+   for (size_t i = 0; i < counts.size(); i++) {
+      double lower = bounds[i];
+      double upper = bounds[i + 1];
+      if (lower == value && upper == value) {
+         res += counts[i];
+      } else if (lower <= value && value <= upper) {
+         double distinctInBucket = std::max(1.0, distinctValues * counts[i] / total);
+         res += counts[i] / distinctInBucket;
+      }
+   }
+   return res;
+}
+runtime::Histogram runtime::Histogram::merge(const Histogram& left, const Histogram& right) {
+   //the buckets of both histograms describe a distribution (uniform within buckets, point masses for buckets with equal bounds)
+   //the merged histogram has equi-depth buckets with respect to this distribution
+   struct Piece {
+      double lower, upper, count;
+   };
+   std::vector<Piece> pieces;
+   std::vector<double> points;
+   for (const auto* histogram : {&left, &right}) {
+      for (size_t i = 0; i < histogram->counts.size(); i++) {
+         pieces.push_back({histogram->bounds[i], histogram->bounds[i + 1], histogram->counts[i]});
+         points.push_back(histogram->bounds[i]);
+         points.push_back(histogram->bounds[i + 1]);
+      }
+   }
+   std::sort(points.begin(), points.end());
+   points.erase(std::unique(points.begin(), points.end()), points.end());
+   //cumulative count (inclusive) and point mass at every point
+   std::vector<double> cumulative;
+   std::vector<double> pointMass;
+   for (auto p : points) {
+      double count = 0;
+      double mass = 0;
+      for (const auto& piece : pieces) {
+         if (piece.upper <= p) {
+            count += piece.count;
+            mass += piece.lower == p ? piece.count : 0;
+         } else if (piece.lower < p) {
+            count += piece.count * (p - piece.lower) / (piece.upper - piece.lower);
+         }
+      }
+      cumulative.push_back(count);
+      pointMass.push_back(mass);
+   }
+   double total = left.getCount() + right.getCount();
+   Histogram res;
+   res.bounds.push_back(points.front());
+   size_t current = 0;
+   for (size_t i = 1; i <= numBuckets; i++) {
+      double target = total * i / numBuckets;
+      while (current + 1 < points.size() && cumulative[current] < target) {
+         current++;
+      }
+      double bound = points[current];
+      if (current > 0) {
+         double continuousBefore = cumulative[current - 1];
+         double continuousMass = cumulative[current] - pointMass[current] - continuousBefore;
+         if (continuousMass > 0 && target < continuousBefore + continuousMass) {
+            bound = points[current - 1] + (points[current] - points[current - 1]) * (target - continuousBefore) / continuousMass;
+         }
+      }
+      res.bounds.push_back(i == numBuckets ? points.back() : bound);
+      res.counts.push_back(total / numBuckets);
+   }
+   return res;
+}
+
+std::shared_ptr<runtime::ColumnStatistics> runtime::ColumnStatistics::create(const std::shared_ptr<arrow::ChunkedArray>& column) {
+   std::optional<HyperLogLog> hyperLogLog = HyperLogLog();
+   for (const auto& chunk : column->chunks()) {
+      if (!addHashes(hyperLogLog.value(), chunk)) {
+         hyperLogLog = {};
+         break;
+      }
+   }
+   return std::make_shared<ColumnStatistics>(column->length(), hyperLogLog, createHistogram(column));
+}
+std::shared_ptr<runtime::ColumnStatistics> runtime::ColumnStatistics::merge(const ColumnStatistics& other) const {
+   std::optional<HyperLogLog> mergedHyperLogLog;
+   if (hyperLogLog && other.hyperLogLog) {
+      mergedHyperLogLog = hyperLogLog.value();
+      mergedHyperLogLog->merge(other.hyperLogLog.value());
+   }
+   std::optional<Histogram> mergedHistogram;
+   if (histogram && other.histogram) {
+      mergedHistogram = Histogram::merge(histogram.value(), other.histogram.value());
+   } else if (histogram && other.rows == 0) {
+      mergedHistogram = histogram;
+   } else if (other.histogram && rows == 0) {
+      mergedHistogram = other.histogram;
+   }
+   return std::make_shared<ColumnStatistics>(rows + other.rows, mergedHyperLogLog, mergedHistogram);
+}
+std::optional<size_t> runtime::ColumnStatistics::getDistinctValues() const {
+   if (!hyperLogLog) return {};
+   return static_cast<size_t>(std::round(hyperLogLog->estimate()));
+}
+std::optional<double> runtime::ColumnStatistics::estimateSelectivity(const std::string& cmp, double value) const {
+   if (!histogram || rows == 0) return {};
+   double count;
+   if (cmp == "eq") {
+      auto distinctValues = getDistinctValues();
+      if (!distinctValues) return {};
+      count = histogram->countEqual(value, std::max<double>(1, distinctValues.value()));
+   } else if (cmp == "lt" || cmp == "lte") {
+      count = histogram->countLess(value, cmp == "lte");
+   } else if (cmp == "gt" || cmp == "gte") {
+      count = histogram->getCount() - histogram->countLess(value, cmp == "gt");
+   } else {
+      return {};
+   }
+   //at least one row
+   return std::clamp(count / rows, 1.0 / rows, 1.0);
+}
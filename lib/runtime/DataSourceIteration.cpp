@@ -1,6 +1,10 @@
 #include "runtime/DataSourceIteration.h"
 #include "json.h"
+#include "runtime/Numa.h"
+#include "runtime/ZoneMap.h"
+#include <atomic>
 #include <iterator>
+#include <optional>
 
 #include "utility/Tracer.h"
 #include <arrow/array.h>
@@ -15,35 +19,147 @@ static utility::Tracer::Event processMorselSingle("DataSourceIteration", "proces
 static utility::Tracer::Event cleanupTLS("DataSourceIteration", "cleanup");
 static utility::Tracer::Event tableScan("DataSourceIteration", "tableScan");
 
-static void access(std::vector<size_t> colIds, runtime::RecordBatchInfo* info, const std::shared_ptr<arrow::RecordBatch>& currChunk) {
-   for (size_t i = 0; i < colIds.size(); i++) {
-      auto colId = colIds[i];
-      runtime::ColumnInfo& colInfo = info->columnInfo[i];
-      size_t off = currChunk->column_data(colId)->offset;
-      colInfo.offset = off;
-      colInfo.validMultiplier = currChunk->column_data(colId)->buffers[0] ? 1 : 0;
-      colInfo.validBuffer = runtime::RecordBatchInfo::getBuffer(currChunk.get(), colId, 0);
-      colInfo.dataBuffer = runtime::RecordBatchInfo::getBuffer(currChunk.get(), colId, 1);
-      colInfo.varLenBuffer = runtime::RecordBatchInfo::getBuffer(currChunk.get(), colId, 2);
-   }
-   info->numRows = currChunk->num_rows();
+//code of the value in the dictionary, -1 if not contained
+static int32_t lookupCode(const std::shared_ptr<arrow::ArrayData>& dictionary, const std::string& value) {
+   arrow::StringArray values(dictionary);
+   for (int64_t i = 0; i < values.length(); i++) {
+      if (values.IsValid(i) && values.GetView(i) == value) {
+         return i;
+      }
+   }
+   return -1;
+}
+//the codes of all dictionaries of a column (all record batches of a stored table share the same dictionary)
+static std::unordered_map<const arrow::ArrayData*, int32_t> lookupCodes(const std::vector<std::shared_ptr<arrow::RecordBatch>>& recordBatches, int columnId, const std::string& value) {
+   std::unordered_map<const arrow::ArrayData*, int32_t> codes;
+   for (const auto& batch : recordBatches) {
+      const auto& dictionary = batch->column_data(columnId)->dictionary;
+      if (!codes.contains(dictionary.get())) {
+         codes[dictionary.get()] = lookupCode(dictionary, value);
+      }
+   }
+   return codes;
+}
+//equality restrictions on dictionary-encoded columns: record batches whose dictionary does not contain the value can be skipped
+static std::vector<std::shared_ptr<arrow::RecordBatch>> filterByDictionaries(std::vector<std::shared_ptr<arrow::RecordBatch>> recordBatches, const std::vector<runtime::ScanRestriction>& restrictions) {
+   for (const auto& r : restrictions) {
+      if (r.cmp != "eq" || recordBatches.empty()) continue;
+      auto columnId = recordBatches[0]->schema()->GetFieldIndex(r.column);
+      if (columnId < 0 || recordBatches[0]->schema()->field(columnId)->type()->id() != arrow::Type::DICTIONARY) continue;
+      auto codes = lookupCodes(recordBatches, columnId, r.value);
+      std::vector<std::shared_ptr<arrow::RecordBatch>> res;
+      for (const auto& batch : recordBatches) {
+         if (codes[batch->column_data(columnId)->dictionary.get()] >= 0) {
+            res.push_back(batch);
+         }
+      }
+      recordBatches = std::move(res);
+   }
+   return recordBatches;
 }
+//member that compares the codes of a dictionary-encoded column with the code of an equality restriction's value
+struct DictionaryCodeMatch {
+   size_t columnId;
+   std::unordered_map<const arrow::ArrayData*, int32_t> codes;
+};
+//morsels are queued per NUMA node of their data: workers process the morsels of their own node first and steal from other nodes afterwards
+class NumaMorselQueues {
+   std::vector<std::vector<size_t>> queues;
+   std::unique_ptr<std::atomic<size_t>[]> positions;
+
+   static const void* firstRow(const arrow::ArrayData& data) {
+      if (data.buffers.size() < 2 || !data.buffers[1]) return nullptr;
+      size_t bitWidth = 32; //offsets of variable-sized data
+      if (const auto* fixedWidthType = dynamic_cast<const arrow::FixedWidthType*>(data.type.get())) {
+         bitWidth = fixedWidthType->bit_width();
+      }
+      return data.buffers[1]->data() + data.offset * bitWidth / 8;
+   }
+
+   public:
+   NumaMorselQueues(const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches, const std::vector<size_t>& colIds) : queues(runtime::Numa::getNumNodes()), positions(new std::atomic<size_t>[queues.size()]) {
+      size_t numNodes = queues.size();
+      std::vector<size_t> nodes(batches.size(), numNodes);
+      if (!colIds.empty()) {
+         std::vector<const void*> addresses;
+         for (const auto& batch : batches) {
+            addresses.push_back(firstRow(*batch->column_data(colIds[0])));
+         }
+         nodes = runtime::Numa::getNodes(addresses);
+      }
+      for (size_t i = 0; i < batches.size(); i++) {
+         //unknown placement: same ranges as used by Numa::placeRecordBatches
+         queues[nodes[i] < numNodes ? nodes[i] : i * numNodes / batches.size()].push_back(i);
+      }
+      for (size_t i = 0; i < numNodes; i++) {
+         positions[i] = 0;
+      }
+   }
+   std::optional<size_t> next(size_t node) {
+      for (size_t i = 0; i < queues.size(); i++) {
+         size_t current = (node + i) % queues.size();
+         if (positions[current].load(std::memory_order_relaxed) >= queues[current].size()) continue;
+         size_t pos = positions[current].fetch_add(1);
+         if (pos < queues[current].size()) {
+            return queues[current][pos];
+         }
+      }
+      return {};
+   }
+};
 class RecordBatchTableSource : public runtime::DataSource {
-   const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches;
+   std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
    std::unordered_map<std::string, size_t> memberToColumnId;
+   //column ids starting at numColumns refer to the dictionary code matches
+   size_t numColumns;
+   std::vector<DictionaryCodeMatch> codeMatches;
+
+   size_t getPhysicalColumnId(size_t colId) {
+      return colId < numColumns ? colId : codeMatches[colId - numColumns].columnId;
+   }
+   void access(const std::vector<size_t>& colIds, runtime::RecordBatchInfo* info, const std::shared_ptr<arrow::RecordBatch>& currChunk) {
+      for (size_t i = 0; i < colIds.size(); i++) {
+         auto colId = getPhysicalColumnId(colIds[i]);
+         runtime::RecordBatchInfo::initColumnInfo(info->columnInfo[i], currChunk.get(), colId);
+         if (colIds[i] >= numColumns) {
+            info->columnInfo[i].code = codeMatches[colIds[i] - numColumns].codes.at(currChunk->column_data(colId)->dictionary.get());
+         }
+      }
+      info->numRows = currChunk->num_rows();
+   }
 
    public:
-   RecordBatchTableSource(const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches, std::unordered_map<std::string, size_t> memberToColumnId) : batches(batches), memberToColumnId(memberToColumnId) {}
+   RecordBatchTableSource(const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches, std::unordered_map<std::string, size_t> memberToColumnId, size_t numColumns) : batches(batches), memberToColumnId(memberToColumnId), numColumns(numColumns) {}
+   void addCodeMatch(const std::string& member, size_t columnId, const std::string& value) {
+      memberToColumnId[member] = numColumns + codeMatches.size();
+      codeMatches.push_back({columnId, lookupCodes(batches, columnId, value)});
+   }
    void iterate(bool parallel, std::vector<size_t> colIds, const std::function<void(runtime::RecordBatchInfo*)>& cb) override {
       if (parallel) {
          tbb::enumerable_thread_specific<runtime::RecordBatchInfo*> batchInfo([&]() { return reinterpret_cast<runtime::RecordBatchInfo*>(malloc(sizeof(runtime::RecordBatchInfo) + sizeof(runtime::ColumnInfo) * colIds.size())); });
          utility::Tracer::Trace tbbTrace(tbbForEach);
-         tbb::parallel_for_each(batches.begin(), batches.end(), [&](const std::shared_ptr<arrow::RecordBatch>& batch) {
-            utility::Tracer::Trace trace(processMorsel);
-            access(colIds, batchInfo.local(), batch);
-            cb(batchInfo.local());
-            trace.stop();
-         });
+         if (runtime::Numa::getNumNodes() > 1) {
+            std::vector<size_t> physicalColIds;
+            for (auto colId : colIds) {
+               physicalColIds.push_back(getPhysicalColumnId(colId));
+            }
+            NumaMorselQueues queues(batches, physicalColIds);
+            tbb::parallel_for(0, tbb::this_task_arena::max_concurrency(), [&](int) {
+               while (auto next = queues.next(runtime::Numa::getCurrentNode())) {
+                  utility::Tracer::Trace trace(processMorsel);
+                  access(colIds, batchInfo.local(), batches[next.value()]);
+                  cb(batchInfo.local());
+                  trace.stop();
+               }
+            });
+         } else {
+            tbb::parallel_for_each(batches.begin(), batches.end(), [&](const std::shared_ptr<arrow::RecordBatch>& batch) {
+               utility::Tracer::Trace trace(processMorsel);
+               access(colIds, batchInfo.local(), batch);
+               cb(batchInfo.local());
+               trace.stop();
+            });
+         }
          tbbTrace.stop();
          utility::Tracer::Trace cleanUpTrace(cleanupTLS);
 
@@ -77,17 +193,6 @@ class RecordBatchTableSource : public runtime::DataSource {
 void runtime::DataSourceIteration::end(DataSourceIteration* iteration) {
    delete iteration;
 }
-uint64_t getTableColumnId(const std::shared_ptr<arrow::Schema>& schema, std::string columnName) {
-   auto columnNames = schema->field_names();
-   size_t columnId = 0;
-   for (auto column : columnNames) {
-      if (column == columnName) {
-         return columnId;
-      }
-      columnId++;
-   }
-   throw std::runtime_error("column not found: " + columnName);
-}
 runtime::DataSourceIteration* runtime::DataSourceIteration::init(DataSource* dataSource, runtime::VarLen32 members) {
    nlohmann::json descr = nlohmann::json::parse(members.str());
    std::vector<size_t> colIds;
@@ -107,17 +212,64 @@ runtime::DataSource* runtime::DataSource::get(runtime::ExecutionContext* executi
    if (!relation) {
       throw std::runtime_error("could not find relation");
    }
+   //column ids refer to the loaded columns of this version of the record batches: columns that are not loaded yet (lazy loading) are loaded now
+   std::vector<std::string> columns;
+   for (auto m : descr["mapping"].get<nlohmann::json::object_t>()) {
+      columns.push_back(m.second.get<std::string>());
+   }
+   relation->loadColumns(columns);
+   auto recordBatches = relation->getRecordBatches();
+   auto loadedSchema = recordBatches->empty() ? relation->getTable()->schema() : recordBatches->front()->schema();
    std::unordered_map<std::string, size_t> memberToColumnId;
    for (auto m : descr["mapping"].get<nlohmann::json::object_t>()) {
-      memberToColumnId[m.first] = getTableColumnId(relation->getArrowSchema(), m.second.get<std::string>());
+      auto columnId = loadedSchema->GetFieldIndex(m.second.get<std::string>());
+      if (columnId < 0) {
+         throw std::runtime_error("data source: column " + m.second.get<std::string>() + " of table " + tableName + " is not available");
+      }
+      memberToColumnId[m.first] = columnId;
+   }
+   RecordBatchTableSource* dataSource = nullptr;
+   if (descr.contains("restrictions")) {
+      std::vector<runtime::ScanRestriction> restrictions;
+      for (auto r : descr["restrictions"].get<nlohmann::json::array_t>()) {
+         if (r.contains("parameter")) {
+            restrictions.push_back({r["column"], r["cmp"], executionContext->getParameter(r["parameter"].get<uint32_t>()).str()});
+         } else {
+            restrictions.push_back({r["column"], r["cmp"], r["value"]});
+         }
+      }
+      auto filtered = *recordBatches;
+      if (auto zoneMap = relation->getZoneMap()) {
+         filtered = zoneMap->filter(filtered, restrictions);
+         executionContext->count("skipped record batches", recordBatches->size() - filtered.size());
+      }
+      dataSource = new RecordBatchTableSource(filterByDictionaries(std::move(filtered), restrictions), memberToColumnId, loadedSchema->num_fields());
+      if (descr.contains("dictionary_matches")) {
+         for (auto m : descr["dictionary_matches"].get<nlohmann::json::object_t>()) {
+            const auto& restriction = restrictions.at(m.second.get<size_t>());
+            auto columnId = loadedSchema->GetFieldIndex(restriction.column);
+            if (columnId < 0 || loadedSchema->field(columnId)->type()->id() != arrow::Type::DICTIONARY) {
+               throw std::runtime_error("data source: column " + restriction.column + " is not dictionary-encoded");
+            }
+            dataSource->addCodeMatch(m.first, columnId, restriction.value);
+         }
+      }
+   } else {
+      dataSource = new RecordBatchTableSource(*recordBatches, memberToColumnId, loadedSchema->num_fields());
    }
-   return new RecordBatchTableSource(relation->getRecordBatches(), memberToColumnId);
+   dataSource->executionContext = executionContext;
+   return dataSource;
 }
 
 void runtime::DataSourceIteration::iterate(bool parallel, void (*forEachChunk)(runtime::RecordBatchInfo*, void*), void* context) {
    utility::Tracer::Trace trace(tableScan);
-   dataSource->iterate(parallel, colIds, [context, forEachChunk](runtime::RecordBatchInfo* recordBatchInfo) {
-      forEachChunk(recordBatchInfo, context);
+   auto* executionContext = dataSource->getExecutionContext();
+   dataSource->iterate(parallel, colIds, [context, forEachChunk, executionContext](runtime::RecordBatchInfo* recordBatchInfo) {
+      //the query is restarted with a new plan: skip the remaining morsels
+      if (executionContext->isReoptimizationRequested()) return;
+      //tiered execution: switch to an optimized version of the pipeline as soon as it is available (at morsel boundaries)
+      auto* fn = reinterpret_cast<decltype(forEachChunk)>(executionContext->getFunctionReplacement(reinterpret_cast<void*>(forEachChunk)));
+      fn(recordBatchInfo, context);
    });
    trace.stop();
 }
\ No newline at end of file
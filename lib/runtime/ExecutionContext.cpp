@@ -1,5 +1,28 @@
 #include "runtime/ExecutionContext.h"
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
+#include <limits>
+namespace {
+size_t getMemoryLimit() {
+   if (const char* limit = std::getenv("LINGODB_MEMORY_LIMIT")) {
+      return std::strtoull(limit, nullptr, 10) * 1024 * 1024;
+   }
+   return 0;
+}
+} // end namespace
+runtime::ExecutionContext::ExecutionContext(Session& session) : memoryLimit(getMemoryLimit()), session(session) {
+   auto allocate = [this](size_t bytes) {
+      if (!allocateSpillable(bytes)) {
+         return false;
+      }
+      //file-backed chunks are not accounted
+      releaseSpillable(bytes);
+      count("spilled arena chunks");
+      return true;
+   };
+   arena.setBudget(allocate, [this](size_t bytes) { releaseSpillable(bytes); });
+}
 
 void runtime::ExecutionContext::setResult(uint32_t id, uint8_t* ptr) {
    states.erase(ptr);
@@ -7,7 +30,48 @@ void runtime::ExecutionContext::setResult(uint32_t id, uint8_t* ptr) {
 }
 
 void runtime::ExecutionContext::setTupleCount(uint32_t id, int64_t tupleCount) {
+   //counts of cancelled pipelines are incomplete
+   if (isReoptimizationRequested()) return;
    tupleCounts[id] = tupleCount;
+   if (auto it = expectedTupleCounts.find(id); it != expectedTupleCounts.end()) {
+      double expected = std::max(it->second, 1.0);
+      double actual = std::max(static_cast<double>(tupleCount), 1.0);
+      if (std::max(expected / actual, actual / expected) > reoptimizationFactor) {
+         reoptimizationRequested.store(true, std::memory_order_relaxed);
+      }
+   }
+}
+runtime::VarLen32 runtime::ExecutionContext::getParameter(uint32_t idx) {
+   if (idx >= parameters.size()) {
+      throw std::runtime_error("no value for parameter $" + std::to_string(idx + 1));
+   }
+   auto& parameter = parameters[idx];
+   return runtime::VarLen32(reinterpret_cast<const uint8_t*>(parameter.data()), parameter.size());
+}
+void* runtime::ExecutionContext::getFunctionReplacement(void* fn) {
+   const auto* replacements = functionReplacements.load(std::memory_order_acquire);
+   if (!replacements) {
+      return fn;
+   }
+   auto it = replacements->find(fn);
+   return it == replacements->end() ? fn : it->second;
+}
+bool runtime::ExecutionContext::allocateSpillable(size_t bytes) {
+   auto total = spillableMemory.fetch_add(bytes) + bytes;
+   return memoryLimit && total > memoryLimit;
+}
+size_t runtime::ExecutionContext::getAvailableSpillable() const {
+   if (!memoryLimit) return std::numeric_limits<size_t>::max();
+   auto used = spillableMemory.load();
+   return used < memoryLimit ? memoryLimit - used : 0;
+}
+void runtime::ExecutionContext::count(const std::string& name, size_t value) {
+   std::lock_guard<std::mutex> lock(countersMutex);
+   counters[name] += value;
+}
+std::map<std::string, size_t> runtime::ExecutionContext::getCounters() {
+   std::lock_guard<std::mutex> lock(countersMutex);
+   return counters;
 }
 void runtime::ExecutionContext::reset() {
    for (auto s : states) {
@@ -20,6 +84,7 @@ void runtime::ExecutionContext::reset() {
    }
    allocators.clear();
    states.clear();
+   arena.release();
 }
 runtime::ExecutionContext::~ExecutionContext() {
    reset();
@@ -2,6 +2,7 @@
 #include "runtime/helpers.h"
 #include "utility/Tracer.h"
 #include <algorithm>
+#include <array>
 #include <cstring>
 #include <iostream>
 namespace {
@@ -9,12 +10,68 @@ static utility::Tracer::Event createEvent("GrowingBuffer", "create");
 static utility::Tracer::Event mergeEvent("GrowingBuffer", "merge");
 static utility::Tracer::Event sortEvent("GrowingBuffer", "sort");
 static utility::Tracer::Event rawSortEvent("GrowingBuffer", "rawSort");
+static utility::Tracer::Event radixSortEvent("GrowingBuffer", "radixSort");
+
+struct SortEntry {
+   uint64_t key;
+   uint8_t* ptr;
+};
+using CompareFn = bool (*)(uint8_t*, uint8_t*);
+//ranges below this size are sorted with std::sort instead of another radix pass
+constexpr size_t radixSortThreshold = 256;
+constexpr size_t radixSortMorselSize = 65536;
+
+void sortTies(SortEntry* begin, SortEntry* end, CompareFn compareFn) {
+   std::sort(begin, end, [&](const SortEntry& l, const SortEntry& r) { return compareFn(l.ptr, r.ptr); });
+}
+//sorts data by the bytes [byte..0] of the key, tmp is used as scratch space
+void msbRadixSort(SortEntry* data, SortEntry* tmp, size_t len, int byte, CompareFn compareFn) {
+   if (len <= 1) {
+      return;
+   }
+   if (byte < 0) {
+      sortTies(data, data + len, compareFn);
+      return;
+   }
+   if (len <= radixSortThreshold) {
+      std::sort(data, data + len, [](const SortEntry& l, const SortEntry& r) { return l.key < r.key; });
+      for (size_t i = 0; i < len;) {
+         size_t j = i + 1;
+         while (j < len && data[j].key == data[i].key) j++;
+         if (j - i > 1) {
+            sortTies(data + i, data + j, compareFn);
+         }
+         i = j;
+      }
+      return;
+   }
+   size_t shift = byte * 8;
+   size_t counts[256] = {};
+   for (size_t i = 0; i < len; i++) {
+      counts[(data[i].key >> shift) & 0xff]++;
+   }
+   size_t offsets[256];
+   size_t offset = 0;
+   for (size_t b = 0; b < 256; b++) {
+      offsets[b] = offset;
+      offset += counts[b];
+   }
+   for (size_t i = 0; i < len; i++) {
+      tmp[offsets[(data[i].key >> shift) & 0xff]++] = data[i];
+   }
+   std::copy(tmp, tmp + len, data);
+   size_t start = 0;
+   for (size_t b = 0; b < 256; b++) {
+      msbRadixSort(data + start, tmp + start, counts[b], byte - 1, compareFn);
+      start += counts[b];
+   }
+}
 
 class DefaultAllocator : public runtime::GrowingBufferAllocator {
    public:
    runtime::GrowingBuffer* create(runtime::ExecutionContext* executionContext, size_t sizeOfType, size_t initialCapacity) override {
       utility::Tracer::Trace trace(createEvent);
-      auto* res = new runtime::GrowingBuffer(initialCapacity, sizeOfType);
+      auto* res = new runtime::GrowingBuffer(initialCapacity, sizeOfType, &executionContext->getArena());
       executionContext->registerState({res, [](void* ptr) { delete reinterpret_cast<runtime::GrowingBuffer*>(ptr); }});
       trace.stop();
       return res;
@@ -26,7 +83,7 @@ class GroupAllocator : public runtime::GrowingBufferAllocator {
 
    public:
    runtime::GrowingBuffer* create(runtime::ExecutionContext* executionContext, size_t sizeOfType, size_t initialCapacity) override {
-      auto* res = new runtime::GrowingBuffer(initialCapacity, sizeOfType);
+      auto* res = new runtime::GrowingBuffer(initialCapacity, sizeOfType, &executionContext->getArena());
       buffers.push_back(res);
       return res;
    }
@@ -64,8 +121,7 @@ runtime::Buffer runtime::GrowingBuffer::sort(runtime::ExecutionContext* executio
    utility::Tracer::Trace trace2(rawSortEvent);
    tbb::parallel_sort(toSort.begin(), toSort.end(), compareFn);
    trace2.stop();
-   uint8_t* sorted = new uint8_t[typeSize * len];
-   executionContext->registerState({sorted, [](void* ptr) { delete[] reinterpret_cast<uint8_t*>(ptr); }});
+   uint8_t* sorted = executionContext->getArena().allocate(typeSize * len);
    tbb::parallel_for(tbb::blocked_range<size_t>(0ul, len), [&](tbb::blocked_range<size_t> range) {
       for (size_t i = range.begin(); i < range.end(); i++) {
          uint8_t* ptr = sorted + (i * typeSize);
@@ -75,20 +131,109 @@ runtime::Buffer runtime::GrowingBuffer::sort(runtime::ExecutionContext* executio
 
    return Buffer{typeSize * len, sorted};
 }
-runtime::Buffer runtime::GrowingBuffer::asContinuous(runtime::ExecutionContext* executionContext) {
-   //todo make more performant...
-   std::vector<uint8_t*> toSort;
-   values.iterate([&](uint8_t* entryRawPtr) {
-      toSort.push_back(entryRawPtr);
+runtime::Buffer runtime::GrowingBuffer::sortWithKey(runtime::ExecutionContext* executionContext, bool (*compareFn)(uint8_t*, uint8_t*), uint64_t (*keyFn)(uint8_t*)) {
+   utility::Tracer::Trace trace(sortEvent);
+   size_t typeSize = values.getTypeSize();
+   size_t len = values.getLen();
+   std::vector<SortEntry> entries(len);
+   std::vector<SortEntry> tmp(len);
+   const auto& buffers = values.getBuffers();
+   std::vector<size_t> bufferStart(buffers.size());
+   for (size_t i = 0, start = 0; i < buffers.size(); i++) {
+      bufferStart[i] = start;
+      start += buffers[i].numElements;
+   }
+   tbb::parallel_for(size_t(0), buffers.size(), [&](size_t b) {
+      tbb::parallel_for(tbb::blocked_range<size_t>(0ul, buffers[b].numElements), [&](tbb::blocked_range<size_t> range) {
+         for (size_t i = range.begin(); i < range.end(); i++) {
+            auto* ptr = &buffers[b].ptr[i * typeSize];
+            entries[bufferStart[b] + i] = {keyFn(ptr), ptr};
+         }
+      });
+   });
+   utility::Tracer::Trace trace2(radixSortEvent);
+   auto [minKey, maxKey] = tbb::parallel_reduce(
+      tbb::blocked_range<size_t>(0ul, len), std::pair<uint64_t, uint64_t>{~0ull, 0ull}, [&](tbb::blocked_range<size_t> range, std::pair<uint64_t, uint64_t> minMax) {
+         for (size_t i = range.begin(); i < range.end(); i++) {
+            minMax.first = std::min(minMax.first, entries[i].key);
+            minMax.second = std::max(minMax.second, entries[i].key);
+         }
+         return minMax; }, [](auto l, auto r) { return std::pair<uint64_t, uint64_t>{std::min(l.first, r.first), std::max(l.second, r.second)}; });
+   SortEntry* sorted = entries.data();
+   if (len > 1 && minKey == maxKey) {
+      tbb::parallel_sort(entries.begin(), entries.end(), [&](const SortEntry& l, const SortEntry& r) { return compareFn(l.ptr, r.ptr); });
+   } else if (len > 1) {
+      //skip the common prefix of all keys: the first pass partitions by the most significant differing byte
+      int byte = (63 - __builtin_clzll(minKey ^ maxKey)) / 8;
+      size_t shift = byte * 8;
+      size_t numMorsels = (len + radixSortMorselSize - 1) / radixSortMorselSize;
+      std::vector<std::array<size_t, 256>> offsets(numMorsels);
+      tbb::parallel_for(size_t(0), numMorsels, [&](size_t m) {
+         auto& histogram = offsets[m];
+         histogram.fill(0);
+         for (size_t i = m * radixSortMorselSize; i < std::min(len, (m + 1) * radixSortMorselSize); i++) {
+            histogram[(entries[i].key >> shift) & 0xff]++;
+         }
+      });
+      std::array<size_t, 257> bucketStart;
+      size_t offset = 0;
+      for (size_t b = 0; b < 256; b++) {
+         bucketStart[b] = offset;
+         for (auto& morselOffsets : offsets) {
+            size_t count = morselOffsets[b];
+            morselOffsets[b] = offset;
+            offset += count;
+         }
+      }
+      bucketStart[256] = offset;
+      tbb::parallel_for(size_t(0), numMorsels, [&](size_t m) {
+         auto& morselOffsets = offsets[m];
+         for (size_t i = m * radixSortMorselSize; i < std::min(len, (m + 1) * radixSortMorselSize); i++) {
+            tmp[morselOffsets[(entries[i].key >> shift) & 0xff]++] = entries[i];
+         }
+      });
+      tbb::parallel_for(size_t(0), size_t(256), [&](size_t b) {
+         msbRadixSort(&tmp[bucketStart[b]], &entries[bucketStart[b]], bucketStart[b + 1] - bucketStart[b], byte - 1, compareFn);
+      });
+      sorted = tmp.data();
+   }
+   trace2.stop();
+   uint8_t* result = executionContext->getArena().allocate(typeSize * len);
+   tbb::parallel_for(tbb::blocked_range<size_t>(0ul, len), [&](tbb::blocked_range<size_t> range) {
+      for (size_t i = range.begin(); i < range.end(); i++) {
+         memcpy(result + (i * typeSize), sorted[i].ptr, typeSize);
+      }
    });
+   return Buffer{typeSize * len, result};
+}
+runtime::Buffer runtime::GrowingBuffer::asContinuous(runtime::ExecutionContext* executionContext) {
    size_t typeSize = values.getTypeSize();
    size_t len = values.getLen();
-   uint8_t* continuous = new uint8_t[typeSize * len];
-   executionContext->registerState({continuous, [](void* ptr) { delete[] reinterpret_cast<uint8_t*>(ptr); }});
-   for (size_t i = 0; i < len; i++) {
-      uint8_t* ptr = continuous + (i * typeSize);
-      memcpy(ptr, toSort[i], typeSize);
+   const auto& buffers = values.getBuffers();
+   std::vector<const runtime::Buffer*> nonEmpty;
+   for (const auto& buffer : buffers) {
+      if (buffer.numElements) {
+         nonEmpty.push_back(&buffer);
+      }
+   }
+   if (nonEmpty.size() == 1) {
+      //already continuous: the buffer stays owned by this GrowingBuffer
+      return Buffer{typeSize * len, nonEmpty[0]->ptr};
    }
+   uint8_t* continuous = executionContext->getArena().allocate(typeSize * len);
+   std::vector<size_t> offsets(nonEmpty.size());
+   for (size_t i = 0, offset = 0; i < nonEmpty.size(); i++) {
+      offsets[i] = offset;
+      offset += nonEmpty[i]->numElements * typeSize;
+   }
+   //copy whole chunks in parallel, large chunks are split into parts of ~1 MiB
+   constexpr size_t copyGrainSize = 1 << 20;
+   tbb::parallel_for(size_t(0), nonEmpty.size(), [&](size_t i) {
+      size_t bytes = nonEmpty[i]->numElements * typeSize;
+      tbb::parallel_for(tbb::blocked_range<size_t>(0ul, bytes, copyGrainSize), [&](tbb::blocked_range<size_t> range) {
+         memcpy(continuous + offsets[i] + range.begin(), nonEmpty[i]->ptr + range.begin(), range.size());
+      });
+   });
    return Buffer{typeSize * len, continuous};
 }
 void runtime::GrowingBuffer::destroy(GrowingBuffer* vec) {
@@ -114,9 +259,8 @@ runtime::BufferIterator* runtime::GrowingBuffer::createIterator() {
 }
 
 runtime::Buffer runtime::Buffer::createZeroed(runtime::ExecutionContext* executionContext, size_t bytes) {
-   auto* ptr = FixedSizedBuffer<uint8_t>::createZeroed(bytes);
-   executionContext->registerState({ptr, [bytes](void* ptr) { FixedSizedBuffer<uint8_t>::deallocate((uint8_t*) ptr, bytes); }});
-   return Buffer{bytes, ptr};
+   //arena memory is always zeroed
+   return Buffer{bytes, executionContext->getArena().allocate(bytes)};
 }
 
 runtime::GrowingBufferAllocator* runtime::GrowingBufferAllocator::getDefaultAllocator() {
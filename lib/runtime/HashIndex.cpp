@@ -2,14 +2,21 @@
 
 #include "execution/Execution.h"
 #include "runtime/helpers.h"
+#include "utility/Tracer.h"
 
+#include <atomic>
 #include <filesystem>
+#include <fstream>
 
 #include <arrow/api.h>
 #include <arrow/array/array_primitive.h>
 #include <arrow/io/api.h>
 #include <arrow/ipc/api.h>
+#include <oneapi/tbb.h>
 namespace {
+static utility::Tracer::Event buildEvent("HashIndex", "build");
+static utility::Tracer::Event computeHashesEvent("HashIndex", "computeHashes");
+const std::string rowIdColumn = "__row_id";
 uint64_t nextPow2(uint64_t v) {
    v--;
    v |= v >> 1;
@@ -21,115 +28,250 @@ uint64_t nextPow2(uint64_t v) {
    v++;
    return v;
 }
+// hash files contain the raw hash values of all rows: new hashes can be appended
+void writeHashes(std::string file, const std::vector<std::shared_ptr<arrow::Int64Array>>& hashes, bool append) {
+   std::ofstream out(file, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+   for (const auto& h : hashes) {
+      out.write(reinterpret_cast<const char*>(h->raw_values()), h->length() * sizeof(int64_t));
+   }
+   out.close();
+   if (!out) {
+      throw std::runtime_error("HashIndex: could not write hashes");
+   }
+}
+std::shared_ptr<arrow::Int64Array> loadHashes(std::string file) {
+   auto inputFile = arrow::io::MemoryMappedFile::Open(file, arrow::io::FileMode::READ).ValueOrDie();
+   auto size = inputFile->GetSize().ValueOrDie();
+   auto buffer = inputFile->ReadAt(0, size).ValueOrDie();
+   return std::make_shared<arrow::Int64Array>(size / sizeof(int64_t), buffer);
+}
 } //end namespace
 namespace runtime {
 
-void HashIndex::build() {
-   size_t numRows = table->num_rows();
-   arrow::TableBatchReader reader(table);
+HashIndex::Buckets::Buckets(size_t size) : ht(FixedSizedBuffer<Entry*>::createZeroed(size)), mask(size - 1) {}
+HashIndex::Buckets::~Buckets() {
+   FixedSizedBuffer<Entry*>::deallocate(ht, mask + 1);
+}
+void HashIndex::link(Buckets& buckets, Entry* entry) {
+   std::atomic_ref<Entry*> slot(buckets.ht[entry->hash & buckets.mask]);
+   Entry* current = slot.load();
+   do {
+      entry->next = current;
+   } while (!slot.compare_exchange_weak(current, entry));
+}
+std::shared_ptr<HashIndex::Buckets> HashIndex::resize(const std::shared_ptr<Buckets>& buckets, size_t requiredEntries) {
+   size_t htSize = std::max(nextPow2(requiredEntries), 1ul);
+   if (buckets && htSize <= static_cast<size_t>(buckets->mask + 1)) {
+      return buckets;
+   }
+   auto resized = std::make_shared<Buckets>(htSize);
+   if (!buckets) {
+      return resized;
+   }
+   // lookups of older versions may still traverse the chains of the current buckets: the entries are copied before they are rehashed
+   for (auto& [chunk, chunkSize] : buckets->entryChunks) {
+      Entry* copy = new Entry[chunkSize];
+      resized->entryChunks.push_back({std::unique_ptr<Entry[]>(copy), chunkSize});
+      tbb::parallel_for(tbb::blocked_range<size_t>(0, chunkSize), [&, chunk = chunk.get()](const tbb::blocked_range<size_t>& range) {
+         for (size_t i = range.begin(); i != range.end(); i++) {
+            copy[i] = chunk[i];
+            link(*resized, &copy[i]);
+         }
+      });
+   }
+   return resized;
+}
+void HashIndex::insert(std::shared_ptr<arrow::Table> rows, std::shared_ptr<arrow::Int64Array> hashes) {
+   utility::Tracer::Trace trace(buildEvent);
+   auto previous = getVersion();
+   auto next = previous ? std::make_shared<Version>(*previous) : std::make_shared<Version>();
+   size_t numRows = rows->num_rows();
+   arrow::TableBatchReader reader(rows);
    std::shared_ptr<arrow::RecordBatch> recordBatch;
-   size_t htSize = nextPow2(numRows);
-   ht = FixedSizedBuffer<Entry*>::createZeroed(htSize);
-   mask = htSize - 1;
-   auto hashValues = std::static_pointer_cast<arrow::Int64Array>(hashData);
+   // save necessary data about record batches in table
+   size_t firstRecordBatch = next->recordBatches.size();
+   std::vector<size_t> batchOffsets;
    size_t totalOffset = 0;
    while (reader.ReadNext(&recordBatch).ok() && recordBatch) {
-      // save necessary data about record batches in table
-      size_t currRecordBatch = recordBatches.size();
-      recordBatches.push_back(recordBatch);
-
-      // iterate over tuples in record batch and insert into index
-      for (int additionalOffset = 0; additionalOffset != recordBatch->num_rows(); ++additionalOffset) {
-         int64_t hashValue = hashValues->Value(totalOffset);
-         Entry*& pos = ht[hashValue & mask];
-         Entry* newEntry = (Entry*) buffer.insert();
-         newEntry->next = pos;
-         pos = newEntry;
-         newEntry->hash = hashValue;
-         newEntry->recordBatch = currRecordBatch;
-         newEntry->offset = additionalOffset;
-         totalOffset++;
-      }
+      next->recordBatches.push_back(recordBatch);
+      batchOffsets.push_back(totalOffset);
+      totalOffset += recordBatch->num_rows();
    }
+   next->table = previous ? arrow::ConcatenateTables({previous->table, rows}).ValueOrDie() : rows;
+   next->buckets = resize(next->buckets, numEntries + numRows);
+   auto& buckets = *next->buckets;
+   Entry* entries = new Entry[numRows];
+   buckets.entryChunks.push_back({std::unique_ptr<Entry[]>(entries), numRows});
+   // insert all tuples in parallel: every entry is prepended to its chain with a CAS
+   tbb::parallel_for(size_t(0), batchOffsets.size(), [&](size_t batch) {
+      size_t currRecordBatch = firstRecordBatch + batch;
+      tbb::parallel_for(tbb::blocked_range<int64_t>(0, next->recordBatches[currRecordBatch]->num_rows()), [&](const tbb::blocked_range<int64_t>& range) {
+         for (int64_t additionalOffset = range.begin(); additionalOffset != range.end(); ++additionalOffset) {
+            size_t row = batchOffsets[batch] + additionalOffset;
+            Entry* newEntry = &entries[row];
+            newEntry->hash = hashes->Value(row);
+            newEntry->recordBatch = currRecordBatch;
+            newEntry->offset = additionalOffset;
+            link(buckets, newEntry);
+         }
+      });
+   });
+   numEntries += numRows;
+   hashData.push_back(hashes);
+   std::lock_guard<std::mutex> lock(versionMutex);
+   current = next;
+}
+std::shared_ptr<const HashIndex::Version> HashIndex::getVersion() {
+   std::lock_guard<std::mutex> lock(versionMutex);
+   return current;
+}
+std::string HashIndex::getHashFile() {
+   return dbDir + "/" + relation.getName() + "." + name + ".hashes";
 }
 void HashIndex::flush() {
-   if (persist) {
-      auto dataFile = dbDir + "/" + relation.getName() + "." + name + ".arrow";
-      auto schema = std::make_shared<arrow::Schema>(arrow::FieldVector{std::make_shared<arrow::Field>("hash", arrow::int64(), false)});
-      auto batch = arrow::RecordBatch::Make(schema, hashData->length(), {hashData});
-      auto inputFile = arrow::io::FileOutputStream::Open(dataFile).ValueOrDie();
-      auto batchWriter = arrow::ipc::MakeFileWriter(inputFile, schema).ValueOrDie();
-      if (!batchWriter->WriteRecordBatch(*batch).ok() || !batchWriter->Close().ok() || !inputFile->Close().ok()) {
-         throw std::runtime_error("HashIndex: could not write record batch");
+   if (persist && loaded) {
+      auto hashFile = getHashFile();
+      // nothing to do if the hash file is up to date (it is only ever appended to)
+      if (std::filesystem::exists(hashFile) && std::filesystem::file_size(hashFile) == numEntries * sizeof(int64_t)) {
+         return;
       }
+      // write to a temporary file first: the current hash file may still be memory-mapped
+      auto tmpFile = hashFile + ".tmp";
+      writeHashes(tmpFile, hashData, false);
+      std::filesystem::rename(tmpFile, hashFile);
    }
 }
 void HashIndex::setPersist(bool value) {
    Index::setPersist(value);
    flush();
 }
-void HashIndex::computeHashes() {
-   if (table->num_rows() == 0) {
-      hashData = arrow::MakeEmptyArray(arrow::int64()).ValueOrDie();
-   } else {
-      std::string query = "select hash(";
-      for (auto c : indexedColumns) {
-         if (!query.ends_with("(")) {
-            query += ",";
-         }
-         query += c;
+std::shared_ptr<arrow::Int64Array> HashIndex::computeHashes(std::shared_ptr<arrow::Table> rows) {
+   utility::Tracer::Trace trace(computeHashesEvent);
+   size_t numRows = rows->num_rows();
+   if (numRows == 0) {
+      return std::static_pointer_cast<arrow::Int64Array>(arrow::MakeEmptyArray(arrow::int64()).ValueOrDie());
+   }
+   // hashes are computed by a query (same hash function as generated code for lookups)
+   // the query is executed in parallel: the row id of every hash is part of the result
+   std::string query = "select hash(";
+   for (auto c : indexedColumns) {
+      if (!query.ends_with("(")) {
+         query += ",";
+      }
+      query += c;
+   }
+   query += "), " + rowIdColumn + " from tmp";
+   auto rowIdBuffer = arrow::AllocateBuffer(numRows * sizeof(int64_t)).ValueOrDie();
+   auto* rowIds = reinterpret_cast<int64_t*>(rowIdBuffer->mutable_data());
+   tbb::parallel_for(tbb::blocked_range<size_t>(0, numRows), [&](const tbb::blocked_range<size_t>& range) {
+      for (size_t i = range.begin(); i != range.end(); i++) {
+         rowIds[i] = i;
       }
-      query += ") from tmp";
-      auto tmpSession = Session::createSession();
-      tmpSession->getCatalog()->addTable("tmp", relation.getMetaData());
-      tmpSession->getCatalog()->findRelation("tmp")->append(table);
-      auto queryExecutionConfig = execution::createQueryExecutionConfig(execution::ExecutionMode::SPEED, true);
-      queryExecutionConfig->parallel = false;
-      std::shared_ptr<arrow::Table> result;
-      queryExecutionConfig->resultProcessor = execution::createTableRetriever(result);
+   });
+   auto rowIdArray = std::make_shared<arrow::Int64Array>(numRows, std::move(rowIdBuffer));
+   // only the indexed columns are copied into the temporary table
+   std::vector<int> keyColumnIds;
+   auto tmpMetaData = std::make_shared<TableMetaData>();
+   for (const auto& c : indexedColumns) {
+      keyColumnIds.push_back(rows->schema()->GetFieldIndex(c));
+      tmpMetaData->addColumn(c, relation.getMetaData()->getColumnMetaData(c));
+   }
+   auto keyRows = rows->SelectColumns(keyColumnIds).ValueOrDie();
+   auto tmpTable = keyRows->AddColumn(keyRows->num_columns(), arrow::field(rowIdColumn, arrow::int64(), false), std::make_shared<arrow::ChunkedArray>(rowIdArray)).ValueOrDie();
+   auto rowIdMetaData = std::make_shared<ColumnMetaData>();
+   rowIdMetaData->setColumnType(ColumnType{"int", false, {64ull}});
+   tmpMetaData->addColumn(rowIdColumn, rowIdMetaData);
+
+   auto tmpSession = Session::createSession();
+   tmpSession->getCatalog()->addTable("tmp", tmpMetaData);
+   tmpSession->getCatalog()->findRelation("tmp")->append(tmpTable);
+   auto queryExecutionConfig = execution::createQueryExecutionConfig(execution::ExecutionMode::SPEED, true);
+   std::shared_ptr<arrow::Table> result;
+   queryExecutionConfig->resultProcessor = execution::createTableRetriever(result);
 
-      auto executer = execution::QueryExecuter::createDefaultExecuter(std::move(queryExecutionConfig), *tmpSession);
-      executer->fromData(query);
-      executer->execute();
-      result = result->CombineChunks().ValueOrDie();
-      hashData = result->column(0)->chunk(0);
+   auto executer = execution::QueryExecuter::createDefaultExecuter(std::move(queryExecutionConfig), *tmpSession);
+   executer->fromData(query);
+   executer->execute();
+
+   // scatter the hashes to the positions of their rows
+   auto hashBuffer = arrow::AllocateBuffer(numRows * sizeof(int64_t)).ValueOrDie();
+   auto* hashes = reinterpret_cast<int64_t*>(hashBuffer->mutable_data());
+   std::vector<std::pair<std::shared_ptr<arrow::Int64Array>, std::shared_ptr<arrow::Int64Array>>> resultChunks;
+   for (int i = 0; i < result->column(0)->num_chunks(); i++) {
+      resultChunks.push_back({std::static_pointer_cast<arrow::Int64Array>(result->column(0)->chunk(i)), std::static_pointer_cast<arrow::Int64Array>(result->column(1)->chunk(i))});
    }
+   tbb::parallel_for_each(resultChunks.begin(), resultChunks.end(), [&](const auto& chunk) {
+      for (int64_t i = 0; i < chunk.first->length(); i++) {
+         hashes[chunk.second->Value(i)] = chunk.first->Value(i);
+      }
+   });
+   return std::make_shared<arrow::Int64Array>(numRows, std::move(hashBuffer));
 }
 void HashIndex::ensureLoaded() {
-   auto dataFile = dbDir + "/" + relation.getName() + "." + name + ".arrow";
-   table = relation.getTable();
-   if (std::filesystem::exists(dataFile)) {
-      auto inputFile = arrow::io::ReadableFile::Open(dataFile).ValueOrDie();
+   if (loaded) {
+      return;
+   }
+   std::lock_guard<std::mutex> lock(loadMutex);
+   if (loaded) {
+      return;
+   }
+   auto hashFile = getHashFile();
+   auto legacyHashFile = dbDir + "/" + relation.getName() + "." + name + ".arrow";
+   auto table = relation.getTable();
+   std::shared_ptr<arrow::Int64Array> hashes;
+   if (std::filesystem::exists(hashFile)) {
+      hashes = loadHashes(hashFile);
+   } else if (std::filesystem::exists(legacyHashFile)) {
+      auto inputFile = arrow::io::MemoryMappedFile::Open(legacyHashFile, arrow::io::FileMode::READ).ValueOrDie();
       auto batchReader = arrow::ipc::RecordBatchFileReader::Open(inputFile).ValueOrDie();
       assert(batchReader->num_record_batches() == 1);
       auto batch = batchReader->ReadRecordBatch(0).ValueOrDie();
-      hashData = batch->column(0);
-   } else {
-      computeHashes();
+      hashes = std::static_pointer_cast<arrow::Int64Array>(batch->column(0));
+   }
+   // stored hashes are only valid if they cover exactly the rows of the table (e.g. not after an interrupted append)
+   bool recomputed = !hashes || hashes->length() != table->num_rows();
+   if (recomputed) {
+      hashes = computeHashes(table);
+   }
+   insert(table, hashes);
+   loaded = true;
+   if (recomputed) {
+      flush();
    }
-   build();
 }
 void HashIndex::appendRows(std::shared_ptr<arrow::Table> toAppend) {
-   std::vector<std::shared_ptr<arrow::RecordBatch>> newTableBatches;
-
-   if (table->num_rows() != 0) {
-      newTableBatches.push_back(table->CombineChunksToBatch().ValueOrDie());
+   if (toAppend->num_rows() == 0) {
+      return;
+   }
+   // only the new rows are hashed and inserted
+   auto hashes = computeHashes(toAppend);
+   std::lock_guard<std::mutex> lock(loadMutex);
+   // an index that was loaded after the rows were appended to the relation already contains them
+   if (loaded && getVersion()->table->num_rows() + toAppend->num_rows() == relation.getTable()->num_rows()) {
+      insert(toAppend, hashes);
+   }
+   if (persist) {
+      auto hashFile = getHashFile();
+      size_t previousRows = relation.getTable()->num_rows() - toAppend->num_rows();
+      if (std::filesystem::exists(hashFile) && std::filesystem::file_size(hashFile) == previousRows * sizeof(int64_t)) {
+         writeHashes(hashFile, {hashes}, true);
+      } else {
+         // if the index is not loaded, the hashes are recomputed when it is loaded the next time
+         flush();
+      }
    }
-   newTableBatches.push_back(toAppend->CombineChunksToBatch().ValueOrDie());
-   table = arrow::Table::FromRecordBatches(newTableBatches).ValueOrDie();
-   computeHashes();
-   build();
-   flush();
 }
 HashIndexIteration* HashIndexAccess::lookup(size_t hash) {
-   return new HashIndexIteration(*this, hash, hashIndex.ht[hash & hashIndex.mask]);
+   auto& buckets = *version->buckets;
+   return new HashIndexIteration(*this, hash, std::atomic_ref<HashIndex::Entry*>(buckets.ht[hash & buckets.mask]).load());
 }
 void HashIndexIteration::close(runtime::HashIndexIteration* iteration) {
    delete iteration;
 }
 bool HashIndexIteration::hasNext() {
    while (current) {
-      if (current->hash == hash) {
+      // entries of rows appended after the lookup started are not visible
+      if (current->hash == hash && current->recordBatch < access.version->recordBatches.size()) {
          return true;
       }
       current = current->next;
@@ -144,10 +286,13 @@ void HashIndexIteration::consumeRecordBatch(runtime::RecordBatchInfo* info) {
    }
    current = current->next;
 }
-HashIndexAccess::HashIndexAccess(runtime::HashIndex& hashIndex, std::vector<std::string> cols) : hashIndex(hashIndex) {
+HashIndexAccess::HashIndexAccess(runtime::HashIndex& hashIndex, std::vector<std::string> cols) : version(hashIndex.getVersion()) {
+   if (!version) {
+      throw std::runtime_error("HashIndex: index is not loaded");
+   }
    // Find column ids for relevant columns
    for (auto columnToMap : cols) {
-      auto columnNames = hashIndex.table->ColumnNames();
+      auto columnNames = version->table->ColumnNames();
       size_t columnId = 0;
       bool found = false;
       for (auto column : columnNames) {
@@ -165,22 +310,13 @@ HashIndexAccess::HashIndexAccess(runtime::HashIndex& hashIndex, std::vector<std:
    infoSize = sizeof(size_t) + colIds.size() * sizeof(ColumnInfo);
 
    // Prepare RecordBatchInfo for each record batch to facilitate computation for individual tuples at runtime
-   for (auto& recordBatchPtr : hashIndex.recordBatches) {
+   for (auto& recordBatchPtr : version->recordBatches) {
       RecordBatchInfo* recordBatchInfo = static_cast<RecordBatchInfo*>(malloc(infoSize));
       recordBatchInfo->numRows = 1;
       for (size_t i = 0; i != colIds.size(); ++i) {
          auto colId = colIds[i];
-         ColumnInfo& colInfo = recordBatchInfo->columnInfo[i];
          // Base offset for record batch, will need to add individual tuple offset in record batch
-         colInfo.offset = recordBatchPtr->column_data(colId)->offset;
-         // Facilitates handling of null values
-         colInfo.validMultiplier = recordBatchPtr->column_data(colId)->buffers[0] ? 1 : 0;
-         // Compact representation of null values (inversed)
-         colInfo.validBuffer = RecordBatchInfo::getBuffer(recordBatchPtr.get(), colId, 0);
-         // Pointer to fixed size data for column
-         colInfo.dataBuffer = RecordBatchInfo::getBuffer(recordBatchPtr.get(), colId, 1);
-         // Pointer to variable length data for column
-         colInfo.varLenBuffer = RecordBatchInfo::getBuffer(recordBatchPtr.get(), colId, 2);
+         RecordBatchInfo::initColumnInfo(recordBatchInfo->columnInfo[i], recordBatchPtr.get(), colId);
       }
       recordBatchInfos.push_back(recordBatchInfo);
    }
@@ -1,7 +1,7 @@
 #include "runtime/HashMultiMap.h"
 
 runtime::HashMultiMap* runtime::HashMultiMap::create(runtime::ExecutionContext* executionContext,size_t entryTypeSize, size_t valueTypeSize, size_t initialCapacity) {
-   auto* hmm= new HashMultiMap(initialCapacity, entryTypeSize, valueTypeSize);
+   auto* hmm= new HashMultiMap(initialCapacity, entryTypeSize, valueTypeSize, &executionContext->getArena());
    executionContext->registerState({hmm, [](void* ptr) { delete reinterpret_cast<runtime::HashMultiMap*>(ptr); }});
    return hmm;
 }
@@ -1,11 +1,15 @@
 #include "runtime/Hashtable.h"
 #include "utility/Tracer.h"
 #include <iostream>
+#include <mutex>
 namespace {
 static utility::Tracer::Event mergeEvent("Hashtable", "merge");
+static utility::Tracer::Event mergePartitionEvent("Hashtable", "mergePartition");
+//the merged hash table is split into 2^6 ranges of buckets that are merged in parallel
+constexpr size_t mergePartitionBits = 6;
 } // end namespace
 runtime::Hashtable* runtime::Hashtable::create(runtime::ExecutionContext* executionContext, size_t typeSize, size_t initialCapacity) {
-   auto* ht = new Hashtable(initialCapacity, typeSize);
+   auto* ht = new Hashtable(initialCapacity, typeSize, &executionContext->getArena());
    executionContext->registerState({ht, [](void* ptr) { delete reinterpret_cast<runtime::Hashtable*>(ptr); }});
    return ht;
 }
@@ -42,17 +46,78 @@ runtime::BufferIterator* runtime::Hashtable::createIterator() {
    return values.createIterator();
 }
 
+void runtime::Hashtable::link(Entry* entry) {
+   auto pos = entry->hashValue & hashMask;
+   auto* previousPtr = ht.at(pos);
+   ht.at(pos) = runtime::tag(entry, previousPtr, entry->hashValue);
+   entry->next = runtime::untag(previousPtr);
+}
 runtime::Hashtable* runtime::Hashtable::merge(runtime::ThreadLocal* threadLocal, bool (*isEq)(uint8_t*, uint8_t*), void (*merge)(uint8_t*, uint8_t*)) {
    utility::Tracer::Trace mergeHt(mergeEvent);
-   runtime::Hashtable* first = nullptr;
+   std::vector<runtime::Hashtable*> tables;
+   size_t totalEntries = 0;
    for (auto* ptr : threadLocal->getTls()) {
       auto* current = reinterpret_cast<runtime::Hashtable*>(ptr);
-      if (!first) {
-         first = current;
-      } else {
-         first->mergeEntries(isEq, merge, current);
-      }
+      tables.push_back(current);
+      totalEntries += current->values.getLen();
+   }
+   auto* first = tables[0];
+   if (tables.size() == 1) {
+      return first;
    }
+   //the first table becomes the result: its hash table is rebuilt with a size suitable for all entries
+   size_t htSize = first->hashMask + 1;
+   while (htSize < totalEntries * 2) {
+      htSize *= 2;
+   }
+   size_t htBits = __builtin_ctzll(htSize);
+   size_t partitionBits = std::min(htBits, mergePartitionBits);
+   size_t numPartitions = 1ull << partitionBits;
+   size_t partitionShift = htBits - partitionBits;
+   first->ht.setNewSize(htSize);
+   first->hashMask = htSize - 1;
+
+   //1. collect the entries of every table by partition
+   std::vector<std::vector<std::vector<Entry*>>> partitioned(tables.size(), std::vector<std::vector<Entry*>>(numPartitions));
+   tbb::parallel_for(size_t(0), tables.size(), [&](size_t t) {
+      tables[t]->values.iterate([&](uint8_t* entryRawPtr) {
+         auto* entry = (Entry*) entryRawPtr;
+         partitioned[t][(entry->hashValue & first->hashMask) >> partitionShift].push_back(entry);
+      });
+   });
+   //2. merge every partition: each partition owns a disjoint range of buckets, no synchronization required
+   std::mutex mutex;
+   tbb::parallel_for(size_t(0), numPartitions, [&](size_t p) {
+      utility::Tracer::Trace trace(mergePartitionEvent);
+      runtime::FlexibleBuffer localValues(1, first->typeSize, first->values.getArena());
+      //entries of the first table are already distinct and stored in its values
+      for (auto* entry : partitioned[0][p]) {
+         first->link(entry);
+      }
+      for (size_t t = 1; t < tables.size(); t++) {
+         for (auto* otherEntry : partitioned[t][p]) {
+            auto otherHash = otherEntry->hashValue;
+            auto* candidate = runtime::filterTagged(first->ht.at(otherHash & first->hashMask), otherHash);
+            bool matchFound = false;
+            while (candidate) {
+               if (candidate->hashValue == otherHash && isEq(candidate->content, otherEntry->content)) {
+                  merge(candidate->content, otherEntry->content);
+                  matchFound = true;
+                  break;
+               }
+               candidate = candidate->next;
+            }
+            if (!matchFound) {
+               auto* newEntry = (Entry*) localValues.insert();
+               std::memcpy(newEntry, otherEntry, first->typeSize);
+               first->link(newEntry);
+            }
+         }
+      }
+      trace.stop();
+      std::unique_lock<std::mutex> lock(mutex);
+      first->values.merge(localValues);
+   });
    return first;
 }
 void runtime::Hashtable::mergeEntries(bool (*isEq)(uint8_t*, uint8_t*), void (*merge)(uint8_t*, uint8_t*), runtime::Hashtable* other) {
@@ -61,14 +61,19 @@ void runtime::Heap::destroy(Heap* h) {
 
 runtime::Heap* runtime::Heap::merge(runtime::ThreadLocal* threadLocal) {
    utility::Tracer::Trace trace(mergeHeapEvent);
-   Heap* first = nullptr;
+   std::vector<Heap*> heaps;
    for (auto* ptr : threadLocal->getTls()) {
-      auto* current = reinterpret_cast<Heap*>(ptr);
-      if (!first) {
-         first = current;
-      } else {
-         first->mergeWithOther(current);
-      }
+      heaps.push_back(reinterpret_cast<Heap*>(ptr));
+   }
+   //tree reduction: pairs of heaps are merged in parallel
+   for (size_t stride = 1; stride < heaps.size(); stride *= 2) {
+      tbb::parallel_for(size_t(0), (heaps.size() + 2 * stride - 1) / (2 * stride), [&](size_t i) {
+         size_t left = i * 2 * stride;
+         size_t right = left + stride;
+         if (right < heaps.size()) {
+            heaps[left]->mergeWithOther(heaps[right]);
+         }
+      });
    }
-   return first;
+   return heaps[0];
 }
\ No newline at end of file
@@ -5,19 +5,35 @@
 #include <atomic>
 #include <iostream>
 
+#include <tbb/parallel_for.h>
+
 namespace {
 static utility::Tracer::Event buildEvent("HashIndexedView", "build");
+static utility::Tracer::Event buildPartitionedEvent("HashIndexedView", "buildPartitioned");
+//2^15 buckets (256 KiB) per partition fit into L2
+constexpr size_t bucketBitsPerPartition = 15;
+//limit the fan-out of the partitioning pass to keep the number of open partitions TLB-friendly
+constexpr size_t maxPartitionBits = 10;
+constexpr size_t morselSize = 20000;
+//~8 bits per entry, hashes provide at most 26 bits for the word position
+constexpr size_t maxFilterBits = 26;
 } // end namespace
 runtime::HashIndexedView* runtime::HashIndexedView::build(runtime::ExecutionContext* executionContext, runtime::GrowingBuffer* buffer) {
    utility::Tracer::Trace trace(buildEvent);
    auto& values = buffer->getValues();
    size_t htSize = std::max(nextPow2(values.getLen() * 1.25), 1ul);
+   //hash tables exceeding the cache would take a cache miss for every inserted entry
+   if (static_cast<size_t>(__builtin_ctzll(htSize)) > bucketBitsPerPartition) {
+      trace.stop();
+      return buildPartitioned(executionContext, buffer, htSize);
+   }
    size_t htMask = htSize - 1;
-   auto* htView = new HashIndexedView(htSize, htMask);
+   auto* htView = new HashIndexedView(executionContext->getArena(), htSize, htMask, filterSize(values.getLen()));
    executionContext->registerState({htView, [](void* ptr) { delete reinterpret_cast<runtime::HashIndexedView*>(ptr); }});
    values.iterateParallel([&](uint8_t* ptr) {
       auto* entry = (Entry*) ptr;
       size_t hash = (size_t) entry->hashValue;
+      htView->addToFilter(hash);
       auto pos = hash & htMask;
       std::atomic_ref<Entry*> slot(htView->ht[pos]);
       Entry* current = slot.load();
@@ -30,10 +46,80 @@ runtime::HashIndexedView* runtime::HashIndexedView::build(runtime::ExecutionCont
    trace.stop();
    return htView;
 }
+runtime::HashIndexedView* runtime::HashIndexedView::buildPartitioned(runtime::ExecutionContext* executionContext, runtime::GrowingBuffer* buffer, size_t htSize) {
+   auto& values = buffer->getValues();
+   size_t numValues = values.getLen();
+   size_t htBits = __builtin_ctzll(htSize);
+   utility::Tracer::Trace trace(buildPartitionedEvent);
+   executionContext->count("partitioned hash table builds");
+   size_t htMask = htSize - 1;
+   auto* htView = new HashIndexedView(executionContext->getArena(), htSize, htMask, filterSize(numValues));
+   executionContext->registerState({htView, [](void* ptr) { delete reinterpret_cast<runtime::HashIndexedView*>(ptr); }});
+   size_t partitionBits = std::min(htBits - bucketBitsPerPartition, maxPartitionBits);
+   size_t numPartitions = 1ull << partitionBits;
+   size_t partitionShift = htBits - partitionBits;
+   size_t typeSize = values.getTypeSize();
+
+   std::vector<runtime::Buffer> morsels;
+   for (auto chunk : values.getBuffers()) {
+      for (size_t i = 0; i < chunk.numElements; i += morselSize) {
+         morsels.push_back({std::min(morselSize, chunk.numElements - i), chunk.ptr + i * typeSize});
+      }
+   }
+   //1. histogram of every morsel
+   std::vector<std::vector<size_t>> offsets(morsels.size(), std::vector<size_t>(numPartitions, 0));
+   tbb::parallel_for(size_t(0), morsels.size(), [&](size_t m) {
+      auto& histogram = offsets[m];
+      for (size_t i = 0; i < morsels[m].numElements; i++) {
+         auto* entry = (Entry*) &morsels[m].ptr[i * typeSize];
+         histogram[(entry->hashValue & htMask) >> partitionShift]++;
+      }
+   });
+   //2. prefix sum: every morsel writes to its own range of every partition
+   std::vector<size_t> partitionStart(numPartitions + 1, 0);
+   size_t currentOffset = 0;
+   for (size_t p = 0; p < numPartitions; p++) {
+      partitionStart[p] = currentOffset;
+      for (auto& morselOffsets : offsets) {
+         size_t count = morselOffsets[p];
+         morselOffsets[p] = currentOffset;
+         currentOffset += count;
+      }
+   }
+   partitionStart[numPartitions] = currentOffset;
+   //3. scatter entry pointers into their partitions
+   std::vector<Entry*> partitioned(numValues);
+   tbb::parallel_for(size_t(0), morsels.size(), [&](size_t m) {
+      auto& morselOffsets = offsets[m];
+      for (size_t i = 0; i < morsels[m].numElements; i++) {
+         auto* entry = (Entry*) &morsels[m].ptr[i * typeSize];
+         partitioned[morselOffsets[(entry->hashValue & htMask) >> partitionShift]++] = entry;
+      }
+   });
+   //4. build every partition: each partition owns a disjoint range of buckets, no synchronization required
+   tbb::parallel_for(size_t(0), numPartitions, [&](size_t p) {
+      for (size_t i = partitionStart[p]; i < partitionStart[p + 1]; i++) {
+         auto* entry = partitioned[i];
+         size_t hash = (size_t) entry->hashValue;
+         auto pos = hash & htMask;
+         htView->addToFilter(hash);
+         Entry* current = htView->ht[pos];
+         entry->next = current;
+         htView->ht[pos] = runtime::tag(entry, current, hash);
+      }
+   });
+   trace.stop();
+   return htView;
+}
 void runtime::HashIndexedView::destroy(runtime::HashIndexedView* ht) {
    delete ht;
 }
-runtime::HashIndexedView::HashIndexedView(size_t htSize, size_t htMask) : ht(runtime::FixedSizedBuffer<Entry*>::createZeroed(htSize)), htMask(htMask) {}
-runtime::HashIndexedView::~HashIndexedView() {
-   runtime::FixedSizedBuffer<Entry*>::deallocate(ht, htMask + 1);
+size_t runtime::HashIndexedView::filterSize(size_t numValues) {
+   return std::min(std::max(nextPow2(numValues / 8), 1ul), 1ul << maxFilterBits);
+}
+void runtime::HashIndexedView::addToFilter(uint64_t hash) {
+   std::atomic_ref<uint64_t> word(filter[filterPos(hash, filterMask)]);
+   word.fetch_or(filterBits(hash), std::memory_order_relaxed);
 }
+//hash table and filter are allocated from the arena: pages are first touched (and therefore placed) by the threads building the view
+runtime::HashIndexedView::HashIndexedView(runtime::Arena& arena, size_t htSize, size_t htMask, size_t filterSize) : ht(reinterpret_cast<Entry**>(arena.allocate(htSize * sizeof(Entry*)))), htMask(htMask), filter(reinterpret_cast<uint64_t*>(arena.allocate(filterSize * sizeof(uint64_t)))), filterMask(filterSize - 1) {}
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 #include <regex>
 
@@ -41,12 +42,45 @@ std::shared_ptr<arrow::RecordBatch> deserializeRecordBatch(std::string str) {
    }
    return batch;
 }
+std::shared_ptr<runtime::ColumnStatistics> deserializeStatistics(const nlohmann::json& info) {
+   std::optional<runtime::HyperLogLog> hyperLogLog;
+   if (info.contains("hll")) {
+      auto bytes = hexToBytes(info["hll"].get<std::string>());
+      if (static_cast<size_t>(bytes->size()) == runtime::HyperLogLog::numRegisters) {
+         hyperLogLog = runtime::HyperLogLog(std::vector<uint8_t>(bytes->data(), bytes->data() + bytes->size()));
+      }
+   }
+   std::optional<runtime::Histogram> histogram;
+   if (info.contains("histogram")) {
+      histogram = runtime::Histogram();
+      histogram->bounds = info["histogram"]["bounds"].get<std::vector<double>>();
+      histogram->counts = info["histogram"]["counts"].get<std::vector<double>>();
+   }
+   return std::make_shared<runtime::ColumnStatistics>(info["rows"].get<size_t>(), hyperLogLog, histogram);
+}
+nlohmann::json::object_t serializeStatistics(const runtime::ColumnStatistics& statistics) {
+   nlohmann::json::object_t res;
+   res["rows"] = statistics.getRows();
+   if (statistics.getHyperLogLog()) {
+      const auto& registers = statistics.getHyperLogLog()->getRegisters();
+      res["hll"] = arrow::Buffer(registers.data(), registers.size()).ToHexString();
+   }
+   if (statistics.getHistogram()) {
+      res["histogram"] = nlohmann::json::object_t();
+      res["histogram"]["bounds"] = statistics.getHistogram()->bounds;
+      res["histogram"]["counts"] = statistics.getHistogram()->counts;
+   }
+   return res;
+}
 } // end namespace
 std::shared_ptr<runtime::ColumnMetaData> createColumnMetaData(const nlohmann::json& info) {
    auto res = std::make_shared<runtime::ColumnMetaData>();
    if (info.contains("distinct_values")) {
       res->setDistinctValues(info["distinct_values"].get<size_t>());
    }
+   if (info.contains("statistics")) {
+      res->setStatistics(deserializeStatistics(info["statistics"]));
+   }
    if (info.contains("type")) {
       runtime::ColumnType columnType;
       const nlohmann::json& typeInfo = info["type"];
@@ -121,6 +155,9 @@ nlohmann::json::object_t serializeColumn(std::shared_ptr<runtime::ColumnMetaData
    if (column->getDistinctValues()) {
       res["distinct_values"] = column->getDistinctValues().value();
    }
+   if (column->getStatistics()) {
+      res["statistics"] = serializeStatistics(*column->getStatistics());
+   }
    auto columnType = column->getColumnType();
    res["type"] = nlohmann::json::object_t();
    res["type"]["base"] = columnType.base;
@@ -181,6 +218,9 @@ const std::optional<size_t>& runtime::ColumnMetaData::getDistinctValues() const
 void runtime::ColumnMetaData::setDistinctValues(const std::optional<size_t>& distinctValues) {
    ColumnMetaData::distinctValues = distinctValues;
 }
+bool runtime::ColumnType::isDictionaryEncoded() const {
+   return std::any_of(modifiers.begin(), modifiers.end(), [](const auto& m) { return std::holds_alternative<std::string>(m) && std::get<std::string>(m) == "dictionary"; });
+}
 const runtime::ColumnType& runtime::ColumnMetaData::getColumnType() const {
    return columnType;
 }
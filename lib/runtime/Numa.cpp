@@ -0,0 +1,185 @@
+#include "runtime/Numa.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <arrow/array.h>
+#include <arrow/record_batch.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+namespace {
+constexpr size_t pageSize = 4096;
+constexpr int mpolMfMove = 1 << 1; //MPOL_MF_MOVE
+//parses lists of the form "0-3,8,10-11"
+std::vector<size_t> parseList(const std::string& file) {
+   std::ifstream in(file);
+   std::string list;
+   std::vector<size_t> res;
+   if (!std::getline(in, list)) {
+      return res;
+   }
+   std::stringstream ss(list);
+   std::string range;
+   while (std::getline(ss, range, ',')) {
+      auto dash = range.find('-');
+      size_t first = std::stoull(range.substr(0, dash));
+      size_t last = dash == std::string::npos ? first : std::stoull(range.substr(dash + 1));
+      for (size_t i = first; i <= last; i++) {
+         res.push_back(i);
+      }
+   }
+   return res;
+}
+size_t detectNumNodes() {
+   if (const char* mode = std::getenv("LINGODB_NUMA")) {
+      if (std::string(mode) == "OFF") {
+         return 1;
+      }
+   }
+   auto nodes = parseList("/sys/devices/system/node/online");
+   return nodes.empty() ? 1 : nodes.back() + 1;
+}
+uintptr_t pageOf(const void* ptr) {
+   return reinterpret_cast<uintptr_t>(ptr) & ~(pageSize - 1);
+}
+void bindToNode(size_t node) {
+   auto cpus = parseList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+   if (cpus.empty()) return;
+   cpu_set_t set;
+   CPU_ZERO(&set);
+   for (auto cpu : cpus) {
+      CPU_SET(cpu, &set);
+   }
+   sched_setaffinity(0, sizeof(set), &set);
+}
+void placeRange(const uint8_t* begin, size_t bytes, size_t node) {
+   constexpr size_t pagesPerCall = 1024;
+   std::vector<void*> pages;
+   std::vector<int> nodes;
+   std::vector<int> status;
+   auto flush = [&]() {
+      if (pages.empty()) return;
+      nodes.assign(pages.size(), static_cast<int>(node));
+      status.resize(pages.size());
+      syscall(SYS_move_pages, 0, pages.size(), pages.data(), nodes.data(), status.data(), mpolMfMove);
+      pages.clear();
+   };
+   for (auto page = pageOf(begin); page < reinterpret_cast<uintptr_t>(begin + bytes); page += pageSize) {
+      //populates memory-mapped pages on the current node, pages that are already present are moved
+      [[maybe_unused]] volatile uint8_t touch = *reinterpret_cast<const uint8_t*>(std::max(page, reinterpret_cast<uintptr_t>(begin)));
+      pages.push_back(reinterpret_cast<void*>(page));
+      if (pages.size() == pagesPerCall) {
+         flush();
+      }
+   }
+   flush();
+}
+//memory ranges holding the rows of a (sliced) column: slices of the same table chunk share buffers
+void placeColumn(const arrow::ArrayData& data, size_t node) {
+   auto place = [&](size_t bufferId, size_t from, size_t to) {
+      if (data.buffers.size() > bufferId && data.buffers[bufferId] && to > from) {
+         placeRange(data.buffers[bufferId]->data() + from, std::min<size_t>(to, data.buffers[bufferId]->size()) - std::min<size_t>(from, data.buffers[bufferId]->size()), node);
+      }
+   };
+   size_t begin = data.offset;
+   size_t end = data.offset + data.length;
+   place(0, begin / 8, (end + 7) / 8);
+   if (data.type->id() == arrow::Type::STRING || data.type->id() == arrow::Type::BINARY) {
+      place(1, begin * sizeof(int32_t), (end + 1) * sizeof(int32_t));
+      const auto* offsets = data.GetValues<int32_t>(1, 0);
+      if (offsets && data.length > 0) {
+         place(2, offsets[begin], offsets[end]);
+      }
+   } else if (const auto* fixedWidthType = dynamic_cast<const arrow::FixedWidthType*>(data.type.get())) {
+      //for dictionaries: the indices (the dictionary is shared by all batches)
+      size_t bitWidth = fixedWidthType->bit_width();
+      place(1, begin * bitWidth / 8, (end * bitWidth + 7) / 8);
+   }
+}
+} // end namespace
+
+size_t runtime::Numa::getNumNodes() {
+   static size_t numNodes = detectNumNodes();
+   return numNodes;
+}
+size_t runtime::Numa::getCurrentNode() {
+   if (getNumNodes() == 1) return 0;
+   unsigned cpu = 0;
+   unsigned node = 0;
+   if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) {
+      return 0;
+   }
+   return node;
+}
+std::vector<size_t> runtime::Numa::getNodes(const std::vector<const void*>& addresses) {
+   std::vector<size_t> res(addresses.size(), getNumNodes());
+   if (getNumNodes() == 1) {
+      std::fill(res.begin(), res.end(), 0);
+      return res;
+   }
+   std::vector<void*> pages;
+   for (const auto* address : addresses) {
+      pages.push_back(reinterpret_cast<void*>(pageOf(address)));
+   }
+   std::vector<int> status(pages.size());
+   //without target nodes, move_pages only reports the current node of every page
+   if (syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr, status.data(), 0) != 0) {
+      return res;
+   }
+   for (size_t i = 0; i < status.size(); i++) {
+      if (status[i] >= 0 && static_cast<size_t>(status[i]) < getNumNodes()) {
+         res[i] = status[i];
+      }
+   }
+   return res;
+}
+void runtime::Numa::placeRecordBatches(const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches) {
+   if (batches.empty()) return;
+   std::vector<int> columnIds(batches[0]->num_columns());
+   std::iota(columnIds.begin(), columnIds.end(), 0);
+   placeColumns(batches, columnIds);
+}
+void runtime::Numa::placeColumns(const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches, const std::vector<int>& columnIds) {
+   size_t numNodes = getNumNodes();
+   if (numNodes == 1 || batches.size() < numNodes || columnIds.empty()) return;
+   std::vector<std::thread> threads;
+   for (size_t node = 0; node < numNodes; node++) {
+      threads.emplace_back([&batches, &columnIds, node, numNodes]() {
+         bindToNode(node);
+         for (size_t i = node * batches.size() / numNodes; i < (node + 1) * batches.size() / numNodes; i++) {
+            const auto& batch = batches[i];
+            for (auto c : columnIds) {
+               placeColumn(*batch->column_data(c), node);
+            }
+         }
+      });
+   }
+   for (auto& t : threads) {
+      t.join();
+   }
+}
+void runtime::Numa::placeAppendedRecordBatches(const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches, size_t first) {
+   size_t numNodes = getNumNodes();
+   if (numNodes == 1 || first >= batches.size()) return;
+   std::vector<std::thread> threads;
+   for (size_t node = 0; node < numNodes; node++) {
+      threads.emplace_back([&batches, first, node, numNodes]() {
+         bindToNode(node);
+         for (size_t i = first; i < batches.size(); i++) {
+            if (i % numNodes != node) continue;
+            for (int c = 0; c < batches[i]->num_columns(); c++) {
+               placeColumn(*batches[i]->column_data(c), node);
+            }
+         }
+      });
+   }
+   for (auto& t : threads) {
+      t.join();
+   }
+}
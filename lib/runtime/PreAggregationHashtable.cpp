@@ -1,6 +1,7 @@
 #include "runtime/PreAggregationHashtable.h"
 #include "runtime/helpers.h"
 #include "utility/Tracer.h"
+#include <cstring>
 #include <iostream>
 #include <oneapi/tbb.h>
 namespace {
@@ -9,12 +10,24 @@ static utility::Tracer::Event mergeEvent("Oht", "merge");
 static utility::Tracer::Event mergePartitionEvent("Oht", "mergePartition");
 static utility::Tracer::Event mergeAllocate("Oht", "mergeAlloc");
 static utility::Tracer::Event mergeDeallocate("Oht", "mergeDealloc");
+static utility::Tracer::Event spillEvent("OHtFragment", "spill");
+static utility::Tracer::Event mergeSpilledEvent("Oht", "mergeSpilled");
+//memory usage is accounted (and the budget checked) every 1024 inserted entries
+constexpr size_t accountingInterval = 1024;
+//number of spilled entries that are read back at once
+constexpr size_t spillChunkSize = 4096;
 
 } // end namespace
 runtime::PreAggregationHashtableFragment::Entry* runtime::PreAggregationHashtableFragment::insert(size_t hash) {
    constexpr size_t outputMask = numOutputs - 1;
    constexpr size_t htMask = hashtableSize - 1;
    constexpr size_t htShift = 6; //2^6=64
+   if ((len & (accountingInterval - 1)) == 0) {
+      accountedBytes += accountingInterval * typeSize;
+      if (executionContext->allocateSpillable(accountingInterval * typeSize)) {
+         spill();
+      }
+   }
    len++;
    auto outputIdx = hash & outputMask;
    if (!outputs[outputIdx]) {
@@ -29,16 +42,46 @@ runtime::PreAggregationHashtableFragment::Entry* runtime::PreAggregationHashtabl
 
 runtime::PreAggregationHashtableFragment* runtime::PreAggregationHashtableFragment::create(runtime::ExecutionContext* context, size_t typeSize) {
    utility::Tracer::Trace trace(createEvent);
-   auto* fragment = new PreAggregationHashtableFragment(typeSize);
+   auto* fragment = new PreAggregationHashtableFragment(context, typeSize);
    context->registerState({fragment, [](void* ptr) { delete reinterpret_cast<PreAggregationHashtableFragment*>(ptr); }});
    return fragment;
 }
+void runtime::PreAggregationHashtableFragment::spill() {
+   utility::Tracer::Trace trace(spillEvent);
+   for (size_t i = 0; i < numOutputs; i++) {
+      if (!outputs[i]) continue;
+      if (!spillFiles[i]) {
+         spillFiles[i] = std::tmpfile();
+         if (!spillFiles[i]) {
+            throw std::runtime_error("could not create spill file");
+         }
+      }
+      for (auto buffer : outputs[i]->getBuffers()) {
+         if (std::fwrite(buffer.ptr, typeSize, buffer.numElements, spillFiles[i]) != buffer.numElements) {
+            throw std::runtime_error("could not write spill file");
+         }
+      }
+      spilled[i] += outputs[i]->getLen();
+      delete outputs[i];
+      outputs[i] = nullptr;
+   }
+   //the local hash table only references entries that are now on disk
+   std::fill(std::begin(ht), std::end(ht), nullptr);
+   executionContext->count("pre-aggregation spills");
+   executionContext->releaseSpillable(accountedBytes);
+   accountedBytes = 0;
+   trace.stop();
+}
 runtime::PreAggregationHashtableFragment::~PreAggregationHashtableFragment() {
    for(size_t i=0;i<numOutputs;i++){
       if(outputs[i]){
          delete outputs[i];
       }
+      if (spillFiles[i]) {
+         std::fclose(spillFiles[i]);
+      }
    }
+   executionContext->releaseSpillable(accountedBytes);
 }
 runtime::PreAggregationHashtable* runtime::PreAggregationHashtable::merge(runtime::ExecutionContext* context, runtime::ThreadLocal* threadLocal, bool (*eq)(uint8_t*, uint8_t*), void (*combine)(uint8_t*, uint8_t*)) {
    utility::Tracer::Trace trace(mergeEvent);
@@ -48,22 +91,30 @@ runtime::PreAggregationHashtable* runtime::PreAggregationHashtable::merge(runtim
    using Entry = runtime::PreAggregationHashtableFragment::Entry;
    constexpr size_t numPartitions = runtime::PreAggregationHashtableFragment::numOutputs;
    std::vector<FlexibleBuffer*> outputs[numPartitions];
+   std::vector<PreAggregationHashtableFragment*> spilledFragments[numPartitions];
+   size_t spilledValues[numPartitions] = {};
+   size_t typeSize = 0;
    for (auto* ptr : threadLocal->getTls()) {
       auto* fragment = reinterpret_cast<PreAggregationHashtableFragment*>(ptr);
+      typeSize = fragment->typeSize;
       for (size_t i = 0; i < numPartitions; i++) {
          auto* current = fragment->outputs[i];
          if (current) {
             outputs[i].push_back(current);
          }
+         if (fragment->spillFiles[i]) {
+            spilledFragments[i].push_back(fragment);
+            spilledValues[i] += fragment->spilled[i];
+         }
       }
    }
-   auto* res = new PreAggregationHashtable();
+   auto* res = new PreAggregationHashtable(context);
    context->registerState({res, [](void* ptr) { delete reinterpret_cast<PreAggregationHashtable*>(ptr); }});
 
-   tbb::parallel_for_each(&outputs[0], &outputs[numPartitions], [&](const std::vector<FlexibleBuffer*>& input) {
-      size_t id = &input - &outputs[0];
+   auto mergePartition = [&](size_t id) {
+      const auto& input = outputs[id];
       utility::Tracer::Trace trace(mergePartitionEvent);
-      size_t totalValues = 0;
+      size_t totalValues = spilledValues[id];
       size_t minValues = 0;
 
       for (auto* o : input) {
@@ -88,35 +139,89 @@ runtime::PreAggregationHashtable* runtime::PreAggregationHashtable::merge(runtim
       utility::Tracer::Trace allocTrace(mergeAllocate);
       Entry** ht = runtime::FixedSizedBuffer<Entry*>::createZeroed(htSize);
       allocTrace.stop();
+      auto tryCombine = [&](Entry* curr, size_t pos) {
+         auto* currCandidate = runtime::untag(ht[pos]);
+         while (currCandidate) {
+            if (currCandidate->hashValue == curr->hashValue && eq(currCandidate->content, curr->content)) {
+               combine(currCandidate->content, curr->content);
+               return true;
+            }
+            currCandidate = currCandidate->next;
+         }
+         return false;
+      };
+      auto link = [&](Entry* curr, size_t pos) {
+         auto* loc = reinterpret_cast<Entry**>(localBuffer.insert());
+         *loc = curr;
+         auto* previousPtr = ht[pos];
+         ht[pos] = runtime::tag(curr, previousPtr, curr->hashValue);
+         curr->next = runtime::untag(previousPtr);
+      };
       for (auto* o : input) {
          o->iterate([&](uint8_t* entryRawPtr) {
             Entry* curr = reinterpret_cast<Entry*>(entryRawPtr);
             auto pos = curr->hashValue >> htShift & htMask;
-            auto* currCandidate = runtime::untag(ht[pos]);
-            bool merged = false;
-            while (currCandidate) {
-               if (currCandidate->hashValue == curr->hashValue && eq(currCandidate->content, curr->content)) {
-                  combine(currCandidate->content, curr->content);
-                  merged = true;
-                  break;
-               }
-               currCandidate = currCandidate->next;
-            }
-            if (!merged) {
-               auto* loc = reinterpret_cast<Entry**>(localBuffer.insert());
-               *loc = curr;
-               auto* previousPtr = ht[pos];
-               ht[pos] = runtime::tag(curr, previousPtr, curr->hashValue);
-               curr->next = runtime::untag(previousPtr);
+            if (!tryCombine(curr, pos)) {
+               link(curr, pos);
             }
          });
       }
+      if (!spilledFragments[id].empty()) {
+         //read spilled entries back in chunks: only entries of new groups are kept in memory
+         utility::Tracer::Trace spilledTrace(mergeSpilledEvent);
+         auto reloadedEntries = std::make_unique<runtime::FlexibleBuffer>(spillChunkSize, typeSize);
+         std::vector<uint8_t> chunk(spillChunkSize * typeSize);
+         for (auto* fragment : spilledFragments[id]) {
+            auto* file = fragment->spillFiles[id];
+            std::rewind(file);
+            size_t read;
+            while ((read = std::fread(chunk.data(), typeSize, spillChunkSize, file)) > 0) {
+               for (size_t i = 0; i < read; i++) {
+                  Entry* curr = reinterpret_cast<Entry*>(&chunk[i * typeSize]);
+                  auto pos = curr->hashValue >> htShift & htMask;
+                  if (!tryCombine(curr, pos)) {
+                     auto* copy = reinterpret_cast<Entry*>(reloadedEntries->insert());
+                     std::memcpy(copy, curr, typeSize);
+                     link(copy, pos);
+                  }
+               }
+            }
+         }
+         spilledTrace.stop();
+         size_t bytes = reloadedEntries->getLen() * typeSize;
+         context->allocateSpillable(bytes);
+         std::unique_lock<std::mutex> lock(mutex);
+         res->accountedBytes += bytes;
+         res->reloaded.push_back(std::move(reloadedEntries));
+      }
       utility::Tracer::Trace deallocTrace(mergeDeallocate);
       res->ht[id] = {ht, htMask};
       deallocTrace.stop();
+      //the partition's hash table and entry pointers stay alive with the merged hash table
+      size_t bytes = htSize * sizeof(Entry*) + localBuffer.getLen() * sizeof(Entry*);
+      context->allocateSpillable(bytes);
       std::unique_lock<std::mutex> lock(mutex);
+      res->accountedBytes += bytes;
       res->buffer.merge(localBuffer);
-   });
+   };
+   std::vector<size_t> inMemoryPartitions;
+   std::vector<size_t> spilledPartitions;
+   for (size_t i = 0; i < numPartitions; i++) {
+      (spilledFragments[i].empty() ? inMemoryPartitions : spilledPartitions).push_back(i);
+   }
+   tbb::parallel_for_each(inMemoryPartitions.begin(), inMemoryPartitions.end(), mergePartition);
+   //spilled partitions are merged in rounds that fit into the remaining memory budget (at least one partition per round)
+   auto requiredMemory = [&](size_t id) { return spilledValues[id] * (typeSize + 2 * sizeof(Entry*)); };
+   for (size_t begin = 0; begin < spilledPartitions.size();) {
+      size_t available = context->getAvailableSpillable();
+      size_t end = begin + 1;
+      size_t required = requiredMemory(spilledPartitions[begin]);
+      while (end < spilledPartitions.size() && required + requiredMemory(spilledPartitions[end]) <= available) {
+         required += requiredMemory(spilledPartitions[end++]);
+      }
+      tbb::parallel_for_each(spilledPartitions.begin() + begin, spilledPartitions.begin() + end, mergePartition);
+      begin = end;
+   }
    return res;
 }
 runtime::BufferIterator* runtime::PreAggregationHashtable::createIterator() {
@@ -152,4 +257,5 @@ runtime::PreAggregationHashtable::~PreAggregationHashtable() {
    for (auto p : ht) {
       runtime::FixedSizedBuffer<Entry*>::deallocate(p.ht, p.hashMask + 1);
    }
+   executionContext->releaseSpillable(accountedBytes);
 }
\ No newline at end of file
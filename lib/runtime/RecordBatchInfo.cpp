@@ -3,11 +3,32 @@
 #include <arrow/record_batch.h>
 
 uint8_t* runtime::RecordBatchInfo::getBuffer(arrow::RecordBatch* batch, size_t columnId, size_t bufferId)  {
+   return getBuffer(*batch->column_data(columnId), bufferId);
+}
+uint8_t* runtime::RecordBatchInfo::getBuffer(const arrow::ArrayData& data, size_t bufferId) {
    static uint8_t alternative = 0b11111111;
-   if (batch->column_data(columnId)->buffers.size() > bufferId && batch->column_data(columnId)->buffers[bufferId]) {
-      auto* buffer = batch->column_data(columnId)->buffers[bufferId].get();
+   if (data.buffers.size() > bufferId && data.buffers[bufferId]) {
+      auto* buffer = data.buffers[bufferId].get();
       return (uint8_t*) buffer->address();
    } else {
       return &alternative; //always return valid pointer to at least one byte filled with ones
    }
-}
\ No newline at end of file
+}
+void runtime::RecordBatchInfo::initColumnInfo(ColumnInfo& colInfo, arrow::RecordBatch* batch, size_t columnId) {
+   const auto& data = *batch->column_data(columnId);
+   colInfo.offset = data.offset;
+   colInfo.validMultiplier = data.buffers[0] ? 1 : 0;
+   colInfo.validBuffer = getBuffer(data, 0);
+   colInfo.code = -1;
+   if (data.dictionary) {
+      //dictionary<int32,utf8>: values are accessed through the offsets/data of the dictionary
+      const auto& dictionary = *data.dictionary;
+      colInfo.indexBuffer = getBuffer(data, 1);
+      colInfo.dataBuffer = getBuffer(dictionary, 1) + dictionary.offset * sizeof(int32_t);
+      colInfo.varLenBuffer = getBuffer(dictionary, 2);
+   } else {
+      colInfo.indexBuffer = nullptr;
+      colInfo.dataBuffer = getBuffer(data, 1);
+      colInfo.varLenBuffer = getBuffer(data, 2);
+   }
+}
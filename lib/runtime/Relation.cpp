@@ -1,5 +1,7 @@
 #include "runtime/Relation.h"
 #include "runtime/HashIndex.h"
+#include "runtime/Numa.h"
+#include "runtime/ZoneMap.h"
 
 #include <arrow/api.h>
 #include <arrow/compute/api.h>
@@ -9,10 +11,13 @@
 #include <arrow/status.h>
 #include <arrow/table.h>
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <mutex>
 #include <random>
 #include <ranges>
+#include <unordered_set>
 namespace {
 /*
  * Create sample from arrow table
@@ -62,31 +67,166 @@ std::shared_ptr<arrow::RecordBatch> createSample(std::shared_ptr<arrow::Table> t
 }
 
 /*
- * Count distinct number of values in column
+ * Update column statistics after appending rows: only the appended rows are scanned
  */
-std::optional<size_t> countDistinctValues(std::shared_ptr<arrow::ChunkedArray> column) {
-   //todo: replace with approximate count in the future
-   auto res = arrow::compute::CallFunction("count_distinct", {column});
-   if (res.ok()) {
-      return res.ValueOrDie().scalar_as<arrow::Int64Scalar>().value;
+void updateStatistics(const std::shared_ptr<runtime::TableMetaData>& metaData, const std::shared_ptr<arrow::Table>& table, const std::shared_ptr<arrow::Table>& appended) {
+   for (auto c : metaData->getOrderedColumns()) {
+      auto column = table->GetColumnByName(c);
+      auto appendedColumn = appended->GetColumnByName(c);
+      if (!column || !appendedColumn) continue;
+      auto columnMetaData = metaData->getColumnMetaData(c);
+      auto statistics = columnMetaData->getStatistics();
+      if (statistics && statistics->getRows() + appended->num_rows() == static_cast<size_t>(table->num_rows())) {
+         statistics = statistics->merge(*runtime::ColumnStatistics::create(appendedColumn));
+      } else {
+         //missing or outdated statistics: analyze the whole column
+         statistics = runtime::ColumnStatistics::create(column);
+      }
+      columnMetaData->setStatistics(statistics);
+      columnMetaData->setDistinctValues(statistics->getDistinctValues());
    }
-   return {};
 }
-//loading table
-std::shared_ptr<arrow::Table> loadTable(std::string name) {
-   auto inputFile = arrow::io::ReadableFile::Open(name).ValueOrDie();
-   auto batchReader = arrow::ipc::RecordBatchFileReader::Open(inputFile).ValueOrDie();
-   std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+/*
+ * Analyze columns without (up-to-date) statistics, e.g. of databases written before statistics were maintained
+ */
+void analyzeMissingStatistics(const std::shared_ptr<runtime::TableMetaData>& metaData, const std::shared_ptr<arrow::Table>& table) {
+   for (auto c : metaData->getOrderedColumns()) {
+      auto column = table->GetColumnByName(c);
+      if (!column) continue;
+      auto columnMetaData = metaData->getColumnMetaData(c);
+      auto statistics = columnMetaData->getStatistics();
+      if (statistics && statistics->getRows() == static_cast<size_t>(column->length())) continue;
+      statistics = runtime::ColumnStatistics::create(column);
+      columnMetaData->setStatistics(statistics);
+      columnMetaData->setDistinctValues(statistics->getDistinctValues());
+   }
+}
+//open arrow file: by default memory-mapped, s.t. record batches point directly into the page cache (shared between processes)
+std::shared_ptr<arrow::io::RandomAccessFile> openArrowFile(std::string name) {
+   if (const char* mode = std::getenv("LINGODB_MMAP")) {
+      if (std::string(mode) == "OFF") {
+         return arrow::io::ReadableFile::Open(name).ValueOrDie();
+      }
+   }
+   return arrow::io::MemoryMappedFile::Open(name, arrow::io::FileMode::READ).ValueOrDie();
+}
+//rows appended by streaming (COPY) are stored in delta files <name>.1, <name>.2, ... next to the data file: existing data is not rewritten
+std::vector<std::string> getDataFiles(const std::string& name) {
+   std::vector<std::string> res{name};
+   for (size_t i = 1; std::filesystem::exists(name + "." + std::to_string(i)); i++) {
+      res.push_back(name + "." + std::to_string(i));
+   }
+   return res;
+}
+std::string nextDeltaFile(const std::string& name) {
+   //the first rows of a table that was not stored yet go into the data file itself
+   if (!std::filesystem::exists(name)) return name;
+   return name + "." + std::to_string(getDataFiles(name).size());
+}
+void removeDeltaFiles(const std::string& name) {
+   auto files = getDataFiles(name);
+   for (size_t i = 1; i < files.size(); i++) {
+      std::filesystem::remove(files[i]);
+   }
+}
+//loading a single data file (optionally only the given columns)
+void loadBatches(const std::string& file, const std::vector<std::string>* columns, std::shared_ptr<arrow::Schema>& schema, std::vector<std::shared_ptr<arrow::RecordBatch>>& batches) {
+   auto inputFile = openArrowFile(file);
+   auto readOptions = arrow::ipc::IpcReadOptions::Defaults();
+   if (columns) {
+      auto fileSchema = arrow::ipc::RecordBatchFileReader::Open(inputFile).ValueOrDie()->schema();
+      for (const auto& c : *columns) {
+         auto fieldIndex = fileSchema->GetFieldIndex(c);
+         if (fieldIndex < 0) {
+            throw std::runtime_error("column not found: " + c);
+         }
+         readOptions.included_fields.push_back(fieldIndex);
+      }
+      std::sort(readOptions.included_fields.begin(), readOptions.included_fields.end());
+   }
+   auto batchReader = arrow::ipc::RecordBatchFileReader::Open(inputFile, readOptions).ValueOrDie();
+   schema = batchReader->schema();
    for (int i = 0; i < batchReader->num_record_batches(); i++) {
       batches.push_back(batchReader->ReadRecordBatch(i).ValueOrDie());
    }
-   return arrow::Table::FromRecordBatches(batchReader->schema(), batches).ValueOrDie();
 }
+std::shared_ptr<arrow::Table> loadDataFile(const std::string& file) {
+   std::shared_ptr<arrow::Schema> schema;
+   std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+   loadBatches(file, nullptr, schema, batches);
+   return arrow::Table::FromRecordBatches(schema, batches).ValueOrDie();
+}
+//loading table (data file and delta files)
+std::shared_ptr<arrow::Table> loadTable(std::string name) {
+   std::shared_ptr<arrow::Schema> schema;
+   std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+   for (const auto& file : getDataFiles(name)) {
+      loadBatches(file, nullptr, schema, batches);
+   }
+   return arrow::Table::FromRecordBatches(schema, batches).ValueOrDie();
+}
+//loading only the given columns of a table
+std::shared_ptr<arrow::Table> loadTable(std::string name, const std::vector<std::string>& columns) {
+   std::shared_ptr<arrow::Schema> schema;
+   std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+   for (const auto& file : getDataFiles(name)) {
+      loadBatches(file, &columns, schema, batches);
+   }
+   return arrow::Table::FromRecordBatches(schema, batches).ValueOrDie();
+}
+//string values of dictionary-encoded columns that are streamed into one file: every column has a single, growing dictionary
+class DictionaryStreamEncoder {
+   struct Column {
+      int id;
+      std::unordered_map<std::string, int32_t> codes;
+      std::shared_ptr<arrow::Array> dictionary;
+   };
+   std::shared_ptr<arrow::Schema> schema;
+   std::vector<Column> columns;
+
+   public:
+   DictionaryStreamEncoder(std::shared_ptr<arrow::Schema> schema) : schema(schema) {
+      for (int i = 0; i < schema->num_fields(); i++) {
+         if (schema->field(i)->type()->id() == arrow::Type::DICTIONARY) {
+            columns.push_back({i, {}, arrow::MakeArrayOfNull(arrow::utf8(), 0).ValueOrDie()});
+         }
+      }
+   }
+   std::shared_ptr<arrow::RecordBatch> encode(const std::shared_ptr<arrow::RecordBatch>& batch) {
+      if (columns.empty()) return batch;
+      auto arrays = batch->columns();
+      for (auto& column : columns) {
+         auto input = arrays[column.id];
+         if (input->type_id() == arrow::Type::DICTIONARY) {
+            input = arrow::compute::Cast(*input, arrow::utf8()).ValueOrDie();
+         }
+         auto strings = std::static_pointer_cast<arrow::StringArray>(input);
+         arrow::Int32Builder indices;
+         arrow::StringBuilder newValues;
+         for (int64_t i = 0; i < strings->length(); i++) {
+            if (strings->IsNull(i)) {
+               if (!indices.AppendNull().ok()) throw std::runtime_error("could not encode dictionary");
+               continue;
+            }
+            auto value = strings->GetView(i);
+            auto [it, inserted] = column.codes.try_emplace(std::string(value), static_cast<int32_t>(column.codes.size()));
+            if (inserted && !newValues.Append(value).ok()) throw std::runtime_error("could not encode dictionary");
+            if (!indices.Append(it->second).ok()) throw std::runtime_error("could not encode dictionary");
+         }
+         if (newValues.length() > 0) {
+            column.dictionary = arrow::Concatenate({column.dictionary, newValues.Finish().ValueOrDie()}).ValueOrDie();
+         }
+         arrays[column.id] = arrow::DictionaryArray::FromArrays(schema->field(column.id)->type(), indices.Finish().ValueOrDie(), column.dictionary).ValueOrDie();
+      }
+      return arrow::RecordBatch::Make(schema, batch->num_rows(), arrays);
+   }
+};
 //splitting table into "good-sized chunks"
+const int64_t chunkSize = 20000;
 std::vector<std::shared_ptr<arrow::RecordBatch>> toRecordBatches(std::shared_ptr<arrow::Table> table) {
    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
    arrow::TableBatchReader reader(table);
-   reader.set_chunksize(20000);
+   reader.set_chunksize(chunkSize);
    std::shared_ptr<arrow::RecordBatch> nextChunk;
    while (reader.ReadNext(&nextChunk) == arrow::Status::OK()) {
       if (nextChunk) {
@@ -98,9 +238,26 @@ std::vector<std::shared_ptr<arrow::RecordBatch>> toRecordBatches(std::shared_ptr
    }
    return batches;
 }
+//existing record batches are kept (and stay on their NUMA node), only a partial last batch is combined with the appended rows
+//firstAppended: index of the first new (or re-combined) record batch
+std::vector<std::shared_ptr<arrow::RecordBatch>> appendToRecordBatches(std::vector<std::shared_ptr<arrow::RecordBatch>> batches, const std::shared_ptr<arrow::Table>& toAppend, size_t& firstAppended) {
+   std::vector<std::shared_ptr<arrow::RecordBatch>> toCombine;
+   if (!batches.empty() && batches.back()->num_rows() < chunkSize) {
+      toCombine.push_back(batches.back());
+      batches.pop_back();
+   }
+   toCombine.push_back(toAppend->CombineChunksToBatch().ValueOrDie());
+   firstAppended = batches.size();
+   auto combined = arrow::Table::FromRecordBatches(toCombine).ValueOrDie()->CombineChunksToBatch().ValueOrDie();
+   for (const auto& batch : toRecordBatches(arrow::Table::FromRecordBatches({combined}).ValueOrDie())) {
+      batches.push_back(batch);
+   }
+   runtime::Numa::placeAppendedRecordBatches(batches, firstAppended);
+   return batches;
+}
 //load sample:
 std::shared_ptr<arrow::RecordBatch> loadSample(std::string name) {
-   auto inputFile = arrow::io::ReadableFile::Open(name).ValueOrDie();
+   auto inputFile = openArrowFile(name);
    auto batchReader = arrow::ipc::RecordBatchFileReader::Open(inputFile).ValueOrDie();
    assert(batchReader->num_record_batches() == 1);
    auto batch = batchReader->ReadRecordBatch(0).ValueOrDie();
@@ -140,7 +297,7 @@ std::shared_ptr<arrow::DataType> createDataType(const runtime::ColumnType& colum
          arrow::date32() :
          arrow::date64();
    }
-   if (columnType.base == "string") return arrow::utf8();
+   if (columnType.base == "string") return columnType.isDictionaryEncoded() ? arrow::dictionary(arrow::int32(), arrow::utf8()) : arrow::utf8();
    if (columnType.base == "char") return arrow::fixed_size_binary(asInt(columnType.modifiers.at(0)));
    if (columnType.base == "decimal") return arrow::decimal(asInt(columnType.modifiers.at(0)), asInt(columnType.modifiers.at(1)));
    if (columnType.base == "timestamp") return arrow::timestamp(arrow::TimeUnit::SECOND);
@@ -155,54 +312,105 @@ std::shared_ptr<arrow::Schema> createSchema(std::shared_ptr<runtime::TableMetaDa
    return std::make_shared<arrow::Schema>(fields);
 }
 
+//rows that are appended (e.g., results of queries) contain plain strings for dictionary-encoded columns
+std::shared_ptr<arrow::Table> encodeDictionaries(std::shared_ptr<arrow::Table> table, std::shared_ptr<arrow::Schema> schema) {
+   for (int i = 0; i < table->num_columns(); i++) {
+      auto field = schema->GetFieldByName(table->field(i)->name());
+      if (field && field->type()->id() == arrow::Type::DICTIONARY && table->field(i)->type()->id() != arrow::Type::DICTIONARY) {
+         auto encoded = arrow::compute::DictionaryEncode(table->column(i)).ValueOrDie();
+         table = table->SetColumn(i, field, encoded.chunked_array()).ValueOrDie();
+      }
+   }
+   return table;
+}
+
 //storing tables
+//files are written to a temporary file first and then renamed: the previous version may still be memory-mapped and must not be truncated
 void storeTable(std::string file, std::shared_ptr<arrow::Table> table) {
-   auto inputFile = arrow::io::FileOutputStream::Open(file).ValueOrDie();
-   auto batchWriter = arrow::ipc::MakeFileWriter(inputFile, table->schema()).ValueOrDie();
+   auto tmpFile = file + ".tmp";
+   auto inputFile = arrow::io::FileOutputStream::Open(tmpFile).ValueOrDie();
+   //arrow files only support a single dictionary per column: the dictionaries of all record batches are unified
+   auto writeOptions = arrow::ipc::IpcWriteOptions::Defaults();
+   writeOptions.unify_dictionaries = true;
+   auto batchWriter = arrow::ipc::MakeFileWriter(inputFile, table->schema(), writeOptions).ValueOrDie();
    if(!batchWriter->WriteTable(*table).ok()||!batchWriter->Close().ok()||!inputFile->Close().ok()){
       throw std::runtime_error("could not store table");
    }
+   std::filesystem::rename(tmpFile, file);
+   //the data file contains all rows now
+   removeDeltaFiles(file);
 }
 void storeSample(std::string file, std::shared_ptr<arrow::RecordBatch> batch) {
-   auto inputFile = arrow::io::FileOutputStream::Open(file).ValueOrDie();
+   auto tmpFile = file + ".tmp";
+   auto inputFile = arrow::io::FileOutputStream::Open(tmpFile).ValueOrDie();
    auto batchWriter = arrow::ipc::MakeFileWriter(inputFile, batch->schema()).ValueOrDie();
    if(!batchWriter->WriteRecordBatch(*batch).ok()||!batchWriter->Close().ok()||!inputFile->Close().ok()){
       throw std::runtime_error("could not store table");
    }
+   std::filesystem::rename(tmpFile, file);
 }
 } // end namespace
 
 namespace runtime {
 class DBRelation : public Relation {
+   //concurrent (read-only) queries may load columns: table and record batches are only replaced while holding the mutex
+   std::mutex mutex;
    std::shared_ptr<arrow::Table> table;
    std::shared_ptr<TableMetaData> metaData;
-   std::vector<std::shared_ptr<arrow::RecordBatch>> recordBatches;
+   std::shared_ptr<const std::vector<std::shared_ptr<arrow::RecordBatch>>> recordBatches;
    std::shared_ptr<arrow::Schema> schema;
    std::shared_ptr<arrow::RecordBatch> sample;
    std::unordered_map<std::string, std::shared_ptr<Index>> indices;
    std::string dbDir;
    bool eagerLoading;
-   void flush() {
+   //columns that are stored in the data file, but were not loaded yet
+   std::unordered_set<std::string> unloadedColumns;
+   std::shared_ptr<ZoneMap> zoneMap;
+   std::once_flag statisticsChecked;
+   void flush(bool storeData = true) {
       if (!persist) return;
       auto dataFile = dbDir + "/" + name + ".arrow";
       auto sampleFile = dbDir + "/" + name + ".arrow.sample";
-      auto metaFile = dbDir + "/" + name + ".metadata.json";
+      storeMetaData();
 
-      std::ofstream ostream(metaFile);
-      ostream << metaData->serialize(false);
-      ostream.flush();
-
-      if (table) {
+      //a partially loaded table was not modified and must not overwrite the data file
+      if (storeData && table && unloadedColumns.empty()) {
          storeTable(dataFile, table);
       }
       if (sample) {
          storeSample(sampleFile, sample);
       }
+      if (auto currentZoneMap = getZoneMap()) {
+         currentZoneMap->store(dbDir + "/" + name + ".arrow.zonemap");
+      }
+   }
+
+   void storeMetaData() {
+      if (!persist) return;
+      std::ofstream ostream(dbDir + "/" + name + ".metadata.json");
+      ostream << metaData->serialize(false);
+      ostream.flush();
+   }
+   //zone map of the record batches after an append: only the synopses of batches starting at firstAppended are computed
+   std::shared_ptr<ZoneMap> extendZoneMap(const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches, size_t firstAppended) {
+      auto current = getZoneMap();
+      return current ? current->extend(batches, firstAppended) : ZoneMap::create(batches);
    }
 
    public:
-   DBRelation(const std::string dbDir, const std::string name, const std::shared_ptr<arrow::Table>& table, const std::shared_ptr<TableMetaData>& metaData, const std::vector<std::shared_ptr<arrow::RecordBatch>>& recordBatches, const std::shared_ptr<arrow::Schema>& schema, const std::shared_ptr<arrow::RecordBatch>& sample, bool eagerLoading) : table(table), metaData(metaData), recordBatches(recordBatches), schema(schema), sample(sample), dbDir(dbDir), eagerLoading(eagerLoading) {
+   DBRelation(const std::string dbDir, const std::string name, const std::shared_ptr<arrow::Table>& table, const std::shared_ptr<TableMetaData>& metaData, const std::vector<std::shared_ptr<arrow::RecordBatch>>& recordBatches, const std::shared_ptr<arrow::Schema>& schema, const std::shared_ptr<arrow::RecordBatch>& sample, bool eagerLoading) : table(table), metaData(metaData), recordBatches(std::make_shared<const std::vector<std::shared_ptr<arrow::RecordBatch>>>(recordBatches)), schema(schema), sample(sample), dbDir(dbDir), eagerLoading(eagerLoading) {
       Relation::name = name;
+      if (!eagerLoading && std::filesystem::exists(dbDir + "/" + name + ".arrow")) {
+         for (const auto& f : schema->fields()) {
+            unloadedColumns.insert(f->name());
+         }
+      }
+      auto zoneMapFile = dbDir + "/" + name + ".arrow.zonemap";
+      if (std::filesystem::exists(zoneMapFile)) {
+         zoneMap = ZoneMap::load(zoneMapFile);
+      } else if (eagerLoading) {
+         zoneMap = ZoneMap::create(recordBatches);
+      }
       for (auto index : metaData->getIndices()) {
          indices.insert({index->name, Index::createHashIndex(*index, *this, dbDir)});
       }
@@ -217,13 +425,35 @@ class DBRelation : public Relation {
    std::shared_ptr<TableMetaData> getMetaData() override {
       return metaData;
    }
+   //missing statistics (e.g., of tables stored by older versions) are computed on first use and stored with the metadata right away, columns of lazily loaded tables are only read for that
+   void ensureStatistics() override {
+      std::call_once(statisticsChecked, [&]() {
+         std::vector<std::string> withoutStatistics;
+         for (auto c : metaData->getOrderedColumns()) {
+            auto statistics = metaData->getColumnMetaData(c)->getStatistics();
+            if (!statistics || statistics->getRows() != metaData->getNumRows()) {
+               withoutStatistics.push_back(c);
+            }
+         }
+         auto dataFile = dbDir + "/" + name + ".arrow";
+         if (withoutStatistics.empty() || metaData->getNumRows() == 0 || !std::filesystem::exists(dataFile)) return;
+         bool loaded;
+         {
+            std::lock_guard<std::mutex> lock(mutex);
+            loaded = unloadedColumns.empty();
+         }
+         analyzeMissingStatistics(metaData, loaded ? getTable() : loadTable(dataFile, withoutStatistics));
+         storeMetaData();
+      });
+   }
    std::shared_ptr<arrow::RecordBatch> getSample() override {
       return sample;
    }
    std::shared_ptr<arrow::Schema> getArrowSchema() override {
       return schema;
    }
-   const std::vector<std::shared_ptr<arrow::RecordBatch>>& getRecordBatches() override {
+   std::shared_ptr<const std::vector<std::shared_ptr<arrow::RecordBatch>>> getRecordBatches() override {
+      std::lock_guard<std::mutex> lock(mutex);
       return recordBatches;
    }
    std::shared_ptr<Index> getIndex(const std::string name) override {
@@ -232,35 +462,171 @@ class DBRelation : public Relation {
       }
       throw std::runtime_error("index not found");
    }
+   std::shared_ptr<ZoneMap> getZoneMap() override {
+      std::lock_guard<std::mutex> lock(mutex);
+      return zoneMap;
+   }
    void loadData() override {
-      if (!eagerLoading && table->num_rows() == 0) {
-         auto dataFile = dbDir + "/" + name + ".arrow";
-         if (std::filesystem::exists(dataFile)) {
-            table = loadTable(dataFile);
-            recordBatches = toRecordBatches(table);
+      loadColumns(schema->field_names());
+   }
+   void loadColumns(const std::vector<std::string>& columns) override {
+      std::lock_guard<std::mutex> lock(mutex);
+      std::vector<std::string> toLoad;
+      for (const auto& c : columns) {
+         if (unloadedColumns.contains(c) && std::find(toLoad.begin(), toLoad.end(), c) == toLoad.end()) {
+            toLoad.push_back(c);
          }
       }
+      if (toLoad.empty()) return;
+      auto loaded = loadTable(dbDir + "/" + name + ".arrow", toLoad);
+      //combine with the columns that were loaded before (in the order of the data file)
+      arrow::FieldVector fields;
+      std::vector<std::shared_ptr<arrow::ChunkedArray>> columnData;
+      for (const auto& f : schema->fields()) {
+         std::shared_ptr<arrow::Table> source;
+         if (loaded->schema()->GetFieldIndex(f->name()) >= 0) {
+            source = loaded;
+         } else if (!unloadedColumns.contains(f->name())) {
+            source = table;
+         } else {
+            continue;
+         }
+         auto columnId = source->schema()->GetFieldIndex(f->name());
+         fields.push_back(source->schema()->field(columnId));
+         columnData.push_back(source->column(columnId));
+      }
+      table = arrow::Table::Make(std::make_shared<arrow::Schema>(fields), columnData, loaded->num_rows());
+      auto newRecordBatches = toRecordBatches(table);
+      //columns that were loaded before are already placed
+      std::vector<int> loadedColumnIds;
+      for (const auto& c : toLoad) {
+         loadedColumnIds.push_back(table->schema()->GetFieldIndex(c));
+         unloadedColumns.erase(c);
+      }
+      runtime::Numa::placeColumns(newRecordBatches, loadedColumnIds);
+      recordBatches = std::make_shared<const std::vector<std::shared_ptr<arrow::RecordBatch>>>(std::move(newRecordBatches));
    }
    void append(std::shared_ptr<arrow::Table> toAppend) override {
-      std::vector<std::shared_ptr<arrow::RecordBatch>> newTableBatches;
-
-      if (table->num_rows() != 0) {
-         newTableBatches.push_back(table->CombineChunksToBatch().ValueOrDie());
+      loadData();
+      toAppend = encodeDictionaries(toAppend, schema);
+      size_t firstAppended;
+      auto batches = appendToRecordBatches(*getRecordBatches(), toAppend, firstAppended);
+      auto newTable = arrow::Table::FromRecordBatches(toAppend->schema(), batches).ValueOrDie();
+      auto newZoneMap = extendZoneMap(batches, firstAppended);
+      auto newRecordBatches = std::make_shared<const std::vector<std::shared_ptr<arrow::RecordBatch>>>(std::move(batches));
+      {
+         std::lock_guard<std::mutex> lock(mutex);
+         table = newTable;
+         recordBatches = newRecordBatches;
+         zoneMap = newZoneMap;
       }
-      newTableBatches.push_back(toAppend->CombineChunksToBatch().ValueOrDie());
-      table = arrow::Table::FromRecordBatches(newTableBatches).ValueOrDie();
-      recordBatches = toRecordBatches(table);
       sample = createSample(table);
       metaData->setNumRows(table->num_rows());
-      for (auto c : metaData->getOrderedColumns()) {
-         metaData->getColumnMetaData(c)->setDistinctValues(countDistinctValues(table->GetColumnByName(c)));
-      }
+      updateStatistics(metaData, table, toAppend);
       flush();
       for (auto idx : indices) {
          idx.second->appendRows(toAppend);
       }
    }
+   //bounded memory: the new rows are processed in chunks. For persistent tables, they are streamed into a new delta file that is memory-mapped afterwards (existing data files are not rewritten)
+   void appendBatches(std::shared_ptr<arrow::RecordBatchReader> batches) override {
+      loadData();
+      int64_t previousRows = table->num_rows();
+      auto newRecordBatches = *getRecordBatches();
+      size_t firstAppended = newRecordBatches.size();
+      auto dataFile = dbDir + "/" + name + ".arrow";
+      std::string deltaFile;
+      std::string tmpFile;
+      std::shared_ptr<arrow::io::FileOutputStream> outputFile;
+      std::shared_ptr<arrow::ipc::RecordBatchWriter> batchWriter;
+      DictionaryStreamEncoder dictionaryEncoder(schema);
+      if (persist) {
+         deltaFile = nextDeltaFile(dataFile);
+         tmpFile = deltaFile + ".tmp";
+         outputFile = arrow::io::FileOutputStream::Open(tmpFile).ValueOrDie();
+         //the dictionaries only grow: the writer stores the new values as dictionary deltas
+         auto writeOptions = arrow::ipc::IpcWriteOptions::Defaults();
+         writeOptions.emit_dictionary_deltas = true;
+         batchWriter = arrow::ipc::MakeFileWriter(outputFile, schema, writeOptions).ValueOrDie();
+      }
+      auto write = [&](const std::shared_ptr<arrow::RecordBatch>& batch) {
+         if (batchWriter) {
+            if (!batchWriter->WriteRecordBatch(*dictionaryEncoder.encode(batch)).ok()) {
+               throw std::runtime_error("could not store table");
+            }
+         } else {
+            newRecordBatches.push_back(encodeDictionaries(arrow::Table::FromRecordBatches({batch}).ValueOrDie(), schema)->CombineChunksToBatch().ValueOrDie());
+         }
+      };
+      //new rows are written in chunks of the same size as the record batches of loaded tables
+      std::vector<std::shared_ptr<arrow::RecordBatch>> pending;
+      int64_t pendingRows = 0;
+      auto writePending = [&](bool all) {
+         auto combined = arrow::Table::FromRecordBatches(pending).ValueOrDie()->CombineChunksToBatch().ValueOrDie();
+         int64_t offset = 0;
+         while (combined->num_rows() - offset >= chunkSize || (all && offset < combined->num_rows())) {
+            auto length = std::min(chunkSize, combined->num_rows() - offset);
+            write(combined->Slice(offset, length));
+            offset += length;
+         }
+         pending.clear();
+         pendingRows = combined->num_rows() - offset;
+         if (pendingRows > 0) {
+            pending.push_back(combined->Slice(offset));
+         }
+      };
+      try {
+         while (true) {
+            std::shared_ptr<arrow::RecordBatch> batch;
+            auto status = batches->ReadNext(&batch);
+            if (!status.ok()) {
+               throw std::runtime_error("could not append to table: " + status.ToString());
+            }
+            if (!batch) break;
+            pending.push_back(batch);
+            pendingRows += batch->num_rows();
+            if (pendingRows >= chunkSize) {
+               writePending(false);
+            }
+         }
+         if (pendingRows > 0) {
+            writePending(true);
+         }
+         if (batchWriter && (!batchWriter->Close().ok() || !outputFile->Close().ok())) {
+            throw std::runtime_error("could not store table");
+         }
+      } catch (...) {
+         if (batchWriter) {
+            std::filesystem::remove(tmpFile);
+         }
+         throw;
+      }
+      if (batchWriter) {
+         std::filesystem::rename(tmpFile, deltaFile);
+         for (const auto& batch : toRecordBatches(loadDataFile(deltaFile))) {
+            newRecordBatches.push_back(batch);
+         }
+      }
+      runtime::Numa::placeAppendedRecordBatches(newRecordBatches, firstAppended);
+      auto newTable = arrow::Table::FromRecordBatches(table->schema(), newRecordBatches).ValueOrDie();
+      auto newZoneMap = extendZoneMap(newRecordBatches, firstAppended);
+      {
+         std::lock_guard<std::mutex> lock(mutex);
+         table = newTable;
+         recordBatches = std::make_shared<const std::vector<std::shared_ptr<arrow::RecordBatch>>>(std::move(newRecordBatches));
+         zoneMap = newZoneMap;
+      }
+      sample = createSample(table);
+      metaData->setNumRows(table->num_rows());
+      auto appended = table->Slice(previousRows);
+      updateStatistics(metaData, table, appended);
+      flush(false);
+      for (auto idx : indices) {
+         idx.second->appendRows(appended);
+      }
+   }
    std::shared_ptr<arrow::Table> getTable() override {
+      std::lock_guard<std::mutex> lock(mutex);
       return table;
    }
    void setPersist(bool persist) override {
@@ -282,6 +648,7 @@ std::shared_ptr<Relation> Relation::loadRelation(std::string dbDir, std::string
    if (std::filesystem::exists(dataFile) && eagerLoading) {
       table = loadTable(dataFile);
       recordBatches = toRecordBatches(table);
+      runtime::Numa::placeRecordBatches(recordBatches);
       schema = table->schema();
    }
    if (std::filesystem::exists(sampleFile)) {
@@ -311,7 +678,7 @@ std::shared_ptr<Relation> Relation::createDBRelation(std::string dbDir, std::str
 class LocalRelation : public Relation {
    std::shared_ptr<arrow::Table> table;
    std::shared_ptr<TableMetaData> metaData;
-   std::vector<std::shared_ptr<arrow::RecordBatch>> recordBatches;
+   std::shared_ptr<const std::vector<std::shared_ptr<arrow::RecordBatch>>> recordBatches;
    std::shared_ptr<arrow::Schema> schema;
    std::shared_ptr<arrow::RecordBatch> sample;
 
@@ -319,11 +686,13 @@ class LocalRelation : public Relation {
    LocalRelation(std::shared_ptr<arrow::Table> table, std::shared_ptr<TableMetaData> metaData) : table(table), metaData(metaData) {
       sample = createSample(table);
       schema = createSchema(metaData);
-      recordBatches = toRecordBatches(table);
+      recordBatches = std::make_shared<const std::vector<std::shared_ptr<arrow::RecordBatch>>>(toRecordBatches(table));
+      runtime::Numa::placeRecordBatches(*recordBatches);
    }
    LocalRelation(std::shared_ptr<TableMetaData> metaData) : metaData(metaData) {
       schema = createSchema(metaData);
       table = arrow::Table::MakeEmpty(schema).ValueOrDie();
+      recordBatches = std::make_shared<const std::vector<std::shared_ptr<arrow::RecordBatch>>>();
    }
    std::shared_ptr<TableMetaData> getMetaData() override {
       return metaData;
@@ -334,32 +703,62 @@ class LocalRelation : public Relation {
    std::shared_ptr<arrow::Schema> getArrowSchema() override {
       return schema;
    }
-   const std::vector<std::shared_ptr<arrow::RecordBatch>>& getRecordBatches() override {
+   std::shared_ptr<const std::vector<std::shared_ptr<arrow::RecordBatch>>> getRecordBatches() override {
       return recordBatches;
    }
    std::shared_ptr<Index> getIndex(const std::string name) override {
       throw std::runtime_error("indexes are not supported");
    }
+   std::shared_ptr<ZoneMap> getZoneMap() override {
+      return {};
+   }
    std::shared_ptr<arrow::Table> getTable() override {
       return table;
    }
    void loadData() override {
       //no effect
    }
+   void loadColumns(const std::vector<std::string>& columns) override {
+      //no effect
+   }
 
    void append(std::shared_ptr<arrow::Table> toAppend) override {
-      std::vector<std::shared_ptr<arrow::RecordBatch>> newTableBatches;
-
-      if (table->num_rows() != 0) {
-         newTableBatches.push_back(table->CombineChunksToBatch().ValueOrDie());
-      }
-      newTableBatches.push_back(toAppend->CombineChunksToBatch().ValueOrDie());
-      table = arrow::Table::FromRecordBatches(newTableBatches).ValueOrDie();
-      recordBatches = toRecordBatches(table);
+      toAppend = encodeDictionaries(toAppend, schema);
+      size_t firstAppended;
+      auto batches = appendToRecordBatches(*recordBatches, toAppend, firstAppended);
+      table = arrow::Table::FromRecordBatches(toAppend->schema(), batches).ValueOrDie();
+      recordBatches = std::make_shared<const std::vector<std::shared_ptr<arrow::RecordBatch>>>(std::move(batches));
       sample = createSample(table);
       metaData->setNumRows(table->num_rows());
+      updateStatistics(metaData, table, toAppend);
    }
 };
+//the input is appended in chunks while it is read: only the rows of one chunk are buffered in addition to the table
+void Relation::appendBatches(std::shared_ptr<arrow::RecordBatchReader> batches) {
+   std::vector<std::shared_ptr<arrow::RecordBatch>> pending;
+   int64_t pendingRows = 0;
+   auto appendPending = [&]() {
+      append(arrow::Table::FromRecordBatches(batches->schema(), pending).ValueOrDie());
+      pending.clear();
+      pendingRows = 0;
+   };
+   while (true) {
+      auto next = batches->Next();
+      if (!next.ok()) {
+         throw std::runtime_error("could not append to table: " + next.status().ToString());
+      }
+      auto batch = next.ValueOrDie();
+      if (!batch) break;
+      pending.push_back(batch);
+      pendingRows += batch->num_rows();
+      if (pendingRows >= chunkSize) {
+         appendPending();
+      }
+   }
+   if (pendingRows > 0) {
+      appendPending();
+   }
+}
 std::shared_ptr<Relation> Relation::createLocalRelation(std::string name, std::shared_ptr<TableMetaData> metaData) {
    return std::make_shared<LocalRelation>(metaData);
 }
@@ -5,8 +5,97 @@
 
 #include "json.h"
 
+#include <arrow/compute/api.h>
 #include <arrow/csv/api.h>
 #include <arrow/io/api.h>
+#include <parquet/arrow/reader.h>
+namespace {
+std::shared_ptr<arrow::RecordBatchReader> openCSV(std::string fileName, std::shared_ptr<arrow::Schema> schema, std::string delimiter, std::string escape) {
+   arrow::io::IOContext ioContext = arrow::io::default_io_context();
+   auto inputFile = arrow::io::ReadableFile::Open(fileName);
+   if (!inputFile.ok()) {
+      throw std::runtime_error("copy failed: " + inputFile.status().ToString());
+   }
+   auto readOptions = arrow::csv::ReadOptions::Defaults();
+   readOptions.use_threads = true;
+
+   auto parseOptions = arrow::csv::ParseOptions::Defaults();
+   parseOptions.delimiter = delimiter.front();
+   if (!escape.empty()) {
+      parseOptions.escape_char = escape.front();
+      parseOptions.escaping = true;
+   }
+   parseOptions.newlines_in_values = true;
+   auto convertOptions = arrow::csv::ConvertOptions::Defaults();
+   convertOptions.null_values.push_back("");
+   convertOptions.strings_can_be_null = true;
+   for (auto f : schema->fields()) {
+      if (f->name().find("primaryKeyHashValue") != std::string::npos) continue;
+      readOptions.column_names.push_back(f->name());
+      convertOptions.column_types.insert({f->name(), f->type()});
+   }
+   auto reader = arrow::csv::StreamingReader::Make(ioContext, inputFile.ValueOrDie(), readOptions, parseOptions, convertOptions);
+   if (!reader.ok()) {
+      throw std::runtime_error("copy failed: " + reader.status().ToString());
+   }
+   return reader.ValueOrDie();
+}
+// reads the record batches of a parquet file and converts them to the schema of the table
+class ParquetBatchReader : public arrow::RecordBatchReader {
+   std::unique_ptr<parquet::arrow::FileReader> fileReader;
+   std::unique_ptr<arrow::RecordBatchReader> reader;
+   std::shared_ptr<arrow::Schema> targetSchema;
+
+   public:
+   ParquetBatchReader(std::unique_ptr<parquet::arrow::FileReader> fileReader, std::unique_ptr<arrow::RecordBatchReader> reader, std::shared_ptr<arrow::Schema> targetSchema) : fileReader(std::move(fileReader)), reader(std::move(reader)), targetSchema(targetSchema) {}
+   std::shared_ptr<arrow::Schema> schema() const override {
+      return targetSchema;
+   }
+   arrow::Status ReadNext(std::shared_ptr<arrow::RecordBatch>* batch) override {
+      std::shared_ptr<arrow::RecordBatch> next;
+      ARROW_RETURN_NOT_OK(reader->ReadNext(&next));
+      if (!next) {
+         *batch = nullptr;
+         return arrow::Status::OK();
+      }
+      std::vector<std::shared_ptr<arrow::Array>> columns;
+      for (const auto& f : targetSchema->fields()) {
+         auto column = next->GetColumnByName(f->name());
+         if (!column) {
+            return arrow::Status::Invalid("parquet file does not contain column ", f->name());
+         }
+         if (f->type()->id() == arrow::Type::DICTIONARY && column->type()->id() != arrow::Type::DICTIONARY) {
+            ARROW_ASSIGN_OR_RAISE(auto encoded, arrow::compute::DictionaryEncode(column));
+            column = encoded.make_array();
+         } else if (!column->type()->Equals(f->type())) {
+            ARROW_ASSIGN_OR_RAISE(column, arrow::compute::Cast(*column, f->type()));
+         }
+         columns.push_back(column);
+      }
+      *batch = arrow::RecordBatch::Make(targetSchema, next->num_rows(), columns);
+      return arrow::Status::OK();
+   }
+};
+std::shared_ptr<arrow::RecordBatchReader> openParquet(std::string fileName, std::shared_ptr<arrow::Schema> schema) {
+   auto readerProperties = parquet::default_arrow_reader_properties();
+   readerProperties.set_use_threads(true);
+   readerProperties.set_batch_size(20000);
+   parquet::arrow::FileReaderBuilder builder;
+   auto status = builder.OpenFile(fileName);
+   std::unique_ptr<parquet::arrow::FileReader> fileReader;
+   if (status.ok()) {
+      status = builder.properties(readerProperties)->Build(&fileReader);
+   }
+   std::unique_ptr<arrow::RecordBatchReader> reader;
+   if (status.ok()) {
+      status = fileReader->GetRecordBatchReader(&reader);
+   }
+   if (!status.ok()) {
+      throw std::runtime_error("copy failed: " + status.ToString());
+   }
+   return std::make_shared<ParquetBatchReader>(std::move(fileReader), std::move(reader), schema);
+}
+} // end namespace
 namespace runtime {
 void RelationHelper::createTable(runtime::ExecutionContext* context, runtime::VarLen32 name, runtime::VarLen32 meta) {
    auto& session = context->getSession();
@@ -28,52 +117,18 @@ void RelationHelper::appendTableFromResult(runtime::VarLen32 tableName, runtime:
       }
    }
 }
-void RelationHelper::copyFromIntoTable(runtime::ExecutionContext* context, runtime::VarLen32 tableName, runtime::VarLen32 fileName, runtime::VarLen32 delimiter, runtime::VarLen32 escape) {
+void RelationHelper::copyFromIntoTable(runtime::ExecutionContext* context, runtime::VarLen32 tableName, runtime::VarLen32 fileName, runtime::VarLen32 delimiter, runtime::VarLen32 escape, runtime::VarLen32 format) {
    auto& session = context->getSession();
    auto catalog = session.getCatalog();
    if (auto relation = catalog->findRelation(tableName)) {
-      arrow::io::IOContext ioContext = arrow::io::default_io_context();
-      auto inputFile = arrow::io::ReadableFile::Open(fileName.str()).ValueOrDie();
-      std::shared_ptr<arrow::io::InputStream> input = inputFile;
-
-      auto readOptions = arrow::csv::ReadOptions::Defaults();
-
-      auto parseOptions = arrow::csv::ParseOptions::Defaults();
-      parseOptions.delimiter = delimiter.str().front();
-      if (escape.getLen() > 0) {
-         parseOptions.escape_char = escape.str().front();
-         parseOptions.escaping = true;
-      }
-      parseOptions.newlines_in_values = true;
-      auto convertOptions = arrow::csv::ConvertOptions::Defaults();
-      auto schema = relation->getArrowSchema();
-      convertOptions.null_values.push_back("");
-      convertOptions.strings_can_be_null = true;
-      for (auto f : schema->fields()) {
-         if (f->name().find("primaryKeyHashValue") != std::string::npos) continue;
-         readOptions.column_names.push_back(f->name());
-         convertOptions.column_types.insert({f->name(), f->type()});
-      }
-
-      // Instantiate TableReader from input stream and options
-      auto maybeReader = arrow::csv::TableReader::Make(ioContext,
-                                                       input,
-                                                       readOptions,
-                                                       parseOptions,
-                                                       convertOptions);
-      if (!maybeReader.ok()) {
-         // Handle TableReader instantiation error...
-      }
-      std::shared_ptr<arrow::csv::TableReader> reader = *maybeReader;
-
-      // Read table from CSV file
-      auto maybeTable = reader->Read();
-      if (!maybeTable.ok()) {
-         // Handle CSV read error
-         // (for example a CSV syntax error or failed type conversion)
+      std::shared_ptr<arrow::RecordBatchReader> reader;
+      if (format.str() == "parquet") {
+         reader = openParquet(fileName.str(), relation->getArrowSchema());
+      } else {
+         reader = openCSV(fileName.str(), relation->getArrowSchema(), delimiter.str(), escape.str());
       }
-      std::shared_ptr<arrow::Table> table = *maybeTable;
-      relation->append(table);
+      // batches are read (and parsed in parallel) while they are appended: the file is never materialized completely
+      relation->appendBatches(reader);
    } else {
       throw std::runtime_error("copy failed: no such table");
    }
@@ -95,6 +150,7 @@ HashIndexAccess* RelationHelper::getIndex(runtime::ExecutionContext* context, ru
       for (auto m : json["mapping"].get<nlohmann::json::object_t>()) {
          cols.push_back(m.second.get<std::string>());
       }
+      context->count("hash index accesses");
       return new HashIndexAccess(*hashIndex, cols);
    } else {
       throw std::runtime_error("no such table");
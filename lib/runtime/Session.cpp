@@ -7,10 +7,34 @@ std::unique_ptr<runtime::ExecutionContext> runtime::Session::createExecutionCont
 std::shared_ptr<runtime::Catalog> runtime::Session::getCatalog() {
    return catalog;
 }
+void runtime::Session::addPreparedStatement(std::string name, std::string sql) {
+   if (preparedStatements.contains(name)) {
+      throw std::runtime_error("prepared statement already exists: " + name);
+   }
+   auto preparedStatement = std::make_shared<PreparedStatement>();
+   preparedStatement->sql = sql;
+   preparedStatements[name] = preparedStatement;
+}
+std::shared_ptr<runtime::PreparedStatement> runtime::Session::getPreparedStatement(std::string name) {
+   if (preparedStatements.contains(name)) {
+      return preparedStatements.at(name);
+   }
+   return {};
+}
+void runtime::Session::removePreparedStatement(std::string name) {
+   if (!preparedStatements.erase(name)) {
+      throw std::runtime_error("prepared statement does not exist: " + name);
+   }
+}
+void runtime::Session::removeAllPreparedStatements() {
+   preparedStatements.clear();
+}
 
 std::shared_ptr<runtime::Session> runtime::Session::createSession() {
    return std::shared_ptr<Session>(new Session(LocalCatalog::create(Catalog::createEmpty())));
 }
 std::shared_ptr<runtime::Session> runtime::Session::createSession(std::string dbDir, bool eagerLoading) {
    return std::shared_ptr<Session>(new Session(DBCatalog::create(Catalog::createEmpty(), dbDir, eagerLoading)));
-}
\ No newline at end of file
+}std::shared_ptr<runtime::Session> runtime::Session::createSession(std::shared_ptr<Catalog> catalog) {
+   return std::shared_ptr<Session>(new Session(catalog));
+}
@@ -15,15 +15,17 @@ uint8_t* runtime::SimpleState::create(runtime::ExecutionContext* executionContex
 
 uint8_t* runtime::SimpleState::merge(runtime::ThreadLocal* threadLocal, void (*merge)(uint8_t*, uint8_t*)) {
    utility::Tracer::Trace trace(mergeEvent);
-   uint8_t* first = nullptr;
-   for (auto* ptr : threadLocal->getTls()) {
-      auto* current = ptr;
-      if (!first) {
-         first = current;
-      } else {
-         merge(first, current);
-      }
+   std::vector<uint8_t*> states(threadLocal->getTls().begin(), threadLocal->getTls().end());
+   //tree reduction: keeps the order of the thread-local states, but merges pairs in parallel
+   for (size_t stride = 1; stride < states.size(); stride *= 2) {
+      tbb::parallel_for(size_t(0), (states.size() + 2 * stride - 1) / (2 * stride), [&](size_t i) {
+         size_t left = i * 2 * stride;
+         size_t right = left + stride;
+         if (right < states.size()) {
+            merge(states[left], states[right]);
+         }
+      });
    }
    trace.stop();
-   return first;
+   return states[0];
 }
\ No newline at end of file
@@ -0,0 +1,208 @@
+#include "runtime/ZoneMap.h"
+
+#include <arrow/api.h>
+#include <arrow/compute/api.h>
+#include <arrow/io/api.h>
+#include <arrow/ipc/api.h>
+
+#include <filesystem>
+#include <optional>
+#include <string_view>
+namespace {
+const std::string rowsColumn = "__rows";
+std::shared_ptr<arrow::Int64Array> getInt64Column(const std::shared_ptr<arrow::RecordBatch>& batch, std::string name) {
+   return std::static_pointer_cast<arrow::Int64Array>(batch->GetColumnByName(name));
+}
+template <class T>
+int compare(const T& left, const T& right) {
+   return left < right ? -1 : (right < left ? 1 : 0);
+}
+template <class ArrowType>
+std::optional<int> comparePrimitive(const arrow::Array& array, int64_t i, const arrow::Scalar& value) {
+   using ArrayType = typename arrow::TypeTraits<ArrowType>::ArrayType;
+   using ScalarType = typename arrow::TypeTraits<ArrowType>::ScalarType;
+   return compare(static_cast<const ArrayType&>(array).Value(i), static_cast<const ScalarType&>(value).value);
+}
+//three-way comparison of a stored min/max value with a restriction value of the same type (nullopt: type is not supported)
+std::optional<int> compareValue(const arrow::Array& array, int64_t i, const arrow::Scalar& value) {
+   switch (array.type_id()) {
+      case arrow::Type::BOOL: return comparePrimitive<arrow::BooleanType>(array, i, value);
+      case arrow::Type::INT8: return comparePrimitive<arrow::Int8Type>(array, i, value);
+      case arrow::Type::INT16: return comparePrimitive<arrow::Int16Type>(array, i, value);
+      case arrow::Type::INT32: return comparePrimitive<arrow::Int32Type>(array, i, value);
+      case arrow::Type::INT64: return comparePrimitive<arrow::Int64Type>(array, i, value);
+      case arrow::Type::UINT8: return comparePrimitive<arrow::UInt8Type>(array, i, value);
+      case arrow::Type::UINT16: return comparePrimitive<arrow::UInt16Type>(array, i, value);
+      case arrow::Type::UINT32: return comparePrimitive<arrow::UInt32Type>(array, i, value);
+      case arrow::Type::UINT64: return comparePrimitive<arrow::UInt64Type>(array, i, value);
+      case arrow::Type::FLOAT: return comparePrimitive<arrow::FloatType>(array, i, value);
+      case arrow::Type::DOUBLE: return comparePrimitive<arrow::DoubleType>(array, i, value);
+      case arrow::Type::DATE32: return comparePrimitive<arrow::Date32Type>(array, i, value);
+      case arrow::Type::DATE64: return comparePrimitive<arrow::Date64Type>(array, i, value);
+      case arrow::Type::TIMESTAMP: return comparePrimitive<arrow::TimestampType>(array, i, value);
+      case arrow::Type::DECIMAL128:
+         return compare(arrow::Decimal128(static_cast<const arrow::Decimal128Array&>(array).GetValue(i)), static_cast<const arrow::Decimal128Scalar&>(value).value);
+      case arrow::Type::STRING:
+         return compare(static_cast<const arrow::StringArray&>(array).GetView(i), std::string_view(*static_cast<const arrow::StringScalar&>(value).value));
+      default: return {};
+   }
+}
+//synopses (one row per record batch) of the given record batches
+std::shared_ptr<arrow::RecordBatch> createSynopses(const std::vector<std::shared_ptr<arrow::RecordBatch>>& recordBatches) {
+   auto schema = recordBatches[0]->schema();
+   arrow::FieldVector fields;
+   std::vector<std::shared_ptr<arrow::Array>> columns;
+   arrow::NumericBuilder<arrow::Int64Type> rowsBuilder;
+   for (const auto& batch : recordBatches) {
+      if (!rowsBuilder.Append(batch->num_rows()).ok()) {
+         throw std::runtime_error("could not create zone map");
+      }
+   }
+   fields.push_back(arrow::field(rowsColumn, arrow::int64()));
+   columns.push_back(rowsBuilder.Finish().ValueOrDie());
+   for (int i = 0; i < schema->num_fields(); i++) {
+      std::vector<std::shared_ptr<arrow::Array>> mins;
+      std::vector<std::shared_ptr<arrow::Array>> maxs;
+      arrow::NumericBuilder<arrow::Int64Type> nullsBuilder;
+      bool supported = true;
+      for (const auto& batch : recordBatches) {
+         auto minMax = arrow::compute::MinMax(batch->column(i));
+         if (!minMax.ok()) {
+            //no min/max for this type: column is not part of the zone map
+            supported = false;
+            break;
+         }
+         auto& minMaxScalar = minMax->scalar_as<arrow::StructScalar>();
+         mins.push_back(arrow::MakeArrayFromScalar(*minMaxScalar.value[0], 1).ValueOrDie());
+         maxs.push_back(arrow::MakeArrayFromScalar(*minMaxScalar.value[1], 1).ValueOrDie());
+         if (!nullsBuilder.Append(batch->column(i)->null_count()).ok()) {
+            throw std::runtime_error("could not create zone map");
+         }
+      }
+      if (!supported) continue;
+      auto name = schema->field(i)->name();
+      fields.push_back(arrow::field(name + ".min", mins[0]->type()));
+      columns.push_back(arrow::Concatenate(mins).ValueOrDie());
+      fields.push_back(arrow::field(name + ".max", maxs[0]->type()));
+      columns.push_back(arrow::Concatenate(maxs).ValueOrDie());
+      fields.push_back(arrow::field(name + ".nulls", arrow::int64()));
+      columns.push_back(nullsBuilder.Finish().ValueOrDie());
+   }
+   return arrow::RecordBatch::Make(arrow::schema(fields), recordBatches.size(), columns);
+}
+//restriction with the parsed value and the synopses of the restricted column
+struct UsableRestriction {
+   std::string cmp;
+   std::shared_ptr<arrow::Scalar> value;
+   std::shared_ptr<arrow::Array> min;
+   std::shared_ptr<arrow::Array> max;
+   std::shared_ptr<arrow::Int64Array> nulls;
+};
+bool canSkip(const UsableRestriction& r, int64_t batch, int64_t rows) {
+   //comparisons with null values are never true
+   if (r.nulls->Value(batch) == rows) {
+      return true;
+   }
+   if (r.min->IsNull(batch) || r.max->IsNull(batch)) {
+      return false;
+   }
+   auto valueMin = compareValue(*r.min, batch, *r.value);
+   auto valueMax = compareValue(*r.max, batch, *r.value);
+   if (!valueMin || !valueMax) {
+      return false;
+   }
+   //valueMin/valueMax: min/max compared to the value
+   if (r.cmp == "eq") return *valueMin > 0 || *valueMax < 0;
+   if (r.cmp == "lt") return *valueMin >= 0;
+   if (r.cmp == "lte") return *valueMin > 0;
+   if (r.cmp == "gt") return *valueMax <= 0;
+   if (r.cmp == "gte") return *valueMax < 0;
+   return false;
+}
+} // end namespace
+
+std::shared_ptr<runtime::ZoneMap> runtime::ZoneMap::create(const std::vector<std::shared_ptr<arrow::RecordBatch>>& recordBatches) {
+   if (recordBatches.empty()) {
+      return {};
+   }
+   return std::make_shared<ZoneMap>(createSynopses(recordBatches));
+}
+std::shared_ptr<runtime::ZoneMap> runtime::ZoneMap::extend(const std::vector<std::shared_ptr<arrow::RecordBatch>>& recordBatches, size_t first) const {
+   if (first == 0 || first > static_cast<size_t>(synopses->num_rows()) || first > recordBatches.size()) {
+      return create(recordBatches);
+   }
+   auto rows = getInt64Column(synopses, rowsColumn);
+   for (size_t i = 0; i < first; i++) {
+      if (rows->Value(i) != recordBatches[i]->num_rows()) {
+         return create(recordBatches);
+      }
+   }
+   auto kept = synopses->Slice(0, first);
+   if (first == recordBatches.size()) {
+      return std::make_shared<ZoneMap>(kept);
+   }
+   auto added = createSynopses({recordBatches.begin() + first, recordBatches.end()});
+   //e.g., a column without min/max in the new batches: the zone map is created again
+   if (!added->schema()->Equals(*synopses->schema())) {
+      return create(recordBatches);
+   }
+   std::vector<std::shared_ptr<arrow::Array>> columns;
+   for (int i = 0; i < synopses->num_columns(); i++) {
+      columns.push_back(arrow::Concatenate({kept->column(i), added->column(i)}).ValueOrDie());
+   }
+   return std::make_shared<ZoneMap>(arrow::RecordBatch::Make(synopses->schema(), recordBatches.size(), columns));
+}
+std::shared_ptr<runtime::ZoneMap> runtime::ZoneMap::load(std::string file) {
+   auto inputFile = arrow::io::ReadableFile::Open(file).ValueOrDie();
+   auto batchReader = arrow::ipc::RecordBatchFileReader::Open(inputFile).ValueOrDie();
+   if (batchReader->num_record_batches() != 1) {
+      return {};
+   }
+   return std::make_shared<ZoneMap>(batchReader->ReadRecordBatch(0).ValueOrDie());
+}
+void runtime::ZoneMap::store(std::string file) {
+   auto tmpFile = file + ".tmp";
+   auto outputFile = arrow::io::FileOutputStream::Open(tmpFile).ValueOrDie();
+   auto batchWriter = arrow::ipc::MakeFileWriter(outputFile, synopses->schema()).ValueOrDie();
+   if (!batchWriter->WriteRecordBatch(*synopses).ok() || !batchWriter->Close().ok() || !outputFile->Close().ok()) {
+      throw std::runtime_error("could not store zone map");
+   }
+   std::filesystem::rename(tmpFile, file);
+}
+std::vector<std::shared_ptr<arrow::RecordBatch>> runtime::ZoneMap::filter(const std::vector<std::shared_ptr<arrow::RecordBatch>>& recordBatches, const std::vector<ScanRestriction>& restrictions) {
+   //only use the zone map if it still describes the given record batches
+   if (restrictions.empty() || static_cast<size_t>(synopses->num_rows()) != recordBatches.size()) {
+      return recordBatches;
+   }
+   auto rows = getInt64Column(synopses, rowsColumn);
+   for (size_t i = 0; i < recordBatches.size(); i++) {
+      if (rows->Value(i) != recordBatches[i]->num_rows()) {
+         return recordBatches;
+      }
+   }
+   std::vector<UsableRestriction> usableRestrictions;
+   for (const auto& r : restrictions) {
+      auto min = synopses->GetColumnByName(r.column + ".min");
+      if (!min) continue;
+      auto value = arrow::Scalar::Parse(min->type(), r.value);
+      if (!value.ok() || !value.ValueOrDie()->is_valid) continue;
+      usableRestrictions.push_back({r.cmp, value.ValueOrDie(), min, synopses->GetColumnByName(r.column + ".max"), getInt64Column(synopses, r.column + ".nulls")});
+   }
+   if (usableRestrictions.empty()) {
+      return recordBatches;
+   }
+   std::vector<std::shared_ptr<arrow::RecordBatch>> res;
+   for (size_t i = 0; i < recordBatches.size(); i++) {
+      bool skip = false;
+      for (const auto& r : usableRestrictions) {
+         if (canSkip(r, i, rows->Value(i))) {
+            skip = true;
+            break;
+         }
+      }
+      if (!skip) {
+         res.push_back(recordBatches[i]);
+      }
+   }
+   return res;
+}
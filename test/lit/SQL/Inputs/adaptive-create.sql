@@ -0,0 +1,4 @@
+create table digits(x integer);
+insert into digits values (0), (1), (2), (3), (4), (5), (6), (7), (8), (9);
+create table items(id integer, grp integer);
+insert into items select a.x * 1000 + b.x * 100 + c.x * 10 + d.x, d.x from digits a, digits b, digits c, digits d;
@@ -0,0 +1,2 @@
+create table items(id integer, category char(12));
+create table points(id integer, x integer);
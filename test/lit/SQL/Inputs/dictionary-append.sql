@@ -0,0 +1,2 @@
+insert into orders values (1000, 'returned'), (1001, 'returned'), (1002, 'open');
+insert into statuses values (3, 'returned'), (4, 'lost');
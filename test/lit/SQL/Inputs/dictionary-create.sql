@@ -0,0 +1,6 @@
+create table digits(x integer);
+insert into digits values (0), (1), (2), (3), (4), (5), (6), (7), (8), (9);
+create table statuses(s integer, status char(12));
+insert into statuses values (0, 'open'), (1, 'shipped'), (2, 'delivered');
+create table orders(id integer, status char(12));
+insert into orders select b.x * 100 + c.x * 10 + d.x as id, s.status from digits b, digits c, digits d, statuses s where (b.x * 100 + c.x * 10 + d.x) % 3 = s.s order by id;
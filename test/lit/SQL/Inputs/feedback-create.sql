@@ -0,0 +1,4 @@
+create table a(id integer);
+insert into a values (1), (2), (3), (4), (5), (6), (7), (8), (9), (10);
+create table b(id integer);
+insert into b values (1), (2), (3), (4), (5), (6), (7), (8), (9), (10);
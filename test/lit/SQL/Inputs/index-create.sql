@@ -0,0 +1,6 @@
+create table digits(x integer);
+insert into digits values (0), (1), (2), (3), (4), (5), (6), (7), (8), (9);
+create table items(id integer primary key, v integer);
+insert into items select a.x * 100 + b.x * 10 + c.x as id, a.x * 100 + b.x * 10 + c.x + 7 as v from digits a, digits b, digits c;
+create table probes(id integer);
+insert into probes values (5), (500), (999), (1500), (1999);
@@ -0,0 +1,4 @@
+create table digits(x integer);
+insert into digits values (0), (1), (2), (3), (4), (5), (6), (7), (8), (9);
+create table items(id integer);
+insert into items select a.x * 10000 + b.x * 1000 + c.x * 100 + d.x * 10 + e.x from digits a, digits b, digits c, digits d, digits e;
@@ -0,0 +1,2 @@
+create table items(id integer, label char(12));
+insert into items values (1, 'a'), (2, 'b'), (3, 'a'), (4, 'c');
@@ -0,0 +1,6 @@
+create table digits(x integer);
+insert into digits values (0), (1), (2), (3), (4), (5), (6), (7), (8), (9);
+create table small(id integer, v integer);
+insert into small select a.x * 100 + b.x * 10 + c.x + 1, a.x * 100 + b.x * 10 + c.x + 1 from digits a, digits b, digits c;
+create table large(id integer);
+insert into large select a.x * 1000 + b.x * 100 + c.x * 10 + d.x + 1 from digits a, digits b, digits c, digits d;
@@ -0,0 +1 @@
+insert into items select g.a * 10000 + b.x * 1000 + c.x * 100 + d.x * 10 + e.x as id, g.day, cast(g.a * 10000 + b.x * 1000 + c.x * 100 + d.x * 10 + e.x as decimal(10,2)), g.label from categories g, digits b, digits c, digits d, digits e where g.a >= 5 order by id;
@@ -0,0 +1,6 @@
+create table digits(x integer);
+insert into digits values (0), (1), (2), (3), (4), (5), (6), (7), (8), (9);
+create table categories(a integer, day date, label varchar(10));
+insert into categories values (0, date '2000-01-01', 'l0'), (1, date '2001-01-01', 'l1'), (2, date '2002-01-01', 'l2'), (3, date '2003-01-01', 'l3'), (4, date '2004-01-01', 'l4'), (5, date '2005-01-01', 'l5'), (6, date '2006-01-01', 'l6'), (7, date '2007-01-01', 'l7'), (8, date '2008-01-01', 'l8'), (9, date '2009-01-01', 'l9');
+create table items(id integer, day date, price decimal(10,2), label varchar(10));
+insert into items select g.a * 10000 + b.x * 1000 + c.x * 100 + d.x * 10 + e.x as id, g.day, cast(g.a * 10000 + b.x * 1000 + c.x * 100 + d.x * 10 + e.x as decimal(10,2)), g.label from categories g, digits b, digits c, digits d, digits e where g.a < 5 order by id;
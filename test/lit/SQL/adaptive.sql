@@ -0,0 +1,18 @@
+--// tiered execution: with LINGODB_ADAPTIVE_SWITCH=FORCE, the cranelift code switches to the LLVM code for every pipeline, the result must not change
+--// REQUIRES: cranelift
+--// RUN: rm -rf %t && mkdir -p %t
+--// RUN: sql %t < %S/Inputs/adaptive-create.sql
+--// RUN: sql %t < %s | FileCheck %s
+--// RUN: env LINGODB_EXECUTION_MODE=ADAPTIVE LINGODB_ADAPTIVE_SWITCH=FORCE sql %t < %s | FileCheck %s
+--// RUN: env LINGODB_EXECUTION_MODE=ADAPTIVE LINGODB_ADAPTIVE_SWITCH=FORCE LINGODB_COUNTERS=ON sql %t < %s 2>&1 > /dev/null | FileCheck %s --check-prefix=SWITCHED
+
+select grp, count(*) as cnt, sum(id) as total from items group by grp order by grp limit 3;
+--//CHECK: | grp | cnt | total |
+--//CHECK: | 0 | 1000 | 4995000 |
+--//CHECK: | 1 | 1000 | 4996000 |
+--//CHECK: | 2 | 1000 | 4997000 |
+--//SWITCHED: optimized functions: {{[1-9][0-9]*}}
+select count(*) as cnt from items a, digits d where a.grp = d.x and a.id < 100;
+--//CHECK: | cnt |
+--//CHECK: | 100 |
+--//SWITCHED: optimized functions: {{[1-9][0-9]*}}
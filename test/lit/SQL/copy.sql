@@ -0,0 +1,26 @@
+--// every copy is streamed into its own data file, also for dictionary-encoded columns; later runs read all of them
+--// RUN: rm -rf %t && mkdir -p %t
+--// RUN: env LINGODB_DICTIONARY_ENCODING=ON sql %t < %S/Inputs/copy-create.sql > /dev/null
+--// RUN: echo "copy items from '%S/Inputs/copy-items-1.csv' delimiter '|'; copy points from '%S/Inputs/copy-points.csv';" | sql %t > /dev/null
+--// RUN: echo "copy items from '%S/Inputs/copy-items-2.csv' delimiter '|'; copy points from '%S/Inputs/copy-points.csv';" | sql %t > /dev/null
+--// RUN: sql %t < %s | FileCheck %s
+
+select count(*) as cnt, sum(id) as total from items;
+--//CHECK: | cnt | total |
+--//CHECK: | 7 | 21 |
+
+--// codes of the second copy extend the dictionary of the first one
+select category, count(*) as cnt from items group by category order by category;
+--//CHECK: | category | cnt |
+--//CHECK: | "garden" | 2 |
+--//CHECK: | "kitchen" | 1 |
+--//CHECK: | "tools" | 3 |
+--//CHECK: | "toys" | 1 |
+
+select count(*) as cnt from items where category = 'toys';
+--//CHECK: | cnt |
+--//CHECK: | 1 |
+
+select count(*) as cnt, sum(x) as total from points;
+--//CHECK: | cnt | total |
+--//CHECK: | 6 | 120 |
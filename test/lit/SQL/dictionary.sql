@@ -0,0 +1,55 @@
+--// char(n) columns are created dictionary-encoded, later runs only rely on the stored metadata
+--// only filters compare dictionary codes, group by and joins work on the decoded strings
+--// RUN: rm -rf %t && mkdir -p %t
+--// RUN: env LINGODB_DICTIONARY_ENCODING=ON sql %t < %S/Inputs/dictionary-create.sql > /dev/null
+--// RUN: sql %t < %S/Inputs/dictionary-append.sql > /dev/null
+--// RUN: sql %t < %s | FileCheck %s
+
+--// scan
+select id, status from orders where id < 3 order by id;
+--//CHECK: | id | status |
+--//CHECK: | 0 | "open" |
+--//CHECK: | 1 | "shipped" |
+--//CHECK: | 2 | "delivered" |
+
+--// equality restrictions compare dictionary codes, also for values only contained in appended record batches
+select count(*) as cnt from orders where status = 'shipped';
+--//CHECK: | cnt |
+--//CHECK: | 333 |
+select count(*) as cnt, min(id) as lo from orders where status = 'returned';
+--//CHECK: | cnt | lo |
+--//CHECK: | 2 | 1000 |
+select count(*) as cnt from orders where status = 'lost';
+--//CHECK: | cnt |
+--//CHECK: | 0 |
+select count(*) as cnt from orders where status = 'open' and id >= 990;
+--//CHECK: | cnt |
+--//CHECK: | 5 |
+select count(*) as cnt from orders where status > 'open';
+--//CHECK: | cnt |
+--//CHECK: | 335 |
+
+--// group by
+select status, count(*) as cnt from orders group by status order by status;
+--//CHECK: | status | cnt |
+--//CHECK: | "delivered" | 333 |
+--//CHECK: | "open" | 335 |
+--//CHECK: | "returned" | 2 |
+--//CHECK: | "shipped" | 333 |
+
+--// join on dictionary-encoded columns
+select st.s, count(*) as cnt from orders o, statuses st where o.status = st.status group by st.s order by st.s;
+--//CHECK: | s | cnt |
+--//CHECK: | 0 | 335 |
+--//CHECK: | 1 | 333 |
+--//CHECK: | 2 | 333 |
+--//CHECK: | 3 | 2 |
+
+--// prepared statement with a parameter restricting a dictionary-encoded column
+prepare by_status as select count(*) as cnt from orders where status = $1;
+execute by_status('delivered');
+--//CHECK: | cnt |
+--//CHECK: | 333 |
+execute by_status('returned');
+--//CHECK: | cnt |
+--//CHECK: | 2 |
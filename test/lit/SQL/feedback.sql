@@ -0,0 +1,26 @@
+--// observed cardinalities are stored per subplan and table size: inserting rows starts new observations, predicates on parameters are not recorded
+--// RUN: rm -rf %t && mkdir -p %t
+--// RUN: sql %t < %S/Inputs/feedback-create.sql
+--// RUN: env LINGODB_CARDINALITY_FEEDBACK=ON sql %t < %s | FileCheck %s
+--// RUN: FileCheck %s --check-prefix=FEEDBACK < %t/cardinalities.json
+
+select count(*) as cnt from a, b where a.id = b.id;
+--//CHECK: | cnt |
+--//CHECK: | 10 |
+insert into a values (11), (12);
+select count(*) as cnt from a, b where a.id = b.id;
+--//CHECK: | cnt |
+--//CHECK: | 10 |
+prepare smaller as select count(*) as cnt from a, b where a.id = b.id and b.id < $1;
+execute smaller(5);
+--//CHECK: | cnt |
+--//CHECK: | 4 |
+execute smaller(8);
+--//CHECK: | cnt |
+--//CHECK: | 7 |
+
+--//FEEDBACK-NOT: GetParameter
+--//FEEDBACK: "a@10,b@10,|a.id=b.id&"
+--//FEEDBACK-NOT: GetParameter
+--//FEEDBACK: "a@12,b@10,|a.id=b.id&"
+--//FEEDBACK-NOT: GetParameter
@@ -0,0 +1,29 @@
+--// joins with the primary key of a large table look up the hash index, rows appended later are found as well (also after a restart)
+--// RUN: rm -rf %t && mkdir -p %t
+--// RUN: sql %t < %S/Inputs/index-create.sql > /dev/null
+--// RUN: env LINGODB_COUNTERS=ON sql %t < %s 2> %t/counters.txt | FileCheck %s
+--// RUN: FileCheck %s --check-prefix=INDEX < %t/counters.txt
+--// RUN: echo "select count(*) as cnt, sum(i.v) as total from items i, probes p where i.id = p.id;" | sql %t | FileCheck %s --check-prefix=RESTART
+
+select count(*) as cnt, sum(i.v) as total from items i, probes p where i.id = p.id;
+--//CHECK: | cnt | total |
+--//CHECK: | 3 | 1525 |
+--//INDEX: hash index accesses: 1
+insert into items select 1000 + a.x * 100 + b.x * 10 + c.x as id, 1000 + a.x * 100 + b.x * 10 + c.x + 7 as v from digits a, digits b, digits c;
+select count(*) as cnt, sum(i.v) as total from items i, probes p where i.id = p.id;
+--//CHECK: | cnt | total |
+--//CHECK: | 5 | 5038 |
+--//INDEX: hash index accesses: 1
+insert into items values (2000, 2007), (2001, 2008);
+insert into probes values (2001);
+select i.id, i.v from items i, probes p where i.id = p.id order by i.id;
+--//CHECK: | id | v |
+--//CHECK: | 5 | 12 |
+--//CHECK: | 500 | 507 |
+--//CHECK: | 999 | 1006 |
+--//CHECK: | 1500 | 1507 |
+--//CHECK: | 1999 | 2006 |
+--//CHECK: | 2001 | 2008 |
+--//INDEX: hash index accesses: 1
+--//RESTART: | cnt | total |
+--//RESTART: | 6 | 7046 |
@@ -0,0 +1,18 @@
+--// build sides whose hash table exceeds one cache-sized partition (2^15 buckets) are built partitioned, the probe is unchanged
+--// RUN: rm -rf %t && mkdir -p %t
+--// RUN: sql %t < %S/Inputs/join-create.sql
+--// RUN: sql %t < %s | FileCheck %s
+--// RUN: echo "select count(*) from items a, items b where a.id = b.id;" | env LINGODB_COUNTERS=ON sql %t 2>&1 > /dev/null | FileCheck %s --check-prefix=PARTITIONED
+--// RUN: echo "select count(*) from items a, digits d where a.id = d.x;" | env LINGODB_COUNTERS=ON sql %t 2>&1 > /dev/null | FileCheck %s --allow-empty --check-prefix=SMALL
+--//PARTITIONED: partitioned hash table builds: 1
+--//SMALL-NOT: partitioned hash table builds
+
+select count(*) as cnt, sum(cast(a.id as bigint)) as total from items a, items b where a.id = b.id;
+--//CHECK: | cnt | total |
+--//CHECK: | 100000 | 4999950000 |
+select count(*) as cnt, sum(cast(a.id as bigint)) as total from items a, items b where a.id = b.id + 50000;
+--//CHECK: | cnt | total |
+--//CHECK: | 50000 | 3749975000 |
+select count(*) as cnt from items a, digits d where a.id = d.x;
+--//CHECK: | cnt |
+--//CHECK: | 10 |
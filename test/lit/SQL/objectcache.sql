@@ -0,0 +1,22 @@
+--// compiled queries are cached in LINGODB_OBJECT_CACHE: the same query is loaded from the cache, a changed table schema invalidates the cached object
+--// RUN: rm -rf %t && mkdir -p %t/db %t/cache
+--// RUN: sql %t/db < %S/Inputs/objectcache-create.sql > /dev/null
+--// RUN: env LINGODB_OBJECT_CACHE=%t/cache LINGODB_COUNTERS=ON sql %t/db < %s 2> %t/miss.txt | FileCheck %s
+--// RUN: FileCheck %s --check-prefix=MISS < %t/miss.txt
+--// RUN: env LINGODB_OBJECT_CACHE=%t/cache LINGODB_COUNTERS=ON sql %t/db < %s 2> %t/hit.txt | FileCheck %s
+--// RUN: FileCheck %s --check-prefix=HIT < %t/hit.txt
+--// same query on a table with a dictionary-encoded column
+--// RUN: rm -rf %t/db && mkdir -p %t/db
+--// RUN: env LINGODB_DICTIONARY_ENCODING=ON sql %t/db < %S/Inputs/objectcache-create.sql > /dev/null
+--// RUN: env LINGODB_OBJECT_CACHE=%t/cache LINGODB_COUNTERS=ON sql %t/db < %s 2> %t/invalidated.txt | FileCheck %s
+--// RUN: FileCheck %s --check-prefix=MISS < %t/invalidated.txt
+
+select label, count(*) as cnt, sum(id) as total from items group by label order by label;
+--//CHECK: | label | cnt | total |
+--//CHECK: | "a" | 2 | 4 |
+--//CHECK: | "b" | 1 | 2 |
+--//CHECK: | "c" | 1 | 4 |
+--//MISS-NOT: object cache hits
+--//MISS: object cache misses: 1
+--//HIT: object cache hits: 1
+--//HIT-NOT: object cache misses
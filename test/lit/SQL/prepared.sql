@@ -0,0 +1,41 @@
+--// RUN: rm -rf %t && mkdir -p %t
+--// RUN: sql %t < %s 2>&1 | FileCheck %s
+
+create table items(id integer, price decimal(5,2), label varchar(10), added date);
+insert into items values (1, 1.50, 'a', date '2020-01-01'), (2, 2.50, 'b', date '2020-06-01'), (3, 3.50, 'c', date '2021-01-01');
+
+--// with declared types
+prepare by_id(integer) as select label from items where id = $1;
+execute by_id(2);
+--//CHECK: | label |
+--//CHECK: | "b" |
+execute by_id(3);
+--//CHECK: | label |
+--//CHECK: | "c" |
+
+--// without declared types, parameters are casted by the expression using them
+prepare cheaper as select count(*) as cnt from items where price < $1 and added >= $2;
+execute cheaper('3.00', '2020-01-01');
+--//CHECK: | cnt |
+--//CHECK: | 2 |
+execute cheaper('4.00', '2020-03-01');
+--//CHECK: | cnt |
+--//CHECK: | 2 |
+execute cheaper('2.00', '2020-01-01');
+--//CHECK: | cnt |
+--//CHECK: | 1 |
+
+--// wrong number of parameters
+execute by_id(1, 2);
+--//CHECK: ERROR: wrong number of parameters for prepared statement: by_id
+execute cheaper('1.00');
+--//CHECK: ERROR: wrong number of parameters for prepared statement: cheaper
+
+--// deallocated statements can not be executed anymore
+deallocate by_id;
+execute by_id(1);
+--//CHECK: ERROR: prepared statement does not exist: by_id
+prepare by_id(integer) as select price from items where id = $1;
+execute by_id(1);
+--//CHECK: | price |
+--//CHECK: | 1.50 |
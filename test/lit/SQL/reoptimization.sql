@@ -0,0 +1,19 @@
+--// the cached plan of a prepared statement is optimized for the first parameter values: a misestimated build side restarts the query, the result must not change
+--// RUN: rm -rf %t && mkdir -p %t
+--// RUN: sql %t < %S/Inputs/reoptimization-create.sql
+--// RUN: sql %t < %s | FileCheck %s
+--// RUN: env LINGODB_REOPTIMIZATION_FACTOR=4 sql %t < %s | FileCheck %s
+--// RUN: env LINGODB_REOPTIMIZATION_FACTOR=4 LINGODB_COUNTERS=ON sql %t < %s 2>&1 > /dev/null | FileCheck %s --check-prefix=RESTARTED
+
+prepare matches as select count(*) as cnt from small, large where small.id = large.id and small.v < $1;
+execute matches(500);
+--//CHECK: | cnt |
+--//CHECK: | 499 |
+execute matches(5);
+--//CHECK: | cnt |
+--//CHECK: | 4 |
+execute matches(5);
+--//CHECK: | cnt |
+--//CHECK: | 4 |
+--//RESTARTED: query restarts: 1
+--//RESTARTED-NOT: query restarts
@@ -0,0 +1,76 @@
+# RUN: rm -rf %t && mkdir -p %t
+# RUN: python3 %s sql %t | FileCheck %s
+
+import os
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+sql, db_dir = sys.argv[1], sys.argv[2]
+# unix socket paths are limited to ~100 characters
+socket_path = os.path.join(tempfile.mkdtemp(), "lingodb.sock")
+server = subprocess.Popen([sql, db_dir, "--server", socket_path], stdout=subprocess.DEVNULL)
+
+
+def connect():
+    for _ in range(100):
+        try:
+            s = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+            s.connect(socket_path)
+            return s
+        except OSError:
+            time.sleep(0.1)
+    raise RuntimeError("could not connect to server")
+
+
+def receive(s, length):
+    data = b""
+    while len(data) < length:
+        chunk = s.recv(length - len(data))
+        if not chunk:
+            raise RuntimeError("connection closed")
+        data += chunk
+    return data
+
+
+def request(s, line):
+    s.sendall((line + "\n").encode())
+    status = receive(s, 1)[0]
+    length = struct.unpack("<Q", receive(s, 8))[0]
+    payload = receive(s, length)
+    # results are arrow ipc streams, only errors are printed
+    print("status:", status, payload.decode() if status else "result" if length else "empty")
+
+
+try:
+    first = connect()
+    second = connect()
+    # CHECK: status: 0 empty
+    request(first, "\\priority high")
+    # CHECK-NEXT: status: 0 empty
+    request(first, "\\threads 2")
+    # CHECK-NEXT: status: 1 unknown command: \priority urgent
+    request(first, "\\priority urgent")
+    # CHECK-NEXT: status: 1 unknown command: \threads many
+    request(first, "\\threads many")
+    # CHECK-NEXT: status: 0 empty
+    request(first, "create table t(x integer);")
+    # CHECK-NEXT: status: 0 empty
+    request(first, "insert into t values (1), (2);")
+    # CHECK-NEXT: status: 0 result
+    request(second, "select sum(x) from t;")
+    # CHECK-NEXT: status: 0 empty
+    request(first, "prepare p as select x from t where x = $1;")
+    # CHECK-NEXT: status: 0 result
+    request(first, "execute p(1);")
+    # prepared statements belong to the connection
+    # CHECK-NEXT: status: 1 {{.*}}prepared statement does not exist: p
+    request(second, "execute p(1);")
+    # errors do not close the connection
+    # CHECK-NEXT: status: 0 result
+    request(second, "select count(*) from t;")
+finally:
+    server.kill()
@@ -0,0 +1,94 @@
+--// sorts with a non-nullable first criterion use a radix sort on a normalized key, ties are broken by the compare function
+--// RUN: rm -rf %t && mkdir -p %t
+--// RUN: sql %t < %s | FileCheck %s
+
+create table items(id integer not null, k integer not null, d decimal(10,2) not null, day date not null, c integer not null, name varchar(10) not null, n integer);
+insert into items values (1, 5, 1.50, date '2020-01-03', 7, 'e', 3), (2, -3, -2.25, date '1969-12-31', 7, 'b', null), (3, 5, 1.50, date '2020-01-03', 7, 'a', 1), (4, 1000000, 100.00, date '2030-06-01', 7, 'd', null), (5, -3, -2.25, date '1969-12-31', 7, 'c', 2), (6, 0, 0.00, date '2000-01-01', 7, 'f', 1), (7, 5, 1.50, date '2020-01-03', 7, 'g', null);
+
+--// descending key, ties broken by the second criterion
+select id from items order by k desc, name;
+--//CHECK: | id |
+--//CHECK: | 4 |
+--//CHECK-NEXT: | 3 |
+--//CHECK-NEXT: | 1 |
+--//CHECK-NEXT: | 7 |
+--//CHECK-NEXT: | 6 |
+--//CHECK-NEXT: | 2 |
+--//CHECK-NEXT: | 5 |
+select id from items order by d desc, name desc;
+--//CHECK: | id |
+--//CHECK: | 4 |
+--//CHECK-NEXT: | 7 |
+--//CHECK-NEXT: | 1 |
+--//CHECK-NEXT: | 3 |
+--//CHECK-NEXT: | 6 |
+--//CHECK-NEXT: | 5 |
+--//CHECK-NEXT: | 2 |
+select id from items order by day, id desc;
+--//CHECK: | id |
+--//CHECK: | 5 |
+--//CHECK-NEXT: | 2 |
+--//CHECK-NEXT: | 6 |
+--//CHECK-NEXT: | 7 |
+--//CHECK-NEXT: | 3 |
+--//CHECK-NEXT: | 1 |
+--//CHECK-NEXT: | 4 |
+
+--// all keys are equal: only the compare function orders the rows
+select id from items order by c, name desc;
+--//CHECK: | id |
+--//CHECK: | 7 |
+--//CHECK-NEXT: | 6 |
+--//CHECK-NEXT: | 1 |
+--//CHECK-NEXT: | 4 |
+--//CHECK-NEXT: | 5 |
+--//CHECK-NEXT: | 2 |
+--//CHECK-NEXT: | 3 |
+
+--// NULLs in the criteria breaking ties (last in ascending, first in descending order)
+select id from items order by k, n;
+--//CHECK: | id |
+--//CHECK: | 5 |
+--//CHECK-NEXT: | 2 |
+--//CHECK-NEXT: | 6 |
+--//CHECK-NEXT: | 3 |
+--//CHECK-NEXT: | 1 |
+--//CHECK-NEXT: | 7 |
+--//CHECK-NEXT: | 4 |
+select id from items order by k, n desc;
+--//CHECK: | id |
+--//CHECK: | 2 |
+--//CHECK-NEXT: | 5 |
+--//CHECK-NEXT: | 6 |
+--//CHECK-NEXT: | 7 |
+--//CHECK-NEXT: | 1 |
+--//CHECK-NEXT: | 3 |
+--//CHECK-NEXT: | 4 |
+--// nullable first criterion: sorted with the compare function only
+select id from items order by n desc, id;
+--//CHECK: | id |
+--//CHECK: | 2 |
+--//CHECK-NEXT: | 4 |
+--//CHECK-NEXT: | 7 |
+--//CHECK-NEXT: | 1 |
+--//CHECK-NEXT: | 5 |
+--//CHECK-NEXT: | 3 |
+--//CHECK-NEXT: | 6 |
+
+--// enough distinct keys to spread over many radix buckets
+create table digits(x integer not null);
+insert into digits values (0), (1), (2), (3), (4), (5), (6), (7), (8), (9);
+create table big(id integer not null, k integer not null, g integer not null);
+insert into big select a.x * 1000 + b.x * 100 + c.x * 10 + d.x, (a.x * 1000 + b.x * 100 + c.x * 10 + d.x) * 7919 % 10000 - 5000, (a.x * 1000 + b.x * 100 + c.x * 10 + d.x) % 3 from digits a, digits b, digits c, digits d;
+select id, k from big order by k desc;
+--//CHECK: | id | k |
+--//CHECK: | 2321 | 4999 |
+--//CHECK-NEXT: | 4642 | 4998 |
+--//CHECK-NEXT: | 6963 | 4997 |
+--//CHECK-NEXT: | 9284 | 4996 |
+select id from big order by g, id desc;
+--//CHECK: | id |
+--//CHECK: | 9999 |
+--//CHECK-NEXT: | 9996 |
+--//CHECK-NEXT: | 9993 |
+--//CHECK-NEXT: | 9990 |
@@ -0,0 +1,24 @@
+--// pre-aggregation spills to temporary files once the memory limit (1 MiB) is exceeded, join builds are mapped from temporary files: the result must not change
+--// RUN: rm -rf %t && mkdir -p %t
+--// RUN: env LINGODB_MEMORY_LIMIT=1 sql %t < %s | FileCheck %s
+--// RUN: echo "select g, count(*) from (select id % 50000 as g from items) i group by g;" | env LINGODB_MEMORY_LIMIT=1 LINGODB_COUNTERS=ON sql %t 2>&1 > /dev/null | FileCheck %s --check-prefix=AGGREGATION
+--// RUN: echo "select count(*) from items a, items b where a.id = b.id;" | env LINGODB_MEMORY_LIMIT=1 LINGODB_COUNTERS=ON sql %t 2>&1 > /dev/null | FileCheck %s --check-prefix=JOIN
+--//AGGREGATION: pre-aggregation spills: {{[1-9][0-9]*}}
+--//JOIN: spilled arena chunks: {{[1-9][0-9]*}}
+
+create table digits(x integer);
+insert into digits values (0), (1), (2), (3), (4), (5), (6), (7), (8), (9);
+create table labels(x integer, label varchar(10));
+insert into labels values (0, 'l0'), (1, 'l1'), (2, 'l2'), (3, 'l3'), (4, 'l4'), (5, 'l5'), (6, 'l6'), (7, 'l7'), (8, 'l8'), (9, 'l9');
+create table items(id integer, label varchar(10));
+insert into items select a.x * 10000 + b.x * 1000 + c.x * 100 + d.x * 10 + l.x as id, l.label from digits a, digits b, digits c, digits d, labels l;
+
+select count(*) as cnt, sum(n) as total, min(n) as lo, max(n) as hi, min(s) as slo, max(s) as shi from (select g, count(*) as n, sum(id) as s from (select id % 50000 as g, id from items) i group by g) t;
+--//CHECK: | cnt | total | lo | hi | slo | shi |
+--//CHECK: | 50000 | 100000 | 2 | 2 | 50000 | 149998 |
+select count(*) as cnt, min(n) as lo, max(n) as hi from (select g, label, count(*) as n from (select id % 30000 as g, label from items) i group by g, label) t;
+--//CHECK: | cnt | lo | hi |
+--//CHECK: | 30000 | 3 | 4 |
+select count(*) as cnt, sum(cast(a.id as bigint)) as total from items a, items b where a.id = b.id;
+--//CHECK: | cnt | total |
+--//CHECK: | 100000 | 4999950000 |
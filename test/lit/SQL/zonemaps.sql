@@ -0,0 +1,41 @@
+--// record batches (20000 rows) are clustered by id: restrictions on all columns allow to skip most of them
+--// RUN: rm -rf %t && mkdir -p %t
+--// RUN: sql %t < %S/Inputs/zonemaps-create.sql > /dev/null
+--// RUN: cp %t/items.arrow.zonemap %t/items.arrow.zonemap.old
+--// RUN: sql %t < %S/Inputs/zonemaps-append.sql > /dev/null
+--// RUN: sql %t < %s | FileCheck %s
+--// RUN: env LINGODB_COUNTERS=ON sql %t < %s 2>&1 > /dev/null | FileCheck %s --check-prefix=SKIPPED
+--// a stale zone map (of the table before the append) is ignored
+--// RUN: cp %t/items.arrow.zonemap.old %t/items.arrow.zonemap
+--// RUN: sql %t < %s | FileCheck %s
+--// RUN: env LINGODB_COUNTERS=ON sql %t < %s 2>&1 > /dev/null | FileCheck %s --check-prefix=STALE
+--//STALE-COUNT-7: skipped record batches: 0
+
+select count(*) as cnt from items where day >= date '2003-01-01' and day < date '2005-01-01';
+--//CHECK: | cnt |
+--//CHECK: | 20000 |
+--//SKIPPED: skipped record batches: 3
+select count(*) as cnt, min(id) as lo, max(id) as hi from items where price < 15000.00;
+--//CHECK: | cnt | lo | hi |
+--//CHECK: | 15000 | 0 | 14999 |
+--//SKIPPED: skipped record batches: 4
+select count(*) as cnt, min(id) as lo, max(id) as hi from items where price >= 99990.50;
+--//CHECK: | cnt | lo | hi |
+--//CHECK: | 9 | 99991 | 99999 |
+--//SKIPPED: skipped record batches: 4
+select count(*) as cnt, min(id) as lo from items where label = 'l7';
+--//CHECK: | cnt | lo |
+--//CHECK: | 10000 | 70000 |
+--//SKIPPED: skipped record batches: 4
+select count(*) as cnt from items where label > 'l8';
+--//CHECK: | cnt |
+--//CHECK: | 10000 |
+--//SKIPPED: skipped record batches: 4
+select count(*) as cnt from items where label = 'l10';
+--//CHECK: | cnt |
+--//CHECK: | 0 |
+--//SKIPPED: skipped record batches: 5
+select count(*) as cnt from items where id >= 99995 and day = date '2009-01-01';
+--//CHECK: | cnt |
+--//CHECK: | 5 |
+--//SKIPPED: skipped record batches: 4
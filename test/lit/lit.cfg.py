@@ -57,12 +57,15 @@ llvm_config.with_environment('PYTHONPATH', config.mlirdb_obj_root, append_path=T
 llvm_config.with_environment('PYTHONPATH', os.path.join(config.mlirdb_src_root, "arrow/python"), append_path=True)
 #llvm_config.with_environment('LINGODB_EXECUTION_MODE', 'C')
 #llvm_config.with_environment('DATABASE_DIR', os.path.join(config.mlirdb_src_root,'resources/data/uni'))
+if config.enable_cranelift.upper() in ('ON', '1', 'TRUE', 'YES'):
+    config.available_features.add('cranelift')
 tool_dirs = [config.mlirdb_tools_dir, config.llvm_tools_dir]
 tools = [
     'mlir-db-opt',
     'run-mlir',
     'sql-to-mlir',
-    'run-sql'
+    'run-sql',
+    'sql'
 ]
 
 llvm_config.add_tool_substitutions(tools, tool_dirs)
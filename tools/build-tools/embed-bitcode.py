@@ -0,0 +1,17 @@
+# generates a C++ file containing the given bitcode file as byte array (empty array if no file is given)
+# usage: python3 embed-bitcode.py <output.cc> [input.bc]
+import sys
+
+data = b""
+if len(sys.argv) > 2:
+    with open(sys.argv[2], "rb") as f:
+        data = f.read()
+with open(sys.argv[1], "w") as out:
+    out.write("#include <cstddef>\n#include <cstdint>\n")
+    out.write("namespace execution {\n")
+    out.write("extern const uint8_t runtimeBitcode[] = {")
+    for i in range(0, len(data), 32):
+        out.write("\n" + ",".join(str(b) for b in data[i:i + 32]) + ",")
+    out.write("0};\n")
+    out.write(f"extern const size_t runtimeBitcodeSize = {len(data)};\n")
+    out.write("} // end namespace execution\n")
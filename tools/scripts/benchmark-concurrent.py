@@ -0,0 +1,106 @@
+# latency of short interactive queries while long-running scans are executed concurrently (sql --server)
+# usage: python3 tools/scripts/benchmark-concurrent.py <objdir> <dataset> (e.g., build/lingodb-release tpch-10)
+# compares interactive queries alone, next to scans with the same priority, and next to low-priority scans
+import os
+import socket
+import statistics
+import struct
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+objdir = sys.argv[1]
+dataset = sys.argv[2]
+duration = 20
+scanClients = 2
+interactiveClients = 4
+
+scanQuery = "select l_returnflag, sum(l_extendedprice * (1 - l_discount)) from lineitem group by l_returnflag;"
+interactiveQuery = "select c_name, c_acctbal from customer where c_custkey = 42;"
+
+
+class Client:
+    def __init__(self, path):
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.connect(path)
+
+    def receive(self, size):
+        data = b""
+        while len(data) < size:
+            chunk = self.sock.recv(size - len(data))
+            if not chunk:
+                raise RuntimeError("connection closed")
+            data += chunk
+        return data
+
+    def send(self, line):
+        self.sock.sendall((line + "\n").encode('utf8'))
+        status = self.receive(1)[0]
+        payload = self.receive(struct.unpack("<Q", self.receive(8))[0])
+        if status != 0:
+            raise RuntimeError(payload.decode('utf8'))
+        return payload
+
+    def close(self):
+        self.sock.close()
+
+
+def runClient(path, settings, query, stop, latencies):
+    client = Client(path)
+    for setting in settings:
+        client.send(setting)
+    while not stop.is_set():
+        start = time.time()
+        client.send(query)
+        latencies.append((time.time() - start) * 1000)
+    client.close()
+
+
+def runWorkload(path, scanPriority, interactivePriority, withScans):
+    stop = threading.Event()
+    scanLatencies = []
+    interactiveLatencies = []
+    threads = []
+    if withScans:
+        for _ in range(scanClients):
+            threads.append(threading.Thread(target=runClient, args=(path, ["\\priority " + scanPriority], scanQuery, stop, scanLatencies)))
+    for _ in range(interactiveClients):
+        threads.append(threading.Thread(target=runClient, args=(path, ["\\priority " + interactivePriority], interactiveQuery, stop, interactiveLatencies)))
+    for thread in threads:
+        thread.start()
+    time.sleep(duration)
+    stop.set()
+    for thread in threads:
+        thread.join()
+    return scanLatencies, interactiveLatencies
+
+
+with tempfile.TemporaryDirectory() as tmpDir:
+    path = os.path.join(tmpDir, "lingodb.sock")
+    server = subprocess.Popen([objdir + "/sql", "resources/data/" + dataset, "--server", path], stdout=subprocess.DEVNULL)
+    while not os.path.exists(path):
+        if server.poll() is not None:
+            print("server terminated")
+            sys.exit(1)
+        time.sleep(0.1)
+    try:
+        # load tables and warm up the page cache
+        warmup = Client(path)
+        warmup.send(scanQuery)
+        warmup.send(interactiveQuery)
+        warmup.close()
+        workloads = [("interactive only", "normal", "normal", False),
+                     ("same priority", "normal", "normal", True),
+                     ("low-priority scans", "low", "high", True)]
+        print(f"{'workload':>20}{'scans/s':>10}{'p50 [ms]':>12}{'p99 [ms]':>12}{'queries/s':>12}")
+        for name, scanPriority, interactivePriority, withScans in workloads:
+            scans, interactive = runWorkload(path, scanPriority, interactivePriority, withScans)
+            interactive.sort()
+            p50 = statistics.median(interactive)
+            p99 = interactive[min(len(interactive) - 1, int(len(interactive) * 0.99))]
+            print(f"{name:>20}{len(scans) / duration:>10.2f}{p50:>12.2f}{p99:>12.2f}{len(interactive) / duration:>12.2f}")
+    finally:
+        server.terminate()
+        server.wait()
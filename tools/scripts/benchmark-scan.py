@@ -0,0 +1,53 @@
+# scan bandwidth with and without NUMA-aware placement/scheduling of record batches
+# usage: python3 tools/scripts/benchmark-scan.py <objdir> <dataset> (e.g., build/lingodb-release tpch-10)
+# note: placed pages of memory-mapped tables stay in the page cache, drop it (or run OFF first, as done here) for a fair baseline
+import os
+import subprocess
+import sys
+import tempfile
+
+import pyarrow as pa
+
+objdir = sys.argv[1]
+dataset = sys.argv[2]
+runs = "5"
+
+# scans four 16-byte decimal columns of lineitem
+query = "select sum(l_quantity), sum(l_extendedprice), sum(l_discount), sum(l_tax) from lineitem"
+bytesPerRow = 4 * 16
+
+
+def run(sqlFile, numa):
+    env = dict(os.environ, QUERY_RUNS=runs, LINGODB_NUMA=numa)
+    proc = subprocess.run([objdir + "/run-sql", sqlFile, "resources/data/" + dataset], stdout=subprocess.PIPE, stderr=subprocess.PIPE, env=env)
+    if proc.returncode != 0:
+        print(proc.stderr.decode('utf8'))
+        sys.exit(1)
+    lines = proc.stdout.decode('utf8').splitlines()
+    for i, line in enumerate(lines):
+        if line.startswith("      name"):
+            columns = line.split()
+            # timing columns are printed with a width of 15 characters after the query name
+            pos = 10 + 15 * (columns.index("executionTime") - 1)
+            return float(lines[i + 1][pos:pos + 15])
+    print("no timing information found")
+    sys.exit(1)
+
+
+def countRows():
+    with pa.memory_map("resources/data/" + dataset + "/lineitem.arrow") as source:
+        reader = pa.ipc.open_file(source)
+        return sum(reader.get_batch(i).num_rows for i in range(reader.num_record_batches))
+
+
+with tempfile.NamedTemporaryFile("w", suffix=".sql") as sqlFile:
+    sqlFile.write(query + ";\n")
+    sqlFile.flush()
+    rows = countRows()
+    results = {}
+    for numa in ["OFF", "ON"]:
+        results[numa] = run(sqlFile.name, numa)
+    print(f"{'numa':>6}{'time [ms]':>15}{'bandwidth [GB/s]':>20}")
+    for numa, ms in results.items():
+        print(f"{numa:>6}{ms:>15.2f}{rows * bytesPerRow / (ms / 1000) / 1e9:>20.2f}")
+    print(f"speedup: {results['OFF'] / results['ON']:.2f}x")
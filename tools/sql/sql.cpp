@@ -1,9 +1,25 @@
+#include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <shared_mutex>
+#include <sstream>
 #include <string>
+#include <thread>
 
 #include "execution/Execution.h"
+#include "execution/ResultProcessing.h"
 #include "mlir-support/eval.h"
+
+#include <arrow/io/memory.h>
+#include <arrow/ipc/writer.h>
+#include <arrow/table.h>
+
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 void check(bool b, std::string message) {
    if (!b) {
       std::cerr << "ERROR: " << message << std::endl;
@@ -14,16 +30,188 @@ void handleQuery(runtime::Session& session, std::string sqlQuery) {
    auto queryExecutionConfig = execution::createQueryExecutionConfig(execution::ExecutionMode::DEFAULT, true);
    auto executer = execution::QueryExecuter::createDefaultExecuter(std::move(queryExecutionConfig), session);
    executer->fromData(sqlQuery);
-   executer->execute();
+   //invalid statements (e.g., unknown prepared statements) do not end the session
+   try {
+      executer->execute();
+   } catch (const std::exception& e) {
+      std::cerr << "ERROR: " << e.what() << std::endl;
+   }
+}
+
+//server mode: the catalog (and all loaded tables) stays resident, clients send queries over a unix socket (each connection with its own session)
+//queries are terminated by a ';' at the end of a line (as in the repl)
+//every query is answered with: status byte (0: ok, 1: error), payload length (8 bytes, little endian), payload
+//payload: arrow ipc stream of the result (empty if the statement has no result) or the error message
+//lines starting with '\' configure the following queries of the connection and are answered with an empty payload:
+//  \priority low|normal|high   priority of the queries' task arenas
+//  \threads <n>                number of threads per query (0: default)
+namespace server {
+struct ConnectionSettings {
+   execution::QueryPriority priority = execution::QueryPriority::NORMAL;
+   size_t concurrency = 0;
+};
+void configure(ConnectionSettings& settings, const std::string& line) {
+   std::stringstream stream(line);
+   std::string command, value;
+   stream >> command >> value;
+   if (command == "\\priority" && value == "low") {
+      settings.priority = execution::QueryPriority::LOW;
+   } else if (command == "\\priority" && value == "normal") {
+      settings.priority = execution::QueryPriority::NORMAL;
+   } else if (command == "\\priority" && value == "high") {
+      settings.priority = execution::QueryPriority::HIGH;
+   } else if (command == "\\threads" && !value.empty() && std::all_of(value.begin(), value.end(), ::isdigit)) {
+      settings.concurrency = std::stoul(value);
+   } else {
+      throw std::runtime_error("unknown command: " + line);
+   }
+}
+//read-only queries run concurrently, all other statements (ddl, inserts, copy) run exclusively
+std::shared_mutex catalogMutex;
+//first word of the query (lower case), starting at the given position
+std::string getKeyword(const std::string& query, size_t& pos, const char* skip = " \t\r\n(") {
+   pos = query.find_first_not_of(skip, pos);
+   std::string keyword;
+   for (; pos != std::string::npos && pos < query.size() && (std::isalnum(query[pos]) || query[pos] == '_'); pos++) {
+      keyword += std::tolower(query[pos]);
+   }
+   return keyword;
+}
+bool isReadOnly(runtime::Session& session, const std::string& query) {
+   size_t pos = 0;
+   auto keyword = getKeyword(query, pos);
+   if (keyword == "select" || keyword == "with" || keyword == "values") return true;
+   //prepared statements belong to the connection and do not modify the catalog
+   if (keyword == "prepare" || keyword == "deallocate") return true;
+   if (keyword == "execute") {
+      auto preparedStatement = session.getPreparedStatement(getKeyword(query, pos));
+      if (!preparedStatement) return true;
+      //classified by the prepared query (following the first "as" of the PREPARE statement)
+      auto sql = preparedStatement->sql;
+      pos = 0;
+      while (pos != std::string::npos && pos < sql.size()) {
+         if (getKeyword(sql, pos, " \t\r\n()") == "as") {
+            return isReadOnly(session, sql.substr(pos));
+         }
+         pos = sql.find_first_of(" \t\r\n()", pos);
+      }
+      return false;
+   }
+   return false;
+}
+std::string serialize(const std::shared_ptr<arrow::Table>& table) {
+   if (!table) return "";
+   auto stream = arrow::io::BufferOutputStream::Create().ValueOrDie();
+   auto writer = arrow::ipc::MakeStreamWriter(stream, table->schema()).ValueOrDie();
+   if (!writer->WriteTable(*table).ok() || !writer->Close().ok()) {
+      throw std::runtime_error("could not serialize result");
+   }
+   return stream->Finish().ValueOrDie()->ToString();
+}
+std::string executeQuery(runtime::Session& session, const ConnectionSettings& settings, const std::string& query) {
+   std::shared_ptr<arrow::Table> result;
+   auto queryExecutionConfig = execution::createQueryExecutionConfig(execution::ExecutionMode::DEFAULT, true);
+   queryExecutionConfig->resultProcessor = execution::createTableRetriever(result);
+   queryExecutionConfig->timingProcessor = {};
+   queryExecutionConfig->exitOnError = false;
+   queryExecutionConfig->priority = settings.priority;
+   queryExecutionConfig->concurrency = settings.concurrency;
+   auto executer = execution::QueryExecuter::createDefaultExecuter(std::move(queryExecutionConfig), session);
+   executer->fromData(query);
+   if (isReadOnly(session, query)) {
+      std::shared_lock lock(catalogMutex);
+      executer->execute();
+   } else {
+      std::unique_lock lock(catalogMutex);
+      executer->execute();
+   }
+   return serialize(result);
+}
+bool sendAll(int fd, const char* data, size_t len) {
+   while (len > 0) {
+      auto sent = send(fd, data, len, 0);
+      if (sent <= 0) return false;
+      data += sent;
+      len -= sent;
+   }
+   return true;
 }
+bool sendResponse(int fd, uint8_t status, const std::string& payload) {
+   uint64_t len = payload.size();
+   return sendAll(fd, reinterpret_cast<const char*>(&status), 1) && sendAll(fd, reinterpret_cast<const char*>(&len), sizeof(len)) && sendAll(fd, payload.data(), payload.size());
+}
+void handleClient(std::shared_ptr<runtime::Catalog> catalog, int fd) {
+   //every connection has its own prepared statements
+   auto session = runtime::Session::createSession(catalog);
+   std::string buffer;
+   std::string query;
+   ConnectionSettings settings;
+   char chunk[4096];
+   while (true) {
+      auto received = recv(fd, chunk, sizeof(chunk), 0);
+      if (received <= 0) break;
+      buffer.append(chunk, received);
+      size_t lineEnd;
+      bool connected = true;
+      while (connected && (lineEnd = buffer.find('\n')) != std::string::npos) {
+         std::string line = buffer.substr(0, lineEnd);
+         buffer.erase(0, lineEnd + 1);
+         if (!line.empty() && line.back() == '\r') line.pop_back();
+         if (query.empty() && !line.empty() && line.front() == '\\') {
+            try {
+               configure(settings, line);
+               connected = sendResponse(fd, 0, "");
+            } catch (const std::exception& e) {
+               connected = sendResponse(fd, 1, e.what());
+            }
+            continue;
+         }
+         query += line + "\n";
+         if (line.empty() || line.back() != ';') continue;
+         try {
+            connected = sendResponse(fd, 0, executeQuery(*session, settings, query));
+         } catch (const std::exception& e) {
+            connected = sendResponse(fd, 1, e.what());
+         }
+         query.clear();
+      }
+      if (!connected) break;
+   }
+   close(fd);
+}
+int run(runtime::Session& session, const std::string& socketPath) {
+   //clients that disconnect early must not terminate the server
+   std::signal(SIGPIPE, SIG_IGN);
+   int serverFd = socket(AF_UNIX, SOCK_STREAM, 0);
+   check(serverFd >= 0, "could not create socket");
+   sockaddr_un address{};
+   address.sun_family = AF_UNIX;
+   check(socketPath.size() < sizeof(address.sun_path), "socket path too long");
+   strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+   unlink(socketPath.c_str());
+   check(bind(serverFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0, "could not bind socket " + socketPath);
+   check(listen(serverFd, SOMAXCONN) == 0, "could not listen on socket " + socketPath);
+   std::cout << "listening on " << socketPath << std::endl;
+   while (true) {
+      int clientFd = accept(serverFd, nullptr, nullptr);
+      if (clientFd < 0) continue;
+      std::thread(handleClient, session.getCatalog(), clientFd).detach();
+   }
+   return 0;
+}
+} // end namespace server
+
 int main(int argc, char** argv) {
-   if (argc <= 1) {
-      std::cerr << "USAGE: sql database" << std::endl;
+   if (argc <= 1 || (argc > 2 && (std::string(argv[2]) != "--server" || argc != 4))) {
+      std::cerr << "USAGE: sql database [--server socket]" << std::endl;
       return 1;
    }
    auto session = runtime::Session::createSession(std::string(argv[1]),true);
 
    support::eval::init();
+   if (argc == 4) {
+      return server::run(*session, argv[3]);
+   }
    while (true) {
       //print prompt
       std::cout << "sql>";
@@ -47,4 +235,3 @@ int main(int argc, char** argv) {
 
    return 0;
 }
-
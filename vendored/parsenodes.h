@@ -719,6 +719,12 @@ using PrepareStmt = struct PrepareStmt {
    Node* query_; /* The query itself (as a raw parsetree) */
 };
 
+using DeallocateStmt = struct DeallocateStmt {
+   NodeTag type_;
+   char* name_; /* The name of the plan to remove */
+   /* NULL means DEALLOCATE ALL */
+};
+
 using DefElemAction = enum DefElemAction {
    DEFELEM_UNSPEC, /* no action given */
    DEFELEM_SET,